@@ -0,0 +1,86 @@
+/**
+ * @file BenchBvh.cpp
+ * @brief Compares projecting a TriangleObject with and without skipping the parts of its hierarchy that miss the canvas.
+ *
+ * A whole-object view and zoomed-in crops of a dense sphere are timed. The more of the mesh a crop leaves off
+ * the canvas, the more of the vertex mapping and binning the hierarchy saves; the images are checked to match.
+ *
+ * Usage: BenchBvh [rings] [segments]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 400;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 800;
+
+    auto facets = bench::makeSphere(rings, segments, 400.0f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_bvh.stl").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions loadOptions;
+    loadOptions.useCache = false;
+    TriangleObject object(path, loadOptions);
+    double loadMs = bench::bestOfMs([&] { TriangleObject reloaded(path, loadOptions); }, 1);
+
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_bvh.ppm").string();
+
+    std::cout << "faces:      " << facets.size() << "\n"
+              << "load:       " << loadMs << " ms (including the hierarchy)\n";
+
+    float zoom = 1.0f;
+    for (float step : {1.0f, 2.0f, 4.0f, 4.0f})
+    {
+        // Zoom in about a point near the sphere's rim, so the crop still shows some of it
+        object.translate(-800.0f, -800.0f, 0.0f);
+        object.scale(step);
+        object.translate(800.0f, 800.0f, 0.0f);
+        zoom *= step;
+
+        RenderOptions all;
+        all.cullOffCanvas = false;
+        RenderOptions culled;
+        RenderStats stats;
+
+        double allMs = bench::bestOfMs([&] { canvas.clear(); object.project(canvas, all); }, 10);
+        std::string allImage = imageBytes(canvas, imagePath);
+        double culledMs = bench::bestOfMs([&] { canvas.clear(); stats = object.project(canvas, culled); }, 10);
+        std::string culledImage = imageBytes(canvas, imagePath);
+
+        std::cout << "zoom " << zoom << "x:    every face " << allMs << " ms, with hierarchy " << culledMs << " ms ("
+                  << stats.facesOffCanvas << " faces skipped, images "
+                  << (allImage == culledImage ? "match" : "DIFFER") << ")\n";
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
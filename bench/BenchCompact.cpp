@@ -0,0 +1,116 @@
+/**
+ * @file BenchCompact.cpp
+ * @brief Compares a dense mesh loaded with float vertices and with compact 16-bit vertices.
+ *
+ * A sphere is loaded both ways. Reported are the memory of the vertices and of the whole geometry, the largest
+ * distance between a float vertex and its decoded code (in mesh units and in pixels once projected), the frame
+ * time, and the number of pixels whose color differs between the two images.
+ *
+ * Usage: BenchCompact [rings] [segments]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+#include "vertex_kernel.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+
+    /**
+     * @brief Returns the number of pixels that differ between two same-sized PPM images.
+     */
+    size_t pixelDifference(const std::string &a, const std::string &b, int width, int height)
+    {
+        const size_t pixels = static_cast<size_t>(width) * height;
+        const size_t offset = a.size() - 3 * pixels; // Past the header
+        size_t count = 0;
+        for (size_t k = 0; k < pixels; ++k)
+        {
+            count += a.compare(offset + 3 * k, 3, b, offset + 3 * k, 3) != 0;
+        }
+        return count;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 500;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    auto facets = bench::makeSphere(rings, segments, 400.0f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_compact.stl").string();
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_compact.ppm").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions floatLoad;
+    floatLoad.useCache = false;
+    LoadOptions compactLoad = floatLoad;
+    compactLoad.compactVertices = true;
+    TriangleObject floats(path, floatLoad), compact(path, compactLoad);
+    const Mesh &floatMesh = floats.getGeometry()->mesh, &compactMesh = compact.getGeometry()->mesh;
+
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    // Both meshes have the same vertices in the same order; compare them and their projections
+    const size_t vertexCount = floatMesh.vertexCount();
+    const Mat4 view = canvas.getCamera().getView();
+    const QuantizedVertices &codes = compactMesh.quantized;
+    const Mat4 decode = Mat4::affine({{{codes.step[0], 0, 0}, {0, codes.step[1], 0}, {0, 0, codes.step[2]}}},
+                                     {codes.origin[0], codes.origin[1], codes.origin[2]});
+    const Mat4 decodedView = view * decode;
+    std::vector<float> floatProjected(3 * vertexCount), compactProjected(3 * vertexCount);
+    transformVertices(view.m, floatMesh.x.data(), floatMesh.y.data(), floatMesh.z.data(), vertexCount, floatProjected.data());
+    transformVertices(decodedView.m, codes.x.data(), codes.y.data(), codes.z.data(), vertexCount, compactProjected.data());
+
+    float meshError = 0.0f, pixelError = 0.0f;
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        float position[3];
+        compactMesh.getVertex(v, position);
+        meshError = std::max({meshError, std::fabs(position[0] - floatMesh.x[v]), std::fabs(position[1] - floatMesh.y[v]),
+                              std::fabs(position[2] - floatMesh.z[v])});
+        pixelError = std::max({pixelError, std::fabs(compactProjected[3 * v] - floatProjected[3 * v]),
+                               std::fabs(compactProjected[3 * v + 1] - floatProjected[3 * v + 1])});
+    }
+
+    double floatMs = bench::bestOfMs([&] { canvas.clear(); floats.project(canvas); }, 5);
+    std::string floatImage = imageBytes(canvas, imagePath);
+    double compactMs = bench::bestOfMs([&] { canvas.clear(); compact.project(canvas); }, 5);
+    std::string compactImage = imageBytes(canvas, imagePath);
+
+    const size_t floatVertexBytes = 3 * vertexCount * sizeof(float), compactVertexBytes = 3 * vertexCount * sizeof(uint16_t);
+    std::cout << "faces: " << facets.size() << ", vertices: " << vertexCount << "\n"
+              << "vertices: float " << floatVertexBytes / 1024 << " KiB, compact " << compactVertexBytes / 1024 << " KiB\n"
+              << "geometry: float " << floats.getGeometry()->getMemoryUsage() / 1024 << " KiB, compact "
+              << compact.getGeometry()->getMemoryUsage() / 1024 << " KiB\n"
+              << "largest error: " << meshError << " mesh units, " << pixelError << " pixels projected\n"
+              << "frame: float " << floatMs << " ms, compact " << compactMs << " ms, "
+              << pixelDifference(floatImage, compactImage, 1000, 1000) << " pixels differ\n";
+
+    std::filesystem::remove(path);
+    return 0;
+}
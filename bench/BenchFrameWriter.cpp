@@ -0,0 +1,77 @@
+/**
+ * @file BenchFrameWriter.cpp
+ * @brief Compares rendering and writing a frame sequence in turn against writing it through a FrameWriter.
+ *
+ * With the FrameWriter the next frame is rendered while the previous one is encoded and written, so on a
+ * machine with spare cores the sequence time approaches the larger of the two stages instead of their sum.
+ *
+ * Usage: BenchFrameWriter [frames] [size]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "frame_writer.h"
+#include "TriangleObject.h"
+
+int main(int argc, char **argv)
+{
+    int frames = argc > 1 ? std::atoi(argv[1]) : 8;
+    int size = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    auto facets = bench::makeSphere(200, 400, size * 0.4f, size * 0.5f, size * 0.5f, size * 0.5f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_frame_writer.stl").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions options;
+    options.useCache = false;
+    TriangleObject object(path, options);
+    Canvas canvas(size, size);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+    std::vector<float> pivot = {size * 0.5f, size * 0.5f, size * 0.5f};
+
+    auto framePath = [](int frame)
+    {
+        return (std::filesystem::temp_directory_path() / ("bench_frame_" + std::to_string(frame) + ".ppm")).string();
+    };
+
+    std::cout.setstate(std::ios::failbit); // Silence the "created successfully" messages while timing
+    double sequentialMs = bench::bestOfMs([&]
+    {
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            object.project(canvas);
+            object.rotateAroundX(6.0f, pivot);
+            canvas.writePPM(framePath(frame));
+            canvas.clear();
+        }
+    });
+    double asyncMs = bench::bestOfMs([&]
+    {
+        FrameWriter writer(canvas);
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            Canvas &target = writer.acquire();
+            object.project(target);
+            object.rotateAroundX(6.0f, pivot);
+            writer.submit(target, framePath(frame), ImageFormat::PPM);
+        }
+        writer.finish();
+    });
+    std::cout.clear();
+
+    std::cout << "frames:            " << frames << "\n"
+              << "render then write: " << sequentialMs << " ms\n"
+              << "frame writer:      " << asyncMs << " ms" << std::endl;
+
+    for (int frame = 0; frame < frames; ++frame)
+        std::filesystem::remove(framePath(frame));
+    std::filesystem::remove(path);
+    return 0;
+}
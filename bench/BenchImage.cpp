@@ -0,0 +1,58 @@
+/**
+ * @file BenchImage.cpp
+ * @brief Compares the time and file size of writing a rendered frame in each image format.
+ *
+ * Usage: BenchImage [size]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+
+int main(int argc, char **argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    auto facets = bench::makeSphere(200, 400, size * 0.4f, size * 0.5f, size * 0.5f, size * 0.5f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_image.stl").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions options;
+    options.useCache = false;
+    TriangleObject object(path, options);
+    Canvas canvas(size, size);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+    object.project(canvas);
+
+    struct
+    {
+        ImageFormat format;
+        const char *label;
+        const char *extension;
+    } formats[] = {{ImageFormat::PPM, "PPM (P3): ", ".ppm"}, {ImageFormat::P6, "PPM (P6): ", ".ppm"},
+                   {ImageFormat::QOI, "QOI:      ", ".qoi"}, {ImageFormat::PNG, "PNG:      ", ".png"}};
+
+    std::cout.setstate(std::ios::failbit); // Silence the "created successfully" messages while timing
+    for (const auto &[format, label, extension] : formats)
+    {
+        std::string imagePath = (std::filesystem::temp_directory_path() / (std::string("bench_image") + extension)).string();
+        double ms = bench::bestOfMs([&] { canvas.writeImage(imagePath, format); });
+        auto bytes = std::filesystem::file_size(imagePath);
+
+        std::cout.clear();
+        std::cout << label << ms << " ms, " << bytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+        std::cout.setstate(std::ios::failbit);
+        std::filesystem::remove(imagePath);
+    }
+    std::cout.clear();
+
+    std::filesystem::remove(path);
+    return 0;
+}
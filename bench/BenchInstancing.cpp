@@ -0,0 +1,100 @@
+/**
+ * @file BenchInstancing.cpp
+ * @brief Compares drawing many copies of one mesh as separate TriangleObjects and as one InstancedObject.
+ *
+ * A small sphere stands in for a fastener and is laid out in a square grid on the canvas. Loading a
+ * TriangleObject per copy reads the file and stores the mesh once per copy; the InstancedObject reads and stores
+ * it once. Load time, memory and frame time are reported for both, and the images are checked to match.
+ *
+ * Usage: BenchInstancing [copies per side] [rings] [segments]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "instanced_object.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int side = argc > 1 ? std::atoi(argv[1]) : 20;
+    int rings = argc > 2 ? std::atoi(argv[2]) : 40;
+    int segments = argc > 3 ? std::atoi(argv[3]) : 80;
+
+    // A sphere of radius 20 about the origin, moved to the middle of each grid cell
+    auto facets = bench::makeSphere(rings, segments, 20.0f, 0.0f, 0.0f, 0.0f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_instancing.stl").string();
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_instancing.ppm").string();
+    bench::writeBinarySTL(path, facets);
+
+    const float cell = 1000.0f / side;
+    std::vector<Mat4> placements;
+    for (int i = 0; i < side; ++i)
+        for (int j = 0; j < side; ++j)
+            placements.push_back(Mat4::affine(Mat3(), {(i + 0.5f) * cell, (j + 0.5f) * cell, 500.0f}));
+
+    LoadOptions loadOptions;
+    loadOptions.useCache = false;
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    std::vector<TriangleObject> objects;
+    objects.reserve(placements.size());
+    double separateLoadMs = bench::bestOfMs([&]
+    {
+        for (const Mat4 &placement : placements)
+        {
+            objects.emplace_back(path, loadOptions);
+            objects.back().translate(placement[0][3], placement[1][3], placement[2][3]);
+        }
+    }, 1);
+    size_t separateBytes = 0;
+
+    std::unique_ptr<InstancedObject> instanced;
+    double instancedLoadMs = bench::bestOfMs([&]
+    {
+        instanced = std::make_unique<InstancedObject>(path, loadOptions);
+        for (const Mat4 &placement : placements)
+            instanced->addInstance(placement);
+    }, 1);
+
+    double separateMs = bench::bestOfMs([&] { canvas.clear(); for (TriangleObject &object : objects) object.project(canvas); }, 5);
+    std::string separateImage = imageBytes(canvas, imagePath);
+    double instancedMs = bench::bestOfMs([&] { canvas.clear(); instanced->project(canvas); }, 5);
+    std::string instancedImage = imageBytes(canvas, imagePath);
+    for (const TriangleObject &object : objects)
+        separateBytes += object.getMemoryUsage();
+
+    std::cout << "copies: " << placements.size() << " of " << facets.size() << " faces\n"
+              << "separate objects: load " << separateLoadMs << " ms, " << separateBytes / 1024 << " KiB, frame "
+              << separateMs << " ms\n"
+              << "instanced:        load " << instancedLoadMs << " ms, " << instanced->getMemoryUsage() / 1024
+              << " KiB, frame " << instancedMs << " ms (images " << (separateImage == instancedImage ? "match" : "DIFFER")
+              << ")\n";
+
+    std::filesystem::remove(path);
+    return 0;
+}
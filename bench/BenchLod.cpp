@@ -0,0 +1,111 @@
+/**
+ * @file BenchLod.cpp
+ * @brief Compares projecting a dense mesh at thumbnail sizes in full and at an automatically picked level of detail.
+ *
+ * A sphere is loaded with a chain of levels of detail, whose build time is reported. It is then
+ * shrunk step by step on a 500x500 canvas and drawn both in full and at the coarsest level whose error stays
+ * within half a pixel. The smaller the sphere, the coarser the level picked and the fewer faces drawn; the
+ * number of pixels whose coverage differs from the full mesh's is reported alongside.
+ *
+ * Usage: BenchLod [rings] [segments] [pixelError]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+
+    /**
+     * @brief Returns the number of pixels covered in one of two same-sized PPM images and blank in the other.
+     *
+     * Faces have colors of their own, so a coarser level changes the colors inside the silhouette everywhere;
+     * coverage shows how far the silhouette itself moved.
+     */
+    size_t coverageDifference(const std::string &a, const std::string &b, int width, int height)
+    {
+        const size_t pixels = static_cast<size_t>(width) * height;
+        const size_t offset = a.size() - 3 * pixels; // Past the header
+        size_t count = 0;
+        for (size_t k = 0; k < pixels; ++k)
+        {
+            const char *p = a.data() + offset + 3 * k, *q = b.data() + offset + 3 * k;
+            count += (p[0] || p[1] || p[2]) != (q[0] || q[1] || q[2]);
+        }
+        return count;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 500;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 1000;
+    float pixelError = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 0.5f;
+
+    auto facets = bench::makeSphere(rings, segments, 400.0f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_lod.stl").string();
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_lod.ppm").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions plainLoad;
+    plainLoad.useCache = false;
+    LoadOptions lodLoad = plainLoad;
+    lodLoad.buildLods = true;
+    double plainLoadMs = bench::bestOfMs([&] { TriangleObject object(path, plainLoad); }, 1);
+    std::unique_ptr<TriangleObject> loaded;
+    double lodLoadMs = bench::bestOfMs([&] { loaded = std::make_unique<TriangleObject>(path, lodLoad); }, 1);
+    TriangleObject &object = *loaded;
+
+    std::cout << "faces: " << facets.size() << "\n"
+              << "load: " << plainLoadMs << " ms, with levels of detail " << lodLoadMs << " ms\n";
+
+    Canvas canvas(500, 500);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    // The sphere spans 800 units around (500, 500, 500); halving it about the origin fits it on the canvas
+    float scale = 1.0f;
+    for (float step : {0.5f, 0.5f, 0.5f, 0.5f})
+    {
+        object.scale(step);
+        scale *= step;
+
+        RenderOptions full;
+        RenderOptions lod;
+        lod.lodPixelError = pixelError;
+        RenderStats fullStats, lodStats;
+
+        double fullMs = bench::bestOfMs([&] { canvas.clear(); fullStats = object.project(canvas, full); }, 5);
+        std::string fullImage = imageBytes(canvas, imagePath);
+        double lodMs = bench::bestOfMs([&] { canvas.clear(); lodStats = object.project(canvas, lod); }, 5);
+        std::string lodImage = imageBytes(canvas, imagePath);
+
+        std::cout << "scale " << scale << ": full mesh " << fullMs << " ms (" << fullStats.facesDrawn << " faces), level "
+                  << lodStats.lodLevel << " " << lodMs << " ms (" << lodStats.facesDrawn << " faces, "
+                  << coverageDifference(lodImage, fullImage, 500, 500) << " pixels covered in one image only)\n";
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
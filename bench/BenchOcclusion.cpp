@@ -0,0 +1,94 @@
+/**
+ * @file BenchOcclusion.cpp
+ * @brief Compares projecting a high-overdraw mesh with and without occlusion culling against the depth blocks.
+ *
+ * The mesh is a set of concentric spheres, so every pixel is covered up to eight times. It is rendered once with
+ * its faces ordered from the outer sphere inward and front to back, where most faces are hidden by the time they
+ * are drawn, and once in the reverse order, where none are and the test is pure overhead. The images are
+ * checked to match.
+ *
+ * Usage: BenchOcclusion [rings] [segments] [spheres]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 200;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 400;
+    int spheres = argc > 3 ? std::atoi(argv[3]) : 4;
+
+    // makeSphere runs from the far pole to the near one; mirroring along Z makes each sphere front to back
+    std::vector<bench::Facet> facets;
+    for (int s = 0; s < spheres; ++s)
+    {
+        for (bench::Facet facet : bench::makeSphere(rings, segments, 400.0f * (spheres - s) / spheres))
+        {
+            for (int v = 0; v < 3; ++v)
+                facet[3 * v + 2] = 1000.0f - facet[3 * v + 2];
+            facets.push_back(facet);
+        }
+    }
+    std::vector<bench::Facet> reversed(facets.rbegin(), facets.rend());
+
+    std::string frontPath = (std::filesystem::temp_directory_path() / "bench_occlusion_front.stl").string();
+    std::string backPath = (std::filesystem::temp_directory_path() / "bench_occlusion_back.stl").string();
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_occlusion.ppm").string();
+    bench::writeBinarySTL(frontPath, facets);
+    bench::writeBinarySTL(backPath, reversed);
+
+    LoadOptions loadOptions;
+    loadOptions.useCache = false;
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    std::cout << "faces: " << facets.size() << "\n";
+    for (const auto &[name, path] : {std::pair<std::string, std::string>{"front to back", frontPath}, {"back to front", backPath}})
+    {
+        TriangleObject object(path, loadOptions);
+        RenderOptions plain;
+        RenderOptions culled;
+        culled.cullOccluded = true;
+        RenderStats stats;
+
+        double plainMs = bench::bestOfMs([&] { canvas.clear(); object.project(canvas, plain); }, 5);
+        std::string plainImage = imageBytes(canvas, imagePath);
+        double culledMs = bench::bestOfMs([&] { canvas.clear(); stats = object.project(canvas, culled); }, 5);
+        std::string culledImage = imageBytes(canvas, imagePath);
+
+        std::cout << name << ": without " << plainMs << " ms, with occlusion culling " << culledMs << " ms ("
+                  << stats.faceTilesOccluded << " of " << stats.faceTiles << " face tiles skipped, images "
+                  << (plainImage == culledImage ? "match" : "DIFFER") << ")\n";
+    }
+
+    std::filesystem::remove(frontPath);
+    std::filesystem::remove(backPath);
+    return 0;
+}
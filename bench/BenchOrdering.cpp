@@ -0,0 +1,102 @@
+/**
+ * @file BenchOrdering.cpp
+ * @brief Compares projecting a high-overdraw mesh in file order and sorted front to back.
+ *
+ * The mesh is a set of concentric spheres, so every pixel is covered up to sixteen times, stored from the inner
+ * sphere outward and back to front: in file order every face passes the depth test and overwrites the last.
+ * Sorting clusters of the hierarchy front to back makes most faces fail it instead, and lets occlusion culling skip
+ * them before any pixel is visited. Each ordering is timed with and without occlusion culling, and the images
+ * are compared: they may only differ where faces of different spheres round to the same depth, since the face
+ * drawn first keeps such a pixel.
+ *
+ * Usage: BenchOrdering [rings] [segments] [spheres]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+
+    /**
+     * @brief Returns the number of bytes at which two images of the same size differ.
+     */
+    size_t differingBytes(const std::string &a, const std::string &b)
+    {
+        size_t count = 0;
+        for (size_t k = 0; k < a.size() && k < b.size(); ++k)
+            count += a[k] != b[k];
+        return count;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 100;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 200;
+    int spheres = argc > 3 ? std::atoi(argv[3]) : 8;
+
+    // makeSphere runs from the far pole to the near one, so each sphere is already back to front
+    std::vector<bench::Facet> facets;
+    for (int s = 1; s <= spheres; ++s)
+    {
+        auto sphere = bench::makeSphere(rings, segments, 400.0f * s / spheres);
+        facets.insert(facets.end(), sphere.begin(), sphere.end());
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / "bench_ordering.stl").string();
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_ordering.ppm").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions loadOptions;
+    loadOptions.useCache = false;
+    TriangleObject object(path, loadOptions);
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    std::cout << "faces: " << facets.size() << "\n";
+    std::string fileOrderImage;
+    for (bool cullOccluded : {false, true})
+    {
+        RenderOptions fileOrder;
+        fileOrder.cullOccluded = cullOccluded;
+        RenderOptions sorted = fileOrder;
+        sorted.sortFrontToBack = true;
+        RenderStats stats;
+
+        double fileMs = bench::bestOfMs([&] { canvas.clear(); object.project(canvas, fileOrder); }, 5);
+        if (fileOrderImage.empty())
+            fileOrderImage = imageBytes(canvas, imagePath);
+        double sortedMs = bench::bestOfMs([&] { canvas.clear(); stats = object.project(canvas, sorted); }, 5);
+        std::string sortedImage = imageBytes(canvas, imagePath);
+
+        std::cout << (cullOccluded ? "with occlusion culling:    " : "without occlusion culling: ") << "file order "
+                  << fileMs << " ms, front to back " << sortedMs << " ms (" << stats.faceTilesOccluded << " of "
+                  << stats.faceTiles << " face tiles skipped, " << differingBytes(sortedImage, fileOrderImage)
+                  << " image bytes differ)\n";
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
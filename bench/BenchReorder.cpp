@@ -0,0 +1,99 @@
+/**
+ * @file BenchReorder.cpp
+ * @brief Compares projecting a mesh whose faces are in arbitrary order with and without sorting them at load.
+ *
+ * The facets of a sphere are shuffled before being written, as an exporter that walks its own data structures
+ * might write them. The mesh is loaded as is and with LoadOptions::reorderFaces, which sorts the faces along a
+ * Morton curve and renumbers the vertices in the order the faces use them. Reported for both:
+ *  - the misses of a simulated 32-entry FIFO vertex cache per face, a stand-in for the cache misses of
+ *    fetching the projected vertices (3.0 means no face shares a vertex with a recent face);
+ *  - the frame time with the whole sphere on the canvas;
+ *  - the frame time zoomed in on a corner, where the faces off the canvas are culled and only the blocks of
+ *    vertices the rest use are mapped.
+ *
+ * Usage: BenchReorder [rings] [segments]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "TriangleObject.h"
+
+namespace
+{
+    /**
+     * @brief Returns the average number of vertices per face that miss a FIFO cache of recently fetched vertices.
+     */
+    double vertexCacheMissesPerFace(const Mesh &mesh, size_t cacheSize = 32)
+    {
+        std::vector<uint8_t> cached(mesh.vertexCount(), 0);
+        std::deque<uint32_t> fifo;
+        size_t misses = 0;
+        for (uint32_t index : mesh.indices)
+        {
+            if (cached[index])
+                continue;
+            ++misses;
+            cached[index] = 1;
+            fifo.push_back(index);
+            if (fifo.size() > cacheSize)
+            {
+                cached[fifo.front()] = 0;
+                fifo.pop_front();
+            }
+        }
+        return static_cast<double>(misses) / std::max<size_t>(mesh.faceCount(), 1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 500;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    auto facets = bench::makeSphere(rings, segments, 400.0f);
+    std::shuffle(facets.begin(), facets.end(), std::mt19937(42));
+    std::string path = (std::filesystem::temp_directory_path() / "bench_reorder.stl").string();
+    bench::writeBinarySTL(path, facets);
+
+    LoadOptions plainLoad;
+    plainLoad.useCache = false;
+    LoadOptions sortedLoad = plainLoad;
+    sortedLoad.reorderFaces = true;
+
+    std::unique_ptr<TriangleObject> plain, sorted;
+    double plainLoadMs = bench::bestOfMs([&] { plain = std::make_unique<TriangleObject>(path, plainLoad); }, 1);
+    double sortedLoadMs = bench::bestOfMs([&] { sorted = std::make_unique<TriangleObject>(path, sortedLoad); }, 1);
+
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    std::cout << "faces: " << facets.size() << ", shuffled\n"
+              << "load: as written " << plainLoadMs << " ms, reordered " << sortedLoadMs << " ms\n";
+
+    auto report = [&](const char *name, TriangleObject &object)
+    {
+        double fullMs = bench::bestOfMs([&] { canvas.clear(); object.project(canvas); }, 5);
+        object.scale(4.0f); // About the origin: the canvas sees a corner of the sphere
+        double zoomedMs = bench::bestOfMs([&] { canvas.clear(); object.project(canvas); }, 5);
+        object.scale(0.25f);
+        std::cout << name << vertexCacheMissesPerFace(object.getGeometry()->mesh) << " vertex misses per face, frame "
+                  << fullMs << " ms, zoomed in " << zoomedMs << " ms\n";
+    };
+    report("as written: ", *plain);
+    report("reordered:  ", *sorted);
+
+    std::filesystem::remove(path);
+    return 0;
+}
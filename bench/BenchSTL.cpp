@@ -0,0 +1,62 @@
+/**
+ * @file BenchSTL.cpp
+ * @brief Compares STL load times for the same mesh stored as ASCII and as binary, and against the mesh cache.
+ *
+ * Usage: BenchSTL [rings] [segments]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include "bench_util.h"
+#include "mesh_cache.h"
+#include "stl.h"
+#include "TriangleObject.h"
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 400;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 800;
+
+    auto facets = bench::makeSphere(rings, segments, 400.0f);
+    auto dir = std::filesystem::temp_directory_path();
+    std::string asciiPath = (dir / "bench_sphere_ascii.stl").string();
+    std::string binaryPath = (dir / "bench_sphere_binary.stl").string();
+    bench::writeAsciiSTL(asciiPath, facets);
+    bench::writeBinarySTL(binaryPath, facets);
+
+    auto load = [](const std::string &path)
+    {
+        auto triangles = std::make_shared<std::vector<TriangleSurface>>();
+        readSTL(path, triangles);
+        return triangles->size();
+    };
+
+    double asciiMs = bench::bestOfMs([&] { load(asciiPath); });
+    double binaryMs = bench::bestOfMs([&] { load(binaryPath); });
+
+    // Full TriangleObject startup: parse and weld every time, versus reading the cache written on first load
+    LoadOptions noCache;
+    noCache.useCache = false;
+    double objectMs = bench::bestOfMs([&] { TriangleObject object(binaryPath, noCache); });
+    TriangleObject warmup(binaryPath);
+    double cachedMs = bench::bestOfMs([&] { TriangleObject object(binaryPath); });
+
+    std::cout << "facets:        " << facets.size() << "\n"
+              << "ascii size:    " << std::filesystem::file_size(asciiPath) / (1024.0 * 1024.0) << " MiB\n"
+              << "binary size:   " << std::filesystem::file_size(binaryPath) / (1024.0 * 1024.0) << " MiB\n"
+              << "ascii load:    " << asciiMs << " ms\n"
+              << "binary load:   " << binaryMs << " ms\n"
+              << "speedup:       " << asciiMs / binaryMs << "x\n"
+              << "object load:   " << objectMs << " ms (binary STL, weld)\n"
+              << "cached load:   " << cachedMs << " ms (mesh cache)" << std::endl;
+
+    std::filesystem::remove(asciiPath);
+    std::filesystem::remove(binaryPath);
+    std::filesystem::remove(meshCachePath(binaryPath));
+    return 0;
+}
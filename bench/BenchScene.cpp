@@ -0,0 +1,100 @@
+/**
+ * @file BenchScene.cpp
+ * @brief Compares loading and drawing an assembly as separate TriangleObjects and as one Scene.
+ *
+ * The assembly is a row of spheres, one STL file each: small parts of the same size and a last, large one with
+ * as many faces as the rest together. Loading the files one after another takes the sum of their load times;
+ * the Scene loads them on a pool of threads, which brings the total down towards the load time of the largest
+ * part when there are enough cores. Drawing the objects one by one bins and rasterizes the screen tiles once per object; the
+ * Scene does it once per frame. The images are checked to match.
+ *
+ * Usage: BenchScene [parts] [rings of the small parts] [load threads, 0 for one per core]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "scene.h"
+
+namespace
+{
+    /**
+     * @brief Writes a canvas as a binary PPM file and returns the file's bytes.
+     */
+    std::string imageBytes(Canvas &canvas, const std::string &path)
+    {
+        canvas.writeImage(path, ImageFormat::P6);
+        std::ifstream file(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::filesystem::remove(path);
+        return bytes;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int parts = argc > 1 ? std::atoi(argv[1]) : 8;
+    int rings = argc > 2 ? std::atoi(argv[2]) : 100;
+    size_t threads = argc > 3 ? std::atoi(argv[3]) : 0;
+
+    // The last part has sqrt(parts - 1) times the rings and segments of the others
+    std::vector<std::string> paths;
+    size_t totalFaces = 0;
+    const float cell = 1000.0f / parts;
+    for (int k = 0; k < parts; ++k)
+    {
+        int partRings = k + 1 < parts ? rings : static_cast<int>(rings * std::sqrt(std::max(parts - 1, 1)));
+        auto facets = bench::makeSphere(partRings, 2 * partRings, cell * 0.45f, (k + 0.5f) * cell, 500.0f, 500.0f);
+        paths.push_back((std::filesystem::temp_directory_path() / ("bench_scene_" + std::to_string(k) + ".stl")).string());
+        bench::writeBinarySTL(paths.back(), facets);
+        totalFaces += facets.size();
+    }
+    std::string imagePath = (std::filesystem::temp_directory_path() / "bench_scene.ppm").string();
+
+    LoadOptions loadOptions;
+    loadOptions.useCache = false;
+
+    std::vector<TriangleObject> objects;
+    objects.reserve(paths.size());
+    double separateLoadMs = bench::bestOfMs([&]
+    {
+        for (const std::string &path : paths)
+            objects.emplace_back(path, loadOptions);
+    }, 1);
+    double largestLoadMs = bench::bestOfMs([&] { TriangleObject largest(paths.back(), loadOptions); }, 1);
+
+    Scene scene;
+    double sceneLoadMs = bench::bestOfMs([&] { scene.load(paths, loadOptions, threads); }, 1);
+
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+
+    double separateMs = bench::bestOfMs([&] { canvas.clear(); for (TriangleObject &object : objects) object.project(canvas); }, 5);
+    std::string separateImage = imageBytes(canvas, imagePath);
+    double sceneMs = bench::bestOfMs([&] { canvas.clear(); scene.project(canvas); }, 5);
+    std::string sceneImage = imageBytes(canvas, imagePath);
+
+    std::cout << "parts: " << parts << ", " << totalFaces << " faces, " << std::thread::hardware_concurrency()
+              << " hardware threads\n"
+              << "load: one by one " << separateLoadMs << " ms, scene " << sceneLoadMs << " ms, largest part alone "
+              << largestLoadMs << " ms\n"
+              << "frame: one by one " << separateMs << " ms, scene " << sceneMs << " ms (images "
+              << (separateImage == sceneImage ? "match" : "DIFFER") << ")\n";
+
+    for (const std::string &path : paths)
+        std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file BenchTransform.cpp
+ * @brief Compares transform cost and geometry memory of per-triangle storage and the indexed TriangleObject mesh.
+ *
+ * TriangleObject only composes transforms into its model matrix, so its full frame (the transforms from
+ * main.cpp followed by a projection, which applies the matrix) is timed as well.
+ *
+ * Usage: BenchTransform [rings] [segments]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include "bench_util.h"
+#include "Canvas.h"
+#include "stl.h"
+#include "TriangleObject.h"
+
+int main(int argc, char **argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 400;
+    int segments = argc > 2 ? std::atoi(argv[2]) : 800;
+
+    auto facets = bench::makeSphere(rings, segments, 400.0f);
+    std::string path = (std::filesystem::temp_directory_path() / "bench_transform.stl").string();
+    bench::writeBinarySTL(path, facets);
+
+    auto triangles = std::make_shared<std::vector<TriangleSurface>>();
+    readSTL(path, triangles);
+    TriangleObject object(path);
+    std::vector<float> pivot = {500.0f, 500.0f, 500.0f};
+
+    double perTriangleMs = bench::bestOfMs([&]
+    {
+        for (auto &t : *triangles)
+            t.rotateAroundY(1.0f, pivot);
+    });
+    double objectMs = bench::bestOfMs([&] { object.rotateAroundY(1.0f, pivot); });
+
+    Canvas canvas(1000, 1000);
+    std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+    canvas.setCameraNormal(normal);
+    double frameMs = bench::bestOfMs([&]
+    {
+        canvas.clear();
+        object.scale(1.0f);
+        object.rotateAroundY(-1.0f, pivot);
+        object.translate(0.0f, 0.0f, 0.0f);
+        object.rotateAroundY(1.0f, pivot);
+        object.rotateAroundX(1.0f, pivot);
+        object.project(canvas);
+    });
+
+    // Each TriangleSurface holds four 3-float vectors: the object itself plus four heap blocks
+    size_t perTriangleBytes = triangles->size() * (sizeof(TriangleSurface) + 4 * 3 * sizeof(float));
+    size_t objectBytes = object.getMemoryUsage();
+
+    std::cout << "faces:                  " << facets.size() << "\n"
+              << "per-triangle rotate:    " << perTriangleMs << " ms\n"
+              << "object rotate:          " << objectMs << " ms\n"
+              << "object frame:           " << frameMs << " ms (five transforms and a projection)\n"
+              << "per-triangle geometry:  " << perTriangleBytes / (1024.0 * 1024.0) << " MiB (excluding allocator overhead)\n"
+              << "object geometry:        " << objectBytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file BenchVertexKernel.cpp
+ * @brief Compares the scalar, SSE and AVX2 versions of the vertex transform kernel on a single thread.
+ *
+ * Usage: BenchVertexKernel [vertices]
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "bench_util.h"
+#include "vertex_kernel.h"
+
+int main(int argc, char **argv)
+{
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000; // About a 2M-triangle closed mesh
+
+    std::vector<float> x(count), y(count), z(count), out(3 * count);
+    for (size_t v = 0; v < count; ++v)
+    {
+        x[v] = static_cast<float>(v % 1000);
+        y[v] = static_cast<float>(v / 1000);
+        z[v] = static_cast<float>(v % 77);
+    }
+    const float matrix[3][4] = {{0.6f, -0.8f, 0, 12}, {0.8f, 0.6f, 0, -3.5f}, {0, 0, 1, 100}};
+
+    struct
+    {
+        SimdLevel level;
+        const char *label;
+    } levels[] = {{SimdLevel::Scalar, "scalar:      "}, {SimdLevel::SSE, "SSE:         "}, {SimdLevel::AVX2, "AVX2:        "}};
+
+    std::cout << "vertices:    " << count << "\n";
+    for (const auto &[level, label] : levels)
+    {
+        if (level > detectSimdLevel())
+        {
+            std::cout << label << "not supported\n";
+            continue;
+        }
+        double ms = bench::bestOfMs([&] { transformVertices(matrix, x.data(), y.data(), z.data(), count, out.data(), level); }, 5);
+        std::cout << label << ms << " ms\n";
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+/**
+ * @file bench_util.h
+ * @brief Shared helpers for the benchmark executables: timing and synthetic STL meshes.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    using Facet = std::array<float, 9>; // Three vertices, x/y/z each
+
+    /**
+     * @brief Runs a function several times and returns the fastest wall time in milliseconds.
+     *
+     * @param fn The function to time.
+     * @param repetitions How many times to run it.
+     * @return The best observed wall time in milliseconds.
+     */
+    template <typename Fn>
+    double bestOfMs(Fn &&fn, int repetitions = 3)
+    {
+        double best = 1e300;
+        for (int r = 0; r < repetitions; ++r)
+        {
+            auto start = std::chrono::steady_clock::now();
+            fn();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        return best;
+    }
+
+    /**
+     * @brief Tessellates a closed UV sphere, giving a mesh whose vertices are shared like a real STL part.
+     *
+     * @param rings Number of latitude bands.
+     * @param segments Number of longitude segments.
+     * @param radius Sphere radius.
+     * @param cx Center X.
+     * @param cy Center Y.
+     * @param cz Center Z.
+     * @return The facets of the sphere, wound counter-clockwise when seen from outside.
+     */
+    inline std::vector<Facet> makeSphere(int rings, int segments, float radius, float cx = 500, float cy = 500, float cz = 500)
+    {
+        auto point = [&](int r, int s)
+        {
+            double theta = M_PI * r / rings;
+            double phi = 2.0 * M_PI * s / segments;
+            return std::array<float, 3>{cx + static_cast<float>(radius * std::sin(theta) * std::cos(phi)),
+                                        cy + static_cast<float>(radius * std::sin(theta) * std::sin(phi)),
+                                        cz + static_cast<float>(radius * std::cos(theta))};
+        };
+
+        std::vector<Facet> facets;
+        facets.reserve(static_cast<size_t>(rings) * segments * 2);
+        for (int r = 0; r < rings; ++r)
+        {
+            for (int s = 0; s < segments; ++s)
+            {
+                auto a = point(r, s), b = point(r + 1, s), c = point(r + 1, s + 1), d = point(r, s + 1);
+                if (r != 0)
+                    facets.push_back({a[0], a[1], a[2], b[0], b[1], b[2], d[0], d[1], d[2]});
+                if (r != rings - 1)
+                    facets.push_back({b[0], b[1], b[2], c[0], c[1], c[2], d[0], d[1], d[2]});
+            }
+        }
+        return facets;
+    }
+
+    /**
+     * @brief Writes facets as an ASCII STL file.
+     */
+    inline void writeAsciiSTL(const std::string &filename, const std::vector<Facet> &facets)
+    {
+        std::FILE *f = std::fopen(filename.c_str(), "w");
+        std::fprintf(f, "solid bench\n");
+        for (const auto &t : facets)
+        {
+            std::fprintf(f, "  facet normal 0 0 0\n    outer loop\n");
+            for (int v = 0; v < 3; ++v)
+                std::fprintf(f, "      vertex %.6f %.6f %.6f\n", t[3 * v], t[3 * v + 1], t[3 * v + 2]);
+            std::fprintf(f, "    endloop\n  endfacet\n");
+        }
+        std::fprintf(f, "endsolid bench\n");
+        std::fclose(f);
+    }
+
+    /**
+     * @brief Writes facets as a binary STL file.
+     */
+    inline void writeBinarySTL(const std::string &filename, const std::vector<Facet> &facets)
+    {
+        std::ofstream f(filename, std::ios::binary);
+        char header[80] = "binary bench mesh";
+        uint32_t count = static_cast<uint32_t>(facets.size());
+        f.write(header, sizeof(header));
+        f.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        for (const auto &t : facets)
+        {
+            float normal[3] = {0, 0, 0};
+            uint16_t attribute = 0;
+            f.write(reinterpret_cast<const char *>(normal), sizeof(normal));
+            f.write(reinterpret_cast<const char *>(t.data()), 9 * sizeof(float));
+            f.write(reinterpret_cast<const char *>(&attribute), sizeof(attribute));
+        }
+    }
+}
+
+#endif // BENCH_UTIL_H
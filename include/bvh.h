@@ -0,0 +1,43 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <cstdint>
+#include <vector>
+#include "linalg.h"
+#include "mesh.h"
+
+// A node of a bounding volume hierarchy; the faces under a node are a contiguous range of Bvh::faces
+struct BvhNode
+{
+    float boundsMin[3]; // Smallest x, y and z of the node's vertices, in the mesh's own frame
+    float boundsMax[3]; // Largest x, y and z of the node's vertices
+    uint32_t first;     // Position of the node's first face in Bvh::faces
+    uint32_t count;     // Number of faces under the node
+    uint32_t right;     // Index of the second child, 0 for a leaf; the first child directly follows its parent
+};
+
+// Bounding volume hierarchy over the faces of a mesh, with its nodes in depth-first order
+struct Bvh
+{
+    std::vector<BvhNode> nodes;  // The root is nodes[0]
+    std::vector<uint32_t> faces; // Face indices, grouped by leaf
+
+    size_t getMemoryUsage() const;
+};
+
+// Function to build a bounding volume hierarchy over the faces of a mesh by splitting each node at the middle of
+// its face centroids along their longest axis, until at most leafSize faces are left
+Bvh buildBvh(const Mesh &mesh, uint32_t leafSize = 8);
+
+// Function to mark the faces that may land on a canvas once the mesh is mapped by `view` to canvas row, column
+// and depth: mask[f] is set to 1 for the faces of every node whose mapped bounds reach the canvas and to 0 for
+// all others. Returns the number of faces marked.
+size_t markFacesOnCanvas(const Bvh &bvh, const Mat4 &view, int height, int width, uint8_t *mask);
+
+// Function to list every face cluster by cluster, with the clusters ordered from nearest to farthest once the
+// mesh is mapped by `view` to canvas row, column and depth. The clusters are the topmost nodes with at most
+// clusterSize faces; they are sorted by the quantized nearest depth of their mapped bounds, with a radix sort
+// that keeps clusters of equal depth in hierarchy order.
+void orderFacesFrontToBack(const Bvh &bvh, const Mat4 &view, std::vector<uint32_t> &order, uint32_t clusterSize = 64);
+
+#endif // BVH_H
@@ -0,0 +1,30 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "linalg.h"
+
+// An orthographic camera: the viewing direction, the two image axes perpendicular to it and the point that
+// maps to canvas pixel (0, 0) at depth 0. The view matrix from world space to canvas row, canvas column and
+// depth is computed once when the camera is built, so rendering only reads it.
+class Camera
+{
+public:
+    Camera();
+    explicit Camera(const Vec3 &normal, const Vec3 &origin = Vec3());
+
+    const Vec3 &getNormal() const { return normal; }
+    const Vec3 &getOrigin() const { return origin; }
+    const Mat3 &getBasis() const { return basis; } // Rows: the normal, the row axis and the column axis
+    const Mat4 &getView() const { return view; }   // World space to canvas row, canvas column and depth
+
+    // Maps a world-space point to its canvas row, canvas column and depth
+    Vec3 toScreen(const Vec3 &point) const { return transformPoint(view, point); }
+
+private:
+    Vec3 normal; // Unit viewing direction
+    Vec3 origin; // World point at canvas pixel (0, 0) and depth 0
+    Mat3 basis;
+    Mat4 view;
+};
+
+#endif // CAMERA_H
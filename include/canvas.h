@@ -1,37 +1,161 @@
 #ifndef CANVAS_H
 #define CANVAS_H
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <vector>
 #include <string>
+#include "camera.h"
+#include "image.h"
+
+// How Canvas::clear resets the canvas
+enum class ClearMode
+{
+    Fill,  // Overwrite every pixel and depth value
+    Epoch  // Start a new frame epoch; pixels drawn in earlier epochs count as cleared
+};
 
 class Canvas
 {
 
 public:
+    static constexpr int kDepthBlockSize = 8; // Edge length of the square pixel blocks whose farthest depth is tracked
+
     Canvas(int h, int w);
     void putPixel(int x, int y, float depth, std::vector<float> &color);
+    void putPixel(int x, int y, float depth, uint32_t color);
+    bool putDepth(int x, int y, float depth);      // The depth test and depth write of putPixel, without the color
+    void shadePixel(int x, int y, uint32_t color); // Sets the color of a pixel whose depth putDepth took
     int getWidth() const;
     int getHeight() const;
     void writePPM(const std::string &filename);
+    void writeImage(const std::string &filename, ImageFormat format);
     void setCameraNormal(std::vector<float> &normal);
+    void setCamera(const Camera &camera);
+    const Camera &getCamera() const { return camera; }
     void clear();
+    void setClearMode(ClearMode mode);
     std::vector<float> getCameraNormal() const;
     std::vector<std::vector<float>> getCameraAxis() const;
+
+    // Farthest depth of the block holding pixel (x, y), infinity while any of its pixels is empty. It is updated
+    // by refreshBlockDepth only, so it may be farther than the stored depths but never nearer.
+    float getBlockDepth(int x, int y) const
+    {
+        const size_t index = blockIndex(x, y);
+        return blockEpochs[index] == epoch ? blockDepth[index] : std::numeric_limits<float>::infinity();
+    }
+    void refreshBlockDepth(int x, int y);
+    // Lowers the farthest depth of the block holding pixel (x, y) to `depth`, once none of its pixels is farther
+    void lowerBlockDepth(int x, int y, float depth)
+    {
+        const size_t index = blockIndex(x, y);
+        blockDepth[index] = std::min(getBlockDepth(x, y), depth);
+        blockEpochs[index] = epoch;
+    }
     
     #ifdef UNIT_TEST
-    const std::vector<std::vector<std::vector<float>>>& getPixels() const { return pixels; }
-    const std::vector<std::vector<float>>& getDepthBuffer() const { return depth; }
+    // Copies of the planes with the pixels of earlier epochs shown as cleared
+    std::vector<uint32_t> getPixels() const { return resolved(pixels, 0u); }
+    std::vector<float> getDepthBuffer() const { return resolved(depth, 0.0f); }
     #endif
     
 
 private:
     int height;
     int width;
-    std::vector<float> cameraNormal;
-    std::vector<float> cameraOrthonormal1, cameraOrthonormal2; 
-    std::vector<std::vector<std::vector<float>>> pixels;
-    std::vector<std::vector<float>> depth;
+    Camera camera; // View basis and view matrix, computed when the camera is set
+    std::vector<uint32_t> pixels; // Packed RGB color of each pixel (see packColor), row by row
+    std::vector<float> depth;     // Depth of each pixel, row by row; 0 where nothing was drawn
+    std::vector<uint8_t> epochs;  // Epoch in which each pixel was last drawn; other epochs count as cleared
+    uint8_t epoch = 0;            // The current epoch
+    int blockCols;                // Number of depth blocks per row of blocks
+    std::vector<float> blockDepth; // Farthest depth of each block of pixels (see getBlockDepth), row by row
+    std::vector<uint8_t> blockEpochs; // Epoch in which each block's depth was last set; other epochs count as empty
+    ClearMode clearMode = ClearMode::Fill;
+
+    void resolvePixels();
+    size_t blockIndex(int x, int y) const { return static_cast<size_t>(x / kDepthBlockSize) * blockCols + y / kDepthBlockSize; }
 
+#ifdef UNIT_TEST
+    template <typename T>
+    std::vector<T> resolved(const std::vector<T> &plane, T background) const
+    {
+        std::vector<T> copy(plane);
+        for (size_t i = 0; i < copy.size(); ++i)
+        {
+            if (epochs[i] != epoch)
+            {
+                copy[i] = background;
+            }
+        }
+        return copy;
+    }
+#endif
 };
 
+/**
+ * @brief Places a pixel with the specified packed color and depth at the given coordinates.
+ *
+ * This is the overload used by the rasterizer. It is defined here so it can be inlined into the pixel loop.
+ * A pixel last drawn in an earlier epoch counts as cleared, so it is always replaced.
+ *
+ * @param x The row of the pixel.
+ * @param y The column of the pixel.
+ * @param depth The depth value of the pixel.
+ * @param color The color of the pixel, packed with packColor.
+ */
+inline void Canvas::putPixel(int x, int y, float depth, uint32_t color)
+{
+    if (x >= 0 && x < height && y >= 0 && y < width)
+    {
+        size_t index = static_cast<size_t>(x) * width + y;
+        if (epochs[index] != epoch || (depth != 0 && this->depth[index] > depth) || this->depth[index] == 0.0f)
+        {
+            this->pixels[index] = color;
+            this->depth[index] = depth;
+            this->epochs[index] = epoch;
+        }
+    }
+}
+
+/**
+ * @brief Runs the depth test of putPixel and writes the depth, leaving the color to a later shadePixel.
+ *
+ * This is the raster half of deferred shading: a pixel that takes the depth here is colored once, by the face
+ * that took it last, when the rasterizer resolves its tile.
+ *
+ * @param x The row of the pixel.
+ * @param y The column of the pixel.
+ * @param depth The depth value of the pixel.
+ * @return Whether the pixel took the depth, as putPixel would have taken the color.
+ */
+inline bool Canvas::putDepth(int x, int y, float depth)
+{
+    if (x >= 0 && x < height && y >= 0 && y < width)
+    {
+        size_t index = static_cast<size_t>(x) * width + y;
+        if (epochs[index] != epoch || (depth != 0 && this->depth[index] > depth) || this->depth[index] == 0.0f)
+        {
+            this->depth[index] = depth;
+            this->epochs[index] = epoch;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Sets the color of a pixel, leaving its depth as putDepth wrote it.
+ *
+ * @param x The row of the pixel, which must be on the canvas.
+ * @param y The column of the pixel, which must be on the canvas.
+ * @param color The color of the pixel, packed with packColor.
+ */
+inline void Canvas::shadePixel(int x, int y, uint32_t color)
+{
+    pixels[static_cast<size_t>(x) * width + y] = color;
+}
+
 #endif // CANVAS_H
@@ -0,0 +1,28 @@
+#ifndef COLOR_H
+#define COLOR_H
+
+#include <cstdint>
+
+// Packs an RGB color with components in [0, 1] into 8 bits per channel: red in the low byte, then green and blue.
+// Each channel is truncated the same way writePPM converts intensities to 0-255.
+inline uint32_t packColor(float r, float g, float b)
+{
+    auto channel = [](float value) -> uint32_t
+    {
+        float scaled = value * 255;
+        return scaled <= 0 ? 0u : scaled >= 255 ? 255u : static_cast<uint32_t>(scaled);
+    };
+    return channel(r) | (channel(g) << 8) | (channel(b) << 16);
+}
+
+// Unpacks a packed color into RGB floats. Each value sits in the middle of its 1/255 step, so converting it
+// back to 0-255 gives the packed byte again.
+inline void unpackColor(uint32_t packed, float rgb[3])
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        rgb[k] = (((packed >> (8 * k)) & 0xFF) + 0.5f) / 255.0f;
+    }
+}
+
+#endif // COLOR_H
@@ -0,0 +1,53 @@
+#ifndef FRAME_WRITER_H
+#define FRAME_WRITER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Canvas.h"
+
+// Writes finished frames to disk on background threads while the next frames are rendered. It owns a fixed
+// pool of canvases: the renderer acquires a cleared one, draws into it and submits it with a file name. A
+// writer thread encodes and writes it, clears it and returns it to the pool. When every canvas is queued or
+// being written, acquire() waits, which keeps the renderer from running ahead of the disk.
+class FrameWriter
+{
+public:
+    FrameWriter(const Canvas &prototype, size_t canvasCount = 2, size_t writerCount = 1);
+    ~FrameWriter();
+
+    FrameWriter(const FrameWriter &) = delete;
+    FrameWriter &operator=(const FrameWriter &) = delete;
+
+    Canvas &acquire();
+    void submit(Canvas &canvas, const std::string &filename, ImageFormat format);
+    void finish();
+
+private:
+    // A finished frame waiting to be written
+    struct Job
+    {
+        Canvas *canvas;
+        std::string filename;
+        ImageFormat format;
+    };
+
+    void writerLoop();
+
+    std::vector<std::unique_ptr<Canvas>> canvases; // The pool, in no particular state
+    std::vector<Canvas *> freeCanvases;            // Cleared canvases ready to be acquired
+    std::deque<Job> jobs;                          // Submitted frames, in submission order
+    size_t busy = 0;                               // Frames taken from the queue and still being written
+    bool stopping = false;                         // Set by the destructor to end the writer threads
+
+    std::mutex mutex;
+    std::condition_variable canvasFreed; // Signaled when a canvas returns to the pool
+    std::condition_variable jobQueued;   // Signaled when a frame is submitted, or when stopping
+    std::vector<std::thread> writers;
+};
+
+#endif // FRAME_WRITER_H
@@ -0,0 +1,21 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// File formats a canvas can be written in
+enum class ImageFormat
+{
+    PPM, // ASCII PPM (P3), as written by writePPM
+    P6,  // Binary PPM
+    QOI, // Quite OK Image format, lossless and compressed
+    PNG  // PNG with uncompressed (stored) deflate blocks
+};
+
+// Function to encode packed RGB pixels (see packColor), stored row by row, into a complete image file.
+// Bands of rows are encoded on multiple threads; the output does not depend on the number of threads.
+std::vector<uint8_t> encodeImage(const uint32_t *pixels, int width, int height, ImageFormat format);
+
+#endif // IMAGE_H
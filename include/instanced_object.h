@@ -0,0 +1,44 @@
+#ifndef INSTANCED_OBJECT_H
+#define INSTANCED_OBJECT_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "linalg.h"
+#include "triangle_object.h"
+
+// One copy of an instanced mesh
+struct Instance
+{
+    Mat4 model;            // Affine transform from the mesh's own frame
+    uint32_t color = 0;    // Packed RGB color of all the copy's faces (see packColor), when hasColor is set
+    bool hasColor = false; // Draw the faces in `color` rather than in their own colors
+};
+
+// Many copies of one mesh, each with its own transform and, optionally, its own color. The geometry is loaded
+// and stored once, and a single set of projection buffers serves every copy.
+class InstancedObject
+{
+public:
+    InstancedObject(const std::string &stlFileName, const LoadOptions &options = LoadOptions());
+    explicit InstancedObject(std::shared_ptr<const MeshGeometry> geometry);
+
+    size_t addInstance(const Mat4 &model);
+    size_t addInstance(const Mat4 &model, const std::vector<float> &color);
+    Instance &getInstance(size_t index);
+    const Instance &getInstance(size_t index) const;
+    size_t instanceCount() const;
+    void clearInstances();
+
+    RenderStats project(Canvas &c, const RenderOptions &options = RenderOptions());
+
+    size_t getMemoryUsage() const;
+    std::shared_ptr<const MeshGeometry> getGeometry() const;
+
+private:
+    std::shared_ptr<const MeshGeometry> geometry; // The mesh and its hierarchies, shared by every copy
+    std::vector<Instance> instances;              // The copies, drawn in order
+    RenderScratch scratch;                        // Projection buffers, reused for every copy and frame
+};
+
+#endif // INSTANCED_OBJECT_H
@@ -1,8 +1,145 @@
 #ifndef LINALG_H
 #define LINALG_H
 
+#include <cmath>
+#include <utility>
 #include <vector>
 
+// A 3D vector held by value; all of its operations are inline and usable in constant expressions
+struct Vec3
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    constexpr float operator[](int i) const { return i == 0 ? x : i == 1 ? y : z; }
+    constexpr float &operator[](int i) { return i == 0 ? x : i == 1 ? y : z; }
+
+    constexpr Vec3 &operator+=(const Vec3 &v) { x += v.x; y += v.y; z += v.z; return *this; }
+    constexpr Vec3 &operator-=(const Vec3 &v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+    constexpr Vec3 &operator*=(float k) { x *= k; y *= k; z *= k; return *this; }
+    constexpr Vec3 &operator/=(float k) { x /= k; y /= k; z /= k; return *this; }
+
+    constexpr bool operator==(const Vec3 &v) const = default;
+};
+
+constexpr Vec3 operator+(Vec3 a, const Vec3 &b) { return a += b; }
+constexpr Vec3 operator-(Vec3 a, const Vec3 &b) { return a -= b; }
+constexpr Vec3 operator-(const Vec3 &a) { return {-a.x, -a.y, -a.z}; }
+constexpr Vec3 operator*(Vec3 a, float k) { return a *= k; }
+constexpr Vec3 operator*(float k, Vec3 a) { return a *= k; }
+constexpr Vec3 operator/(Vec3 a, float k) { return a /= k; }
+
+// Dot product, cross product and length of 3D vectors
+constexpr float dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+constexpr Vec3 cross(const Vec3 &a, const Vec3 &b) { return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x}; }
+inline float length(const Vec3 &a) { return std::sqrt(dot(a, a)); }
+
+// A 3x3 matrix stored as three row vectors
+struct Mat3
+{
+    Vec3 rows[3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+    constexpr const Vec3 &operator[](int i) const { return rows[i]; }
+    constexpr Vec3 &operator[](int i) { return rows[i]; }
+
+    constexpr bool operator==(const Mat3 &m) const = default;
+};
+
+constexpr Vec3 operator*(const Mat3 &m, const Vec3 &v) { return {dot(m[0], v), dot(m[1], v), dot(m[2], v)}; }
+
+constexpr Mat3 operator*(const Mat3 &a, const Mat3 &b)
+{
+    Mat3 result;
+    for (int i = 0; i < 3; ++i)
+    {
+        result[i] = a[i][0] * b[0] + a[i][1] * b[1] + a[i][2] * b[2];
+    }
+    return result;
+}
+
+constexpr Mat3 transpose(const Mat3 &m)
+{
+    return {{{m[0].x, m[1].x, m[2].x}, {m[0].y, m[1].y, m[2].y}, {m[0].z, m[1].z, m[2].z}}};
+}
+
+constexpr float determinant(const Mat3 &m)
+{
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+           m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+           m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+// The cofactor matrix, det(m) times the inverse transpose; it maps the normals of triangles transformed by m
+constexpr Mat3 cofactor(const Mat3 &m)
+{
+    return {{cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1])}};
+}
+
+// A 4x4 matrix in row-major order; affine transforms keep {0, 0, 0, 1} as their last row
+struct Mat4
+{
+    float m[4][4] = {{1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 1}};
+
+    constexpr const float *operator[](int i) const { return m[i]; }
+    constexpr float *operator[](int i) { return m[i]; }
+
+    constexpr bool operator==(const Mat4 &other) const = default;
+
+    // The upper-left 3x3 block: the linear part of an affine transform
+    constexpr Mat3 linear() const
+    {
+        return {{{m[0][0], m[0][1], m[0][2]}, {m[1][0], m[1][1], m[1][2]}, {m[2][0], m[2][1], m[2][2]}}};
+    }
+
+    // The affine transform with the given linear part and translation
+    static constexpr Mat4 affine(const Mat3 &linear, const Vec3 &translation)
+    {
+        Mat4 result;
+        for (int i = 0; i < 3; ++i)
+        {
+            result[i][0] = linear[i].x;
+            result[i][1] = linear[i].y;
+            result[i][2] = linear[i].z;
+            result[i][3] = translation[i];
+        }
+        return result;
+    }
+};
+
+constexpr Mat4 operator*(const Mat4 &a, const Mat4 &b)
+{
+    Mat4 result;
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            result[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + a[i][3] * b[3][j];
+        }
+    }
+    return result;
+}
+
+// Applies an affine transform to a point
+constexpr Vec3 transformPoint(const Mat4 &m, const Vec3 &p)
+{
+    return {m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+            m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+            m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]};
+}
+
+// Conversions between Vec3 and the three-element vectors of the older interfaces
+inline Vec3 toVec3(const std::vector<float> &v) { return {v[0], v[1], v[2]}; }
+inline std::vector<float> toVector(const Vec3 &v) { return {v.x, v.y, v.z}; }
+
+// Function to calculate two unit vectors that form an orthonormal basis with a unit vector
+std::pair<Vec3, Vec3> calculateOrthonormals(const Vec3 &v1);
+
+std::pair<std::pair<float, float>, std::pair<float, float>> calculateDotProductExtremes
+(
+    const Vec3 &projectedA, const Vec3 &projectedB, const Vec3 &projectedC, const Mat3 &cameraBasis
+);
+
 // Function to calculate the determinant of a 3x3 matrix formed by three vectors
 float determinant3x3(const std::vector<float> &v1, const std::vector<float> &v2, const std::vector<float> &v3);
 
@@ -17,7 +154,7 @@ std::vector<std::vector<float>> calculateOrthonormals(const std::vector<float> &
 
 std::pair<std::pair<float, float>, std::pair<float, float>> calculateDotProductExtremes
 (
-    const std::vector<float>& projectedA, const std::vector<float>& projectedB, const std::vector<float>& projectedC, 
+    const std::vector<float>& projectedA, const std::vector<float>& projectedB, const std::vector<float>& projectedC,
     const std::vector<std::vector<float>>& cameraAxis
 );
 
@@ -0,0 +1,27 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file, unmapped when the object is destroyed
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string &filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const;
+    const char *data() const;
+    size_t size() const;
+
+private:
+    void *mapping;
+    size_t length;
+    bool open;
+};
+
+#endif // MAPPED_FILE_H
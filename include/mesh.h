@@ -0,0 +1,47 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <cstdint>
+#include <vector>
+#include "stl.h"
+
+// Vertex coordinates stored as 16-bit steps across the bounding box of a mesh: a vertex is at origin + code * step
+struct QuantizedVertices
+{
+    std::vector<uint16_t> x, y, z; // Codes of each unique vertex
+    float origin[3] = {};          // Smallest x, y and z of the mesh
+    float step[3] = {};            // Size of one step along each axis; 0 along an axis where the mesh is flat
+};
+
+// Indexed triangle mesh: every distinct vertex is stored once and faces refer to it by index.
+// Vertex coordinates are kept as separate x, y and z arrays so transforms stream over them linearly.
+struct Mesh
+{
+    std::vector<float> x, y, z;    // Coordinates of each unique vertex
+    std::vector<uint32_t> indices; // Three vertex indices per face
+    std::vector<uint32_t> colors;  // Packed RGB color of each face (see packColor)
+    std::vector<float> normals;    // Unit normal of each face, three floats per face; zeros for a degenerate face
+    QuantizedVertices quantized;   // Compact copy of the vertices, made by quantizeVertices; x, y and z may then be freed
+
+    size_t vertexCount() const;
+    bool isQuantized() const; // Whether the vertices are only held in `quantized`
+    void getVertex(size_t index, float position[3]) const;
+    size_t faceCount() const;
+    void getBounds(float boundsMin[3], float boundsMax[3]) const;
+    size_t getMemoryUsage() const;
+};
+
+// Function to build an indexed mesh from a triangle soup, merging vertices that are at most epsilon apart
+// on every axis (epsilon = 0 merges only identical vertices)
+Mesh weldVertices(const TriangleSoup &soup, float epsilon = 0.0f);
+
+// Function to reorder the faces of a mesh along a Morton curve through their centroids, so faces near each other
+// in space are near each other in memory, and to renumber the vertices in the order the faces first use them
+void sortFacesByMortonCode(Mesh &mesh);
+
+// Function to fill mesh.quantized with the vertices of a mesh and move x, y and z onto the 16-bit grid, so that
+// anything built from them matches the vertices the codes decode to. Clearing x, y and z afterwards halves the
+// memory of the vertices; no vertex moves by more than half a step, 1/131070 of the mesh's extent on each axis.
+void quantizeVertices(Mesh &mesh);
+
+#endif // MESH_H
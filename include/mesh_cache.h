@@ -0,0 +1,17 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <string>
+#include "mesh.h"
+
+// Function to get the path of the cache file kept next to an STL file
+std::string meshCachePath(const std::string &stlFileName);
+
+// Function to load a mesh from its cache file; fails if the cache is missing, from another format version,
+// built with another weld epsilon, older than the STL file it was built from, or damaged
+bool readMeshCache(const std::string &stlFileName, float weldEpsilon, Mesh &mesh);
+
+// Function to write the cache file of a mesh loaded from an STL file
+bool writeMeshCache(const std::string &stlFileName, float weldEpsilon, const Mesh &mesh);
+
+#endif // MESH_CACHE_H
@@ -0,0 +1,90 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <cstdint>
+#include <vector>
+#include "Canvas.h"
+
+// Edge equations and depth plane of one triangle, set up once and then stepped across its pixels.
+// Pixels are sampled at integer (row, column) positions.
+struct TriangleSetup
+{
+    int rowBegin, rowEnd, colBegin, colEnd; // Pixels to visit: the bounding box clipped to the target, half-open
+    int64_t edge[3];                        // Edge functions at (rowBegin, colBegin), biased for the fill rule
+    int64_t edgeStepRow[3];                 // Change of each edge function per row
+    int64_t edgeStepCol[3];                 // Change of each edge function per column
+    float depth;                            // Depth plane extended to row 0, column 0
+    float depthStepRow;                     // Change of the depth per row
+    float depthStepCol;                     // Change of the depth per column
+};
+
+// Function to set up the edge equations of a triangle whose vertices are three floats each: canvas row,
+// canvas column and depth along the camera normal. Only pixels in [rowBegin, rowEnd) x [colBegin, colEnd) are
+// visited. Returns false if the triangle covers none of them.
+bool setupTriangle(const float *a, const float *b, const float *c, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                   TriangleSetup &setup);
+
+// Function to call plot(row, column, depth) for every pixel covered by a set-up triangle. A pixel on an edge
+// shared by two triangles is covered by exactly one of them (top-left fill rule).
+template <typename Plot>
+inline void scanTriangle(const TriangleSetup &setup, Plot &&plot)
+{
+    int64_t rowEdge[3] = {setup.edge[0], setup.edge[1], setup.edge[2]};
+
+    for (int i = setup.rowBegin; i < setup.rowEnd; ++i)
+    {
+        int64_t e0 = rowEdge[0], e1 = rowEdge[1], e2 = rowEdge[2];
+        float rowDepth = setup.depth + setup.depthStepRow * i;
+
+        for (int j = setup.colBegin; j < setup.colEnd; ++j)
+        {
+            if ((e0 | e1 | e2) >= 0) // All three edge functions are non-negative
+            {
+                // Evaluated from the pixel position alone, so the depth does not depend on where the scan started
+                plot(i, j, rowDepth + setup.depthStepCol * j);
+            }
+            e0 += setup.edgeStepCol[0];
+            e1 += setup.edgeStepCol[1];
+            e2 += setup.edgeStepCol[2];
+        }
+
+        rowEdge[0] += setup.edgeStepRow[0];
+        rowEdge[1] += setup.edgeStepRow[1];
+        rowEdge[2] += setup.edgeStepRow[2];
+    }
+}
+
+// Function to rasterize one triangle given its screen-space vertices, three floats each:
+// canvas row, canvas column and depth along the camera normal
+void rasterizeTriangle(Canvas &canvas, const float *a, const float *b, const float *c, std::vector<float> &color);
+void rasterizeTriangle(Canvas &canvas, const float *a, const float *b, const float *c, uint32_t color);
+
+// Indexed triangles whose vertices are already in screen space
+struct ScreenBatch
+{
+    const float *vertices;   // Canvas row, canvas column and depth of every vertex
+    const uint32_t *indices; // Three vertex indices per face
+    const uint32_t *colors;  // Packed RGB color of each face (see packColor), or of all of them with sharedColor
+    size_t faceCount;        // Number of faces
+    const uint8_t *faceMask = nullptr; // Optional: faces whose entry is 0 are skipped
+    const uint32_t *order = nullptr;   // Optional: every face index once, in the order to draw them
+    bool cullOccluded = false;         // Skip faces the canvas's depth blocks show to be hidden
+    bool sharedColor = false;          // Draw every face in colors[0]
+    bool deferShading = false;         // Write only depths and face indices, then color each pixel the batch won once
+};
+
+// What a call to rasterizeBatch did, counted per pair of a face and a screen tile it overlaps
+struct RasterStats
+{
+    size_t faceTiles = 0;         // Pairs set up for rasterization
+    size_t faceTilesOccluded = 0; // Pairs skipped as hidden before any pixel was visited
+    size_t pixelsWritten = 0;     // Pixels that passed the depth test; counted with deferred shading only
+    size_t pixelsShaded = 0;      // Pixels colored once the batch was rasterized; counted with deferred shading only
+};
+
+// Function to rasterize a batch of triangles in screen tiles on all cores. The result is the same as
+// rasterizing the faces one after another in order, or in batch.order when it is given, with or without
+// deferred shading.
+RasterStats rasterizeBatch(Canvas &canvas, const ScreenBatch &batch);
+
+#endif // RASTER_H
@@ -0,0 +1,62 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "linalg.h"
+#include "triangle_object.h"
+
+// An assembly of meshes, each with its own transform, drawn together. The STL files of an assembly are loaded
+// concurrently, so loading it takes about as long as its largest part. Every frame, the objects are culled and
+// their vertices mapped one after another into shared buffers, and all their faces are then binned and
+// rasterized in a single pass; the image is the same as projecting the objects one by one in order.
+class Scene
+{
+public:
+    Scene() = default;
+
+    size_t add(std::shared_ptr<const MeshGeometry> geometry, const Mat4 &model = Mat4());
+    size_t load(const std::vector<std::string> &stlFileNames, const LoadOptions &options = LoadOptions(),
+                size_t threadCount = 0);
+    size_t objectCount() const;
+
+    const Mat4 &getTransform(size_t index) const;
+    void setTransform(size_t index, const Mat4 &model);
+    std::shared_ptr<const MeshGeometry> getGeometry(size_t index) const;
+    void getBounds(size_t index, float boundsMin[3], float boundsMax[3]) const;
+    void getBounds(float boundsMin[3], float boundsMax[3]) const;
+
+    RenderStats project(Canvas &c, const RenderOptions &options = RenderOptions());
+
+    size_t getMemoryUsage() const;
+
+private:
+    // One mesh of the scene
+    struct SceneObject
+    {
+        std::shared_ptr<const MeshGeometry> geometry; // The mesh and its hierarchies, possibly shared with other objects
+        Mat4 model;                                   // Affine transform applied to the mesh
+        float boundsMin[3] = {};                      // Smallest x, y and z of the mesh, in its own frame
+        float boundsMax[3] = {};                      // Largest x, y and z of the mesh
+    };
+
+    std::vector<SceneObject> objects; // The objects, drawn in order
+
+    // The faces of every object, with their vertex indices moved past the vertices of the objects before
+    // them. They only change when an object is added or drawn at another level of detail.
+    std::vector<size_t> batchLevels;   // Level of detail of each object in the arrays below; empty when out of date
+    std::vector<size_t> vertexStart;   // Position of each object's first vertex in `projected`, and the total
+    std::vector<size_t> faceStart;     // Position of each object's first face in the arrays below, and the total
+    std::vector<uint32_t> indices;     // Three vertex indices per face
+    std::vector<uint32_t> colors;      // Packed RGB color of each face
+
+    // Buffers filled and read within a single projection, kept so they are only allocated once
+    std::vector<float> projected;      // Screen-space row, column and depth of every vertex of every object
+    std::vector<uint8_t> faceMask;     // Whether each face survived culling
+    std::vector<uint8_t> blockUsed;    // Whether each block of an object's vertices is used by a face that survived
+    std::vector<uint32_t> drawOrder;   // Faces nearest first when sorting front to back
+    std::vector<uint32_t> objectOrder; // Faces of one object nearest first, before they join drawOrder
+};
+
+#endif // SCENE_H
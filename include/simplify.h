@@ -0,0 +1,19 @@
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include <vector>
+#include "mesh.h"
+
+// One level of detail of a mesh
+struct MeshLod
+{
+    Mesh mesh;   // The simplified mesh; each face keeps the color of the original face it came from
+    float error; // Typical distance of a vertex to the planes of the original faces it replaces, in mesh units
+};
+
+// Function to build ever coarser levels of detail of a mesh by collapsing the edges of least quadric error.
+// Each level has at most `ratio` times the faces of the one before; the chain stops before a level with fewer
+// than minFaces faces, or when no edge can be collapsed without flipping a face.
+std::vector<MeshLod> buildLodChain(const Mesh &mesh, float ratio = 0.25f, size_t minFaces = 256);
+
+#endif // SIMPLIFY_H
@@ -1,15 +1,57 @@
 #ifndef STL_H
 #define STL_H
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 #include "TriangleSurface.h"
 #include "Canvas.h"
 
+// Faces read from an STL file before any vertex sharing is established
+struct TriangleSoup
+{
+    std::vector<float> vertices; // Nine floats per face: x, y, z of its three vertices
+    std::vector<float> colors;   // Three floats per face: r, g, b
+    std::vector<float> normals;  // Three floats per face: the facet normal stored in the file, zeros if none
+
+    size_t size() const;
+};
+
+// Generator of the numbers rand() returns after srand(seed) in the GNU C library, with state of its own, so files
+// read on several threads at once each get the colors they would get alone, on any platform
+class RandomSequence
+{
+public:
+    static constexpr int32_t kMax = 2147483647; // Largest number returned, RAND_MAX in the GNU C library
+
+    explicit RandomSequence(uint32_t seed = 0);
+    int32_t next();
+
+private:
+    uint32_t state[31]; // The last 31 values of the additive feedback sequence
+    int front = 3;      // Position of the value the next step adds to
+    int rear = 0;       // Position of the value it adds, 31 - 3 steps behind
+};
+
 // Function to generate a random color
 std::vector<float> getRandomColor();
 
-// Function to read an STL file and return a vector of TriangleSurface objects
+// Function to generate a random color from the next three numbers of a sequence
+std::vector<float> getRandomColor(RandomSequence &random);
+
+// Function to check whether a buffer holds a binary (rather than ASCII) STL file
+bool isBinarySTL(const char *data, size_t size);
+
+// Function to decode the facet records of a binary STL buffer into a triangle soup
+void readBinarySTL(const char *data, size_t size, TriangleSoup &soup);
+
+// Function to parse an ASCII STL buffer on several threads, in facet-aligned chunks (0 = pick from thread count)
+void readAsciiSTL(const char *data, size_t size, TriangleSoup &soup, int chunkCount = 0);
+
+// Function to read an ASCII or binary STL file into a triangle soup
+void readSTL(const std::string &filename, TriangleSoup &soup);
+
+// Function to read an ASCII or binary STL file and return a vector of TriangleSurface objects
 void readSTL(const std::string &filename, std::shared_ptr<std::vector<TriangleSurface>> triangles);
 
 #endif
\ No newline at end of file
@@ -3,13 +3,15 @@
 
 #include <vector>
 #include "Canvas.h"
+#include "linalg.h"
 
 class TriangleSurface
 {
 public:
-    TriangleSurface(const std::vector<float> &a, const std::vector<float> &b, const std::vector<float> &c, const std::vector<float> &color);
+    TriangleSurface(const Vec3 &a, const Vec3 &b, const Vec3 &c, const Vec3 &color);
 
     void project(Canvas &c);
+    void project(Canvas &c, const Camera &camera) const;
 
     std::vector<float> isInside(std::vector<float> &point, const std::vector<float> &projectedA, const std::vector<float> &projectedB, const std::vector<float> &projectedC) const;
 
@@ -23,19 +25,24 @@ public:
     void translate(float x , float y , float z);
 
 private:
-    std::vector<float> A; // First point of the triangle
-    std::vector<float> B; // Second point of the triangle
-    std::vector<float> C; // Third point of the triangle
-    std::vector<float> color;
+    void rotate(const Mat3 &rotation, const std::vector<float> &rotationPoint);
+
+    Vec3 A; // First point of the triangle
+    Vec3 B; // Second point of the triangle
+    Vec3 C; // Third point of the triangle
+    Vec3 color;
 
 #ifdef UNIT_TEST
 public:
     // Make these private members accessible only for testing
-    const std::vector<float>& getA() const { return A; }
-    const std::vector<float>& getB() const { return B; }
-    const std::vector<float>& getC() const { return C; }
-    const std::vector<float>& getColor() const { return color; }
+    std::vector<float> getA() const { return toVector(A); }
+    std::vector<float> getB() const { return toVector(B); }
+    std::vector<float> getC() const { return toVector(C); }
+    std::vector<float> getColor() const { return toVector(color); }
 #endif
 };
 
+// Function to project a batch of triangles onto a canvas, reading the canvas camera once
+void projectTriangles(Canvas &c, const std::vector<TriangleSurface> &triangles);
+
 #endif // TRIANGLE_H
@@ -5,15 +5,96 @@
 #include <string>
 #include <memory>
 #include "TriangleSurface.h"
+#include "bvh.h"
+#include "linalg.h"
+#include "mesh.h"
+#include "simplify.h"
 
+// Options controlling how a TriangleObject loads its STL file
+struct LoadOptions
+{
+    float weldEpsilon = 0.0f;     // Largest per-axis distance at which vertices are merged; 0 merges only identical ones
+    bool useCache = true;         // Load from / write to the mesh cache file next to the STL file
+    bool buildLods = false;       // Build coarser levels of detail for RenderOptions::lodPixelError; adds to the load time
+    bool reorderFaces = false;    // Sort the faces along a space-filling curve, for locality; faces at equal depth may swap
+    bool compactVertices = false; // Keep the vertices as 16-bit codes across the bounding box: half the memory, each
+                                  // vertex within 1/131070 of the box's extent of where it was
+};
+
+// Options controlling how a TriangleObject or InstancedObject is rendered
+struct RenderOptions
+{
+    bool cullBackFaces = false;   // Skip faces whose normal points away from the camera; for closed meshes only
+    bool cullOffCanvas = true;    // Skip the parts of the bounding volume hierarchy that miss the canvas
+    bool cullOccluded = false;    // Skip faces hidden behind what the canvas already holds; pays off when near faces come first
+    bool sortFrontToBack = false; // Draw the faces nearest first, so hidden ones fail the depth test; faces at equal depth may swap
+    float lodPixelError = 0.0f;   // Draw the coarsest level of detail whose error spans at most this many pixels; 0 draws the full mesh
+    bool deferShading = false;    // Rasterize depths and face indices only, then color each visible pixel once
+};
 
+// What a call to TriangleObject::project or InstancedObject::project drew
+struct RenderStats
+{
+    size_t facesDrawn = 0;        // Faces handed to the rasterizer
+    size_t facesCulled = 0;       // Faces skipped as back-facing
+    size_t facesOffCanvas = 0;    // Faces skipped with a part of the hierarchy that misses the canvas
+    size_t faceTiles = 0;         // Pairs of a drawn face and a screen tile it covers
+    size_t faceTilesOccluded = 0; // Those of the pairs skipped as hidden before any pixel was visited
+    size_t pixelsWritten = 0;     // Pixels that passed the depth test; counted with deferred shading only
+    size_t pixelsShaded = 0;      // Pixels colored after rasterizing; counted with deferred shading only
+    size_t lodLevel = 0;          // Level of detail drawn: 0 for the full mesh, higher for coarser ones
+
+    RenderStats &operator+=(const RenderStats &other); // Adds up the counts and keeps the coarser level
+};
+
+// Everything drawn from an STL file that does not change once it is loaded. It is shared, never copied, by all
+// the objects and instances drawn from the same file.
+struct MeshGeometry
+{
+    Mesh mesh;                 // Unique vertices, face indices and face colors, as loaded from the file
+    Bvh bvh;                   // Bounding volume hierarchy over the faces, in the mesh's own frame
+    std::vector<MeshLod> lods; // Coarser levels of detail, finest first; empty unless built at load
+    std::vector<Bvh> lodBvhs;  // Hierarchy over the faces of each level of detail
+
+    size_t selectLevel(const Mat4 &view, float maxPixelError) const;
+    const Mesh &levelMesh(size_t level) const; // The full mesh for level 0, lods[level - 1].mesh otherwise
+    const Bvh &levelBvh(size_t level) const;   // The hierarchy over the faces of levelMesh(level)
+    size_t getMemoryUsage() const;
+};
+
+// Buffers filled and read within a single projection, kept so they are only allocated once
+struct RenderScratch
+{
+    std::vector<float> projected;    // Screen-space row, column and depth of every vertex
+    std::vector<uint8_t> faceMask;   // Whether each face survived culling
+    std::vector<uint8_t> blockUsed;  // Whether each block of vertices is used by a face that survived
+    std::vector<uint32_t> drawOrder; // Faces nearest first when sorting front to back
+
+    size_t getMemoryUsage() const;
+};
+
+// Function to load the mesh of an STL file, from its mesh cache when it is up to date, and build its hierarchy
+std::shared_ptr<const MeshGeometry> loadGeometry(const std::string &stlFileName, const LoadOptions &options = LoadOptions());
+
+// Function to cull the faces of a mesh seen on a canvas through a model transform and map the vertices of the
+// faces left to canvas row, column and depth. faceMask gets one entry per face, 0 for the culled ones; projected
+// gets three floats per vertex, and those of vertices only culled faces use may be left unset. The lodLevel and
+// tile counts of the result are left at 0.
+RenderStats cullAndMapFaces(const Mesh &source, const Bvh &hierarchy, const Mat4 &model, const Canvas &c,
+                            const RenderOptions &options, uint8_t *faceMask, float *projected, std::vector<uint8_t> &blockUsed);
+
+// Function to project a geometry onto a canvas through a model transform. A non-null color (see packColor)
+// replaces the colors of all faces.
+RenderStats projectGeometry(const MeshGeometry &geometry, const Mat4 &model, const uint32_t *color, Canvas &c,
+                            const RenderOptions &options, RenderScratch &scratch);
 
 class TriangleObject
 {
 public:
-    TriangleObject(const std::string &stlFileName);
+    TriangleObject(const std::string &stlFileName, const LoadOptions &options = LoadOptions());
+    explicit TriangleObject(std::shared_ptr<const MeshGeometry> geometry);
     
-    void project(Canvas &c);
+    RenderStats project(Canvas &c, const RenderOptions &options = RenderOptions());
     
     void rotateAroundX(float angle, const std::vector<float> &rotationPoint);
     void rotateAroundY(float angle, const std::vector<float> &rotationPoint);
@@ -23,15 +104,26 @@ public:
     void translate(float x , float y , float z);
 
     int size();
+    size_t getMemoryUsage() const;
+    std::shared_ptr<const MeshGeometry> getGeometry() const;
+
+    std::shared_ptr<std::vector<TriangleSurface>> toTriangles() const;
 
 private:
 
-    std::shared_ptr<std::vector<TriangleSurface>> triangles;
-    size_t length;
+    void rotate(const Mat3 &rotation, const std::vector<float> &rotationPoint);
+    void compose(const Mat4 &transform);
+
+    std::shared_ptr<const MeshGeometry> geometry; // The mesh and its hierarchies, possibly shared with other objects
+    Mat4 model;                                   // Affine transform applied to the mesh
+    RenderScratch scratch;                        // Projection buffers, reused between frames
 
 #ifdef UNIT_TEST
 public:
-    std::shared_ptr<std::vector<TriangleSurface>> const getTriangles() {return triangles;};
+    std::shared_ptr<std::vector<TriangleSurface>> const getTriangles() {return toTriangles();};
+    const Mesh &getMesh() const {return geometry->mesh;};
+    const std::vector<MeshLod> &getLods() const {return geometry->lods;};
+    const Bvh &getBvh() const {return geometry->bvh;};
 #endif
 };
 
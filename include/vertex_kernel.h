@@ -0,0 +1,28 @@
+#ifndef VERTEX_KERNEL_H
+#define VERTEX_KERNEL_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Instruction sets the vertex kernel can run with, from slowest to fastest
+enum class SimdLevel
+{
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// Function to get the fastest instruction set supported by the running CPU
+SimdLevel detectSimdLevel();
+
+// Function to map vertices stored as separate x, y and z arrays through a 3x4 affine matrix. The results are
+// written interleaved, three floats per vertex. Every level computes bit-identical results.
+void transformVertices(const float matrix[3][4], const float *x, const float *y, const float *z, size_t count,
+                       float *out, SimdLevel level = detectSimdLevel());
+
+// Function to map vertices stored as 16-bit codes (see QuantizedVertices) through a 3x4 affine matrix that
+// includes their decoding, with the same output and guarantees
+void transformVertices(const float matrix[3][4], const uint16_t *x, const uint16_t *y, const uint16_t *z, size_t count,
+                       float *out, SimdLevel level = detectSimdLevel());
+
+#endif // VERTEX_KERNEL_H
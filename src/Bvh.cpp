@@ -0,0 +1,381 @@
+/**
+ * @file Bvh.cpp
+ * @brief This file contains the bounding volume hierarchy used to skip the parts of a mesh that miss the canvas.
+ *
+ * The hierarchy is built once, over the mesh as loaded. Transforms never move the vertices of a TriangleObject,
+ * only its model matrix, so the boxes stay valid in the mesh's own frame and never have to be refitted: each
+ * frame, a box is mapped to the canvas through the same matrix as the vertices. Since an affine map sends a
+ * box to a parallelepiped, its canvas extent follows from the box center and the absolute values of the matrix.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <cmath>
+ #include <limits>
+ #include "bvh.h"
+
+ namespace
+ {
+     // Canvas rows and columns a node may be off by and still be kept, covering the rounding of its mapped box
+     const float kMargin = 1.0f;
+
+     /**
+      * @brief Returns the extent of a node's box along row `i` of an affine map: its center and half its size.
+      */
+     inline void mappedExtent(const BvhNode &node, const Mat4 &view, int i, float &center, float &radius)
+     {
+         center = view[i][3];
+         radius = 0.0f;
+         for (int j = 0; j < 3; ++j)
+         {
+             center += view[i][j] * (node.boundsMin[j] + node.boundsMax[j]) * 0.5f;
+             radius += std::fabs(view[i][j]) * (node.boundsMax[j] - node.boundsMin[j]) * 0.5f;
+         }
+     }
+
+     /**
+      * @brief Sorts items by 16-bit keys, keeping items with equal keys in their order, with two 8-bit passes.
+      */
+     void radixSort(std::vector<uint16_t> &keys, std::vector<uint32_t> &items)
+     {
+         std::vector<uint16_t> sortedKeys(keys.size());
+         std::vector<uint32_t> sortedItems(items.size());
+
+         for (int shift = 0; shift < 16; shift += 8)
+         {
+             size_t start[257] = {};
+             for (uint16_t key : keys)
+             {
+                 ++start[((key >> shift) & 0xff) + 1];
+             }
+             for (int digit = 1; digit <= 256; ++digit)
+             {
+                 start[digit] += start[digit - 1];
+             }
+             for (size_t k = 0; k < keys.size(); ++k)
+             {
+                 size_t position = start[(keys[k] >> shift) & 0xff]++;
+                 sortedKeys[position] = keys[k];
+                 sortedItems[position] = items[k];
+             }
+             keys.swap(sortedKeys);
+             items.swap(sortedItems);
+         }
+     }
+
+     /**
+      * @brief Builds the hierarchy over the faces of a mesh, splitting each node in two along its longest axis.
+      */
+     class BvhBuilder
+     {
+     public:
+         BvhBuilder(const Mesh &mesh, uint32_t leafSize, Bvh &bvh) : mesh(mesh), leafSize(std::max(leafSize, 1u)), bvh(bvh)
+         {
+             items.resize(mesh.faceCount());
+             for (size_t f = 0; f < mesh.faceCount(); ++f)
+             {
+                 const uint32_t *face = mesh.indices.data() + 3 * f;
+                 items[f].centroid[0] = (mesh.x[face[0]] + mesh.x[face[1]] + mesh.x[face[2]]) / 3.0f;
+                 items[f].centroid[1] = (mesh.y[face[0]] + mesh.y[face[1]] + mesh.y[face[2]]) / 3.0f;
+                 items[f].centroid[2] = (mesh.z[face[0]] + mesh.z[face[1]] + mesh.z[face[2]]) / 3.0f;
+                 items[f].face = static_cast<uint32_t>(f);
+             }
+         }
+
+         /**
+          * @brief Appends the node holding faces [first, first + count) and its subtree, and returns its index.
+          */
+         uint32_t build(uint32_t first, uint32_t count)
+         {
+             const uint32_t index = static_cast<uint32_t>(bvh.nodes.size());
+             bvh.nodes.push_back({{0, 0, 0}, {0, 0, 0}, first, count, 0});
+             Item *range = items.data() + first;
+
+             if (count <= leafSize)
+             {
+                 for (uint32_t k = 0; k < count; ++k)
+                 {
+                     bvh.faces[first + k] = range[k].face;
+                 }
+                 setLeafBounds(bvh.nodes[index]);
+                 return index;
+             }
+
+             // Split along the axis on which the centroids are spread the most
+             float low[3], high[3];
+             for (int axis = 0; axis < 3; ++axis)
+             {
+                 low[axis] = std::numeric_limits<float>::max();
+                 high[axis] = std::numeric_limits<float>::lowest();
+             }
+             for (uint32_t k = 0; k < count; ++k)
+             {
+                 for (int axis = 0; axis < 3; ++axis)
+                 {
+                     low[axis] = std::min(low[axis], range[k].centroid[axis]);
+                     high[axis] = std::max(high[axis], range[k].centroid[axis]);
+                 }
+             }
+             int axis = 0;
+             for (int a = 1; a < 3; ++a)
+             {
+                 if (high[a] - low[a] > high[axis] - low[axis])
+                     axis = a;
+             }
+
+             // Split at the middle of the centroids' extent; if every centroid falls on one side, split by count
+             const float middle = (low[axis] + high[axis]) * 0.5f;
+             uint32_t half = partition(range, count, axis, middle);
+             if (half == 0 || half == count)
+             {
+                 half = count / 2;
+                 std::nth_element(range, range + half, range + count, [axis](const Item &a, const Item &b)
+                 {
+                     return a.centroid[axis] < b.centroid[axis] || (!(b.centroid[axis] < a.centroid[axis]) && a.face < b.face);
+                 });
+             }
+
+             const uint32_t left = build(first, half);
+             const uint32_t right = build(first + half, count - half);
+
+             BvhNode &node = bvh.nodes[index];
+             node.right = right;
+             for (int a = 0; a < 3; ++a)
+             {
+                 node.boundsMin[a] = std::min(bvh.nodes[left].boundsMin[a], bvh.nodes[right].boundsMin[a]);
+                 node.boundsMax[a] = std::max(bvh.nodes[left].boundsMax[a], bvh.nodes[right].boundsMax[a]);
+             }
+             return index;
+         }
+
+     private:
+         // A face and its centroid, kept together so the median search does not have to look the centroid up
+         struct Item
+         {
+             float centroid[3];
+             uint32_t face;
+         };
+
+         /**
+          * @brief Moves the items whose centroid is below `middle` on `axis` to the front and returns their number.
+          *
+          * Written out rather than taken from the standard library, so the resulting order, and with it the tree,
+          * is the same everywhere.
+          */
+         static uint32_t partition(Item *range, uint32_t count, int axis, float middle)
+         {
+             uint32_t lo = 0, hi = count;
+             while (true)
+             {
+                 while (lo < hi && range[lo].centroid[axis] < middle)
+                     ++lo;
+                 while (lo < hi && !(range[hi - 1].centroid[axis] < middle))
+                     --hi;
+                 if (lo >= hi)
+                     return lo;
+                 std::swap(range[lo++], range[--hi]);
+             }
+         }
+
+         /**
+          * @brief Sets the bounds of a leaf to the box around the vertices of its faces.
+          */
+         void setLeafBounds(BvhNode &node) const
+         {
+             const std::vector<float> *coords[3] = {&mesh.x, &mesh.y, &mesh.z};
+             for (int axis = 0; axis < 3; ++axis)
+             {
+                 node.boundsMin[axis] = std::numeric_limits<float>::max();
+                 node.boundsMax[axis] = std::numeric_limits<float>::lowest();
+             }
+             for (uint32_t k = node.first; k < node.first + node.count; ++k)
+             {
+                 const uint32_t *face = mesh.indices.data() + 3 * bvh.faces[k];
+                 for (int corner = 0; corner < 3; ++corner)
+                 {
+                     for (int axis = 0; axis < 3; ++axis)
+                     {
+                         node.boundsMin[axis] = std::min(node.boundsMin[axis], (*coords[axis])[face[corner]]);
+                         node.boundsMax[axis] = std::max(node.boundsMax[axis], (*coords[axis])[face[corner]]);
+                     }
+                 }
+             }
+         }
+
+         const Mesh &mesh;
+         uint32_t leafSize;
+         Bvh &bvh;
+         std::vector<Item> items; // The faces with their centroids, reordered into leaves as the tree is built
+     };
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the hierarchy.
+  *
+  * @return The capacity in bytes of the node and face arrays.
+  */
+ size_t Bvh::getMemoryUsage() const
+ {
+     return nodes.capacity() * sizeof(BvhNode) + faces.capacity() * sizeof(uint32_t);
+ }
+
+ /**
+  * @brief Builds a bounding volume hierarchy over the faces of a mesh.
+  *
+  * Each node is split along the axis on which its face centroids are spread the most, at the middle of their
+  * extent; a node whose centroids all fall on one side of it is split into halves at the median instead. A split
+  * costs a single pass over the node's faces.
+  *
+  * @param mesh The mesh to build the hierarchy over.
+  * @param leafSize The largest number of faces in a leaf.
+  * @return The hierarchy; it has no nodes if the mesh has no faces.
+  */
+ Bvh buildBvh(const Mesh &mesh, uint32_t leafSize)
+ {
+     Bvh bvh;
+     if (mesh.faceCount() == 0)
+     {
+         return bvh;
+     }
+
+     bvh.faces.resize(mesh.faceCount()); // Filled leaf by leaf
+     bvh.nodes.reserve(2 * (mesh.faceCount() / std::max(leafSize, 1u)) + 1);
+
+     BvhBuilder(mesh, leafSize, bvh).build(0, static_cast<uint32_t>(mesh.faceCount()));
+     return bvh;
+ }
+
+ /**
+  * @brief Marks the faces whose part of the hierarchy reaches the canvas.
+  *
+  * The tree is walked from the root. A node whose mapped box misses the canvas is skipped with its whole
+  * subtree, and a node whose box lies inside the canvas is accepted with its whole subtree; only nodes on the
+  * canvas border are opened. A face in a marked leaf may still miss the canvas on its own; the rasterizer skips
+  * it then.
+  *
+  * @param bvh The hierarchy over the mesh's faces.
+  * @param view The affine transform from the mesh's frame to canvas row, column and depth.
+  * @param height The number of canvas rows.
+  * @param width The number of canvas columns.
+  * @param mask Receives one entry per face: 1 if it may be on the canvas, 0 if not.
+  * @return The number of faces marked with 1.
+  */
+ size_t markFacesOnCanvas(const Bvh &bvh, const Mat4 &view, int height, int width, uint8_t *mask)
+ {
+     std::fill(mask, mask + bvh.faces.size(), 0);
+     if (bvh.nodes.empty())
+     {
+         return 0;
+     }
+
+     const float limit[2] = {height - 1.0f, width - 1.0f};
+     size_t marked = 0;
+     std::vector<uint32_t> stack = {0};
+
+     while (!stack.empty())
+     {
+         const BvhNode &node = bvh.nodes[stack.back()];
+         const uint32_t index = stack.back();
+         stack.pop_back();
+
+         // Canvas extent of the mapped box along rows (0) and columns (1): center plus or minus the projected half size
+         bool outside = false, inside = true;
+         for (int i = 0; i < 2; ++i)
+         {
+             float center, radius;
+             mappedExtent(node, view, i, center, radius);
+             outside = outside || center + radius < -kMargin || center - radius > limit[i] + kMargin;
+             inside = inside && center - radius >= 0.0f && center + radius <= limit[i];
+         }
+
+         if (outside)
+         {
+             continue;
+         }
+         if (inside || node.right == 0)
+         {
+             for (uint32_t k = node.first; k < node.first + node.count; ++k)
+             {
+                 mask[bvh.faces[k]] = 1;
+             }
+             marked += node.count;
+             continue;
+         }
+         stack.push_back(node.right);
+         stack.push_back(index + 1);
+     }
+
+     return marked;
+ }
+
+ /**
+  * @brief Lists the faces of a hierarchy cluster by cluster, from the nearest cluster to the farthest.
+  *
+  * Drawing near faces first makes most hidden faces fail the depth test, and lets occlusion culling skip
+  * them altogether. Clusters of neighboring faces are ordered rather than single faces: it is coarser, but
+  * sorts far fewer items and keeps the faces of a cluster together, which the rasterizer's caches depend on.
+  * Each cluster's key is the nearest depth of its mapped box, quantized to 16 bits over the range of all of them.
+  *
+  * @param bvh The hierarchy over the mesh's faces.
+  * @param view The affine transform from the mesh's frame to canvas row, column and depth.
+  * @param order Receives every face index once, nearest cluster first.
+  * @param clusterSize The largest number of faces in a cluster; leaves with more are clusters of their own.
+  */
+ void orderFacesFrontToBack(const Bvh &bvh, const Mat4 &view, std::vector<uint32_t> &order, uint32_t clusterSize)
+ {
+     // The clusters are the topmost nodes with at most clusterSize faces, in hierarchy order
+     std::vector<uint32_t> clusters;
+     std::vector<float> nearest;
+     std::vector<uint32_t> stack;
+     if (!bvh.nodes.empty())
+     {
+         stack.push_back(0);
+     }
+     while (!stack.empty())
+     {
+         uint32_t n = stack.back();
+         stack.pop_back();
+         const BvhNode &node = bvh.nodes[n];
+         if (node.right == 0 || node.count <= clusterSize)
+         {
+             float center, radius;
+             mappedExtent(node, view, 2, center, radius);
+             clusters.push_back(n);
+             nearest.push_back(center - radius);
+         }
+         else
+         {
+             stack.push_back(node.right);
+             stack.push_back(n + 1);
+         }
+     }
+
+     float low = std::numeric_limits<float>::max(), high = std::numeric_limits<float>::lowest();
+     for (float depth : nearest)
+     {
+         if (std::isfinite(depth))
+         {
+             low = std::min(low, depth);
+             high = std::max(high, depth);
+         }
+     }
+
+     // Clusters without a finite depth go last
+     const float scale = high > low ? 65535.0f / (high - low) : 0.0f;
+     std::vector<uint16_t> keys(clusters.size());
+     for (size_t k = 0; k < clusters.size(); ++k)
+     {
+         keys[k] = std::isfinite(nearest[k]) ? static_cast<uint16_t>(std::min(65535.0f, (nearest[k] - low) * scale)) : 65535;
+     }
+     radixSort(keys, clusters);
+
+     order.clear();
+     order.reserve(bvh.faces.size());
+     for (uint32_t n : clusters)
+     {
+         const BvhNode &cluster = bvh.nodes[n];
+         order.insert(order.end(), bvh.faces.begin() + cluster.first, bvh.faces.begin() + cluster.first + cluster.count);
+     }
+ }
@@ -0,0 +1,43 @@
+/**
+ * @file Camera.cpp
+ * @brief This file contains the implementation of the Camera class.
+ *
+ * The camera is built from a viewing direction. Its two image axes come from `calculateOrthonormals`,
+ * which is deterministic, so the same direction always gives the same image. The image axes and the
+ * normal are folded with the origin into one affine view matrix, which renderers apply to every vertex.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <stdexcept>
+ #include "camera.h"
+
+ /**
+  * @brief Constructs a camera looking along the positive Z-axis from the world origin.
+  */
+ Camera::Camera() : Camera(Vec3{0.0f, 0.0f, 1.0f}) {}
+
+ /**
+  * @brief Constructs a camera looking along a direction.
+  *
+  * @param normal The viewing direction; it does not need to be a unit vector.
+  * @param origin The world point that maps to canvas pixel (0, 0) at depth 0.
+  * @throws std::invalid_argument If the direction is the zero vector.
+  */
+ Camera::Camera(const Vec3 &normal, const Vec3 &origin) : origin(origin)
+ {
+     float magnitude = length(normal);
+     if (magnitude == 0.0f)
+     {
+         throw std::invalid_argument("Normal vector cannot be a zero vector.");
+     }
+     this->normal = normal / magnitude;
+
+     auto [rowAxis, columnAxis] = calculateOrthonormals(this->normal);
+     basis = {{this->normal, rowAxis, columnAxis}};
+
+     // Row, column and depth of a point p are the image axes and the normal dotted with p - origin
+     const Mat3 screenAxes = {{rowAxis, columnAxis, this->normal}};
+     view = Mat4::affine(screenAxes, -(screenAxes * origin));
+ }
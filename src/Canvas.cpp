@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include <iostream>
 #include <fstream>
@@ -5,6 +6,7 @@
 #include <cmath>
 
 #include "Canvas.h"
+#include "color.h"
 #include "linalg.h"
 /**
  * @file canvas.cpp
@@ -14,6 +16,19 @@
  * The Canvas class provides functionality to manipulate pixels, clear the canvas, write the canvas
  * content to a PPM file, and manage camera-related properties such as the camera normal and orthonormal
  * basis vectors. It also includes methods for handling depth-based pixel placement and camera orientation.
+ *
+ * Pixels are kept in two contiguous planes, one packed 8-bit RGB color and one float depth per pixel,
+ * both stored row by row. Colors are packed with the same truncation writePPM applies, so the written
+ * image does not change.
+ *
+ * Clearing can either overwrite both planes or, in ClearMode::Epoch, only advance an 8-bit frame epoch. Every
+ * pixel carries the epoch it was last drawn in; a pixel from an earlier epoch counts as cleared, is replaced
+ * on its first draw, and is written as background. The full reset is then only needed once every 255 frames,
+ * when the epoch wraps around.
+ *
+ * For occlusion culling the canvas also keeps the farthest depth of every 8x8 block of pixels. A face whose
+ * nearest depth is no nearer than that of every block it overlaps cannot change any of their pixels. The
+ * blocks carry epochs like the pixels, so an epoch clear leaves them alone too.
  * 
  * @author Ben Benyamin
  * @date March 2025
@@ -25,7 +40,11 @@
  * @param h The height of the canvas.
  * @param w The width of the canvas.
  */
-Canvas::Canvas(int h, int w) : height(h), width(w), pixels(h, std::vector<std::vector<float>>(w, std::vector<float>(3, 0.0))), depth(h, std::vector<float>(w, 0.0f)) {};
+Canvas::Canvas(int h, int w) : height(h), width(w), pixels(static_cast<size_t>(h) * w, 0), depth(static_cast<size_t>(h) * w, 0.0f),
+                               epochs(static_cast<size_t>(h) * w, 0), blockCols((w + kDepthBlockSize - 1) / kDepthBlockSize),
+                               blockDepth(static_cast<size_t>((h + kDepthBlockSize - 1) / kDepthBlockSize) * blockCols,
+                                          std::numeric_limits<float>::infinity()),
+                               blockEpochs(blockDepth.size(), 0) {};
 
 /**
  * @brief Places a pixel with the specified color and depth at the given coordinates.
@@ -37,27 +56,109 @@ Canvas::Canvas(int h, int w) : height(h), width(w), pixels(h, std::vector<std::v
  */
 void Canvas::putPixel(int x, int y, float depth, std::vector<float> &color)
 {
-    if (x >= 0 && x < height && y >= 0 && y < width && color.size() == 3)
+    if (color.size() == 3)
     {
-        if ((depth != 0 && this->depth[x][y] > depth )|| this->depth[x][y] == 0.0f)
-        {
-            this->pixels[x][y] = color;
-            this->depth[x][y] = depth;  
-        }
+        putPixel(x, y, depth, packColor(color[0], color[1], color[2]));
     }
 }
 
 /**
  * @brief Clears the canvas by resetting all pixels to black and depth values to zero.
+ *
+ * In ClearMode::Epoch only the epoch is advanced, which marks every pixel and every depth block as cleared
+ * without touching them; only once every 255 clears, when the epoch wraps around, are the tags reset.
  */
 void Canvas::clear()
 {
-    std::vector<float> defaultColor = {0.0f, 0.0f, 0.0f};
+    if (clearMode == ClearMode::Epoch)
+    {
+        if (epoch == UINT8_MAX)
+        {
+            std::fill(epochs.begin(), epochs.end(), 0); // The epoch wraps around; retire every tag at once
+            std::fill(blockEpochs.begin(), blockEpochs.end(), 0);
+            epoch = 0;
+        }
+        ++epoch;
+        return;
+    }
+
+    std::fill(pixels.begin(), pixels.end(), 0u);
+    std::fill(depth.begin(), depth.end(), 0.0f);
+    std::fill(epochs.begin(), epochs.end(), epoch);
+    std::fill(blockDepth.begin(), blockDepth.end(), std::numeric_limits<float>::infinity()); // Every block is empty again
+}
+
+/**
+ * @brief Recomputes the farthest depth of the block of pixels holding the given pixel.
+ *
+ * Drawing only ever brings a pixel nearer, so between refreshes the stored value can only be too far, which
+ * makes the rasterizer's occlusion test skip less but never skip a face that would have been visible.
+ *
+ * @param x The row of a pixel in the block.
+ * @param y The column of a pixel in the block.
+ */
+void Canvas::refreshBlockDepth(int x, int y)
+{
+    const int rowBegin = x - x % kDepthBlockSize, colBegin = y - y % kDepthBlockSize;
+    const int rowEnd = std::min(rowBegin + kDepthBlockSize, height), colEnd = std::min(colBegin + kDepthBlockSize, width);
+    const float empty = std::numeric_limits<float>::infinity(); // An empty pixel takes anything drawn on it
+
+    // One running maximum per column, so the pixels of a row are independent and a full block row vectorizes
+    float columns[kDepthBlockSize];
+    std::fill(columns, columns + kDepthBlockSize, std::numeric_limits<float>::lowest());
+    const int blockWidth = colEnd - colBegin;
+    for (int i = rowBegin; i < rowEnd; ++i)
+    {
+        const float *rowDepth = depth.data() + static_cast<size_t>(i) * width + colBegin;
+        const uint8_t *rowEpochs = epochs.data() + static_cast<size_t>(i) * width + colBegin;
+        auto merge = [&](int j)
+        {
+            float value = (rowEpochs[j] != epoch || rowDepth[j] == 0.0f) ? empty : rowDepth[j];
+            columns[j] = columns[j] < value ? value : columns[j];
+        };
+
+        if (blockWidth == kDepthBlockSize)
+        {
+            for (int j = 0; j < kDepthBlockSize; ++j)
+                merge(j);
+        }
+        else
+        {
+            for (int j = 0; j < blockWidth; ++j)
+                merge(j);
+        }
+    }
+    const float farthest = *std::max_element(columns, columns + blockWidth);
+    blockDepth[blockIndex(x, y)] = farthest;
+    blockEpochs[blockIndex(x, y)] = epoch;
+}
+
+/**
+ * @brief Selects how clear() resets the canvas.
+ *
+ * @param mode ClearMode::Fill to overwrite the planes, or ClearMode::Epoch to advance the frame epoch instead.
+ */
+void Canvas::setClearMode(ClearMode mode)
+{
+    clearMode = mode;
+}
+
+/**
+ * @brief Sets the pixels left over from earlier epochs to black, so the color plane can be encoded as is.
+ *
+ * Their epochs are left alone, so they still count as cleared for drawing.
+ */
+void Canvas::resolvePixels()
+{
+    const long long count = static_cast<long long>(pixels.size());
 
-    for (int i = 0; i < height; ++i)
+    #pragma omp parallel for
+    for (long long i = 0; i < count; ++i)
     {
-        std::fill(pixels[i].begin(), pixels[i].end(), defaultColor);
-        std::fill(depth[i].begin(), depth[i].end(), 0);
+        if (epochs[i] != epoch)
+        {
+            pixels[i] = 0u;
+        }
     }
 }
 
@@ -82,45 +183,41 @@ int Canvas::getHeight() const { return height; }
  */
 void Canvas::writePPM(const std::string &filename)
 {
-    std::ofstream ppmFile(filename);
+    writeImage(filename, ImageFormat::PPM);
+}
+
+/**
+ * @brief Writes the canvas content to an image file in the given format.
+ *
+ * The whole file is encoded in memory, in parallel bands of rows, and then written with a single call.
+ * Pixels from earlier epochs are written as background.
+ *
+ * @param filename The name of the file to write the image to.
+ * @param format The file format: ASCII or binary PPM, QOI or PNG.
+ */
+void Canvas::writeImage(const std::string &filename, ImageFormat format)
+{
+    std::ofstream imageFile(filename, std::ios::binary);
 
-    if (!ppmFile)
+    if (!imageFile)
     {
         std::cerr << "Error opening file!" << std::endl;
         return;
     }
 
-    // Write the PPM header
-    ppmFile << "P3\n";                         // P3 is the ASCII encoding for PPM
-    ppmFile << width << " " << height << "\n"; // Canvas dimensions
-    ppmFile << "255\n";                        // Max color value (255 for RGB)
+    resolvePixels();
+    std::vector<uint8_t> bytes = encodeImage(pixels.data(), width, height, format);
+    imageFile.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    imageFile.close();
 
-    // Write the pixel data
-    for (int i = 0; i < height; i++)
-    {
-        for (int j = 0; j < width; j++)
-        {
-            auto pixel = pixels[i][j];
-
-            // Convert pixel intensity (0.0 to 1.0) to (0 to 255)
-            int r = static_cast<int>(pixel[0] * 255); // Red intensity
-            int g = static_cast<int>(pixel[1] * 255); // Green intensity
-            int b = static_cast<int>(pixel[2] * 255); // Blue intensity
-
-            ppmFile << r << " " << g << " " << b << " ";
-        }
-        ppmFile << "\n";
-    }
-
-    // Close the file
-    ppmFile.close();
-    std::cout << "PPM file '" << filename << "' created successfully!" << std::endl;
+    const char *names[] = {"PPM", "PPM", "QOI", "PNG"};
+    std::cout << names[static_cast<int>(format)] << " file '" << filename << "' created successfully!" << std::endl;
 }
 
 /**
  * @brief Sets the camera normal vector and calculates the orthonormal basis.
  * 
- * @param normal The normal vector to set as the camera normal.
+ * @param normal The normal vector to set as the camera normal; it is normalized in place.
  * @throws std::invalid_argument If the normal vector is invalid (not 3D or zero vector).
  */
 void Canvas::setCameraNormal(std::vector<float> &normal)
@@ -131,35 +228,18 @@ void Canvas::setCameraNormal(std::vector<float> &normal)
         throw std::invalid_argument("Normal vector must have 3 elements.");
     }
 
-    // Calculate the magnitude (length) of the vector
-    float magnitude = 0.0f;
-    for (float val : normal)
-    {
-        magnitude += val * val;
-    }
-
-    magnitude = std::sqrt(magnitude);
-
-    // Avoid division by zero (check if the vector is not a zero vector)
-    if (magnitude == 0.0f)
-    {
-        throw std::invalid_argument("Normal vector cannot be a zero vector.");
-    }
-
-    // Normalize the normal vector by dividing each component by the magnitude
-    for (float &val : normal)
-    {
-        val /= magnitude;
-    }
-
-    this->cameraNormal = normal;
-    // Call calculateOrthonormals to get the orthonormal basis
-    std::vector<std::vector<float>> orthonormals = calculateOrthonormals(normal);
-
-    // Save the result to cameraOrthonormal1 and cameraOrthonormal2
-    this->cameraOrthonormal1 = orthonormals[0]; 
-    this->cameraOrthonormal2 = orthonormals[1];
+    setCamera(Camera(toVec3(normal))); // Throws for a zero vector
+    normal = toVector(camera.getNormal());
+}
 
+/**
+ * @brief Sets the camera the canvas is rendered from.
+ *
+ * @param camera The camera, with its view basis already computed.
+ */
+void Canvas::setCamera(const Camera &camera)
+{
+    this->camera = camera;
     this->clear(); // clear the canvas because the camera position was changed.
 }
 
@@ -168,11 +248,15 @@ void Canvas::setCameraNormal(std::vector<float> &normal)
  * 
  * @return The camera normal vector.
  */
-std::vector<float> Canvas::getCameraNormal() const {return this->cameraNormal;}
+std::vector<float> Canvas::getCameraNormal() const {return toVector(camera.getNormal());}
 
 /**
  * @brief Returns the camera axis as a set of orthonormal vectors.
  * 
  * @return A vector containing the camera normal and its orthonormal basis vectors.
  */
-std::vector<std::vector<float>> Canvas::getCameraAxis() const {return {this->cameraNormal,this->cameraOrthonormal1,this->cameraOrthonormal2};}
\ No newline at end of file
+std::vector<std::vector<float>> Canvas::getCameraAxis() const
+{
+    const Mat3 &basis = camera.getBasis();
+    return {toVector(basis[0]), toVector(basis[1]), toVector(basis[2])};
+}
\ No newline at end of file
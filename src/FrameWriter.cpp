@@ -0,0 +1,141 @@
+/**
+ * @file FrameWriter.cpp
+ * @brief This file contains the implementation of the FrameWriter class.
+ *
+ * Rendering a frame and encoding and writing it to disk take similar time. Done one after the other, each
+ * frame costs their sum; the FrameWriter overlaps them, so a sequence of frames approaches the cost of the
+ * slower of the two. Canvases are recycled through a fixed pool instead of being copied or reallocated.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <stdexcept>
+ #include "frame_writer.h"
+
+ /**
+  * @brief Constructs a FrameWriter with a pool of canvases and starts its writer threads.
+  *
+  * @param prototype The canvas each pooled canvas is copied from, giving them its size and camera.
+  * @param canvasCount The number of canvases in the pool; at least 2 lets rendering overlap writing.
+  * @param writerCount The number of writer threads.
+  * @throws std::invalid_argument If either count is zero.
+  */
+ FrameWriter::FrameWriter(const Canvas &prototype, size_t canvasCount, size_t writerCount)
+ {
+     if (canvasCount == 0 || writerCount == 0)
+     {
+         throw std::invalid_argument("FrameWriter needs at least one canvas and one writer thread.");
+     }
+
+     for (size_t k = 0; k < canvasCount; ++k)
+     {
+         canvases.push_back(std::make_unique<Canvas>(prototype));
+         canvases.back()->clear();
+         freeCanvases.push_back(canvases.back().get());
+     }
+
+     for (size_t k = 0; k < writerCount; ++k)
+     {
+         writers.emplace_back(&FrameWriter::writerLoop, this);
+     }
+ }
+
+ /**
+  * @brief Writes every submitted frame, then stops the writer threads.
+  */
+ FrameWriter::~FrameWriter()
+ {
+     finish();
+     {
+         std::lock_guard<std::mutex> lock(mutex);
+         stopping = true;
+     }
+     jobQueued.notify_all();
+
+     for (auto &writer : writers)
+     {
+         writer.join();
+     }
+ }
+
+ /**
+  * @brief Takes a cleared canvas from the pool, waiting while all of them are queued or being written.
+  *
+  * @return The canvas to render the next frame into. It stays valid until it is submitted.
+  */
+ Canvas &FrameWriter::acquire()
+ {
+     std::unique_lock<std::mutex> lock(mutex);
+     canvasFreed.wait(lock, [this] { return !freeCanvases.empty(); });
+
+     Canvas *canvas = freeCanvases.back();
+     freeCanvases.pop_back();
+     return *canvas;
+ }
+
+ /**
+  * @brief Queues a rendered canvas to be written to a file.
+  *
+  * The canvas must not be used after this call; acquire another one for the next frame.
+  *
+  * @param canvas A canvas returned by acquire().
+  * @param filename The name of the file to write.
+  * @param format The file format to write.
+  * @throws std::invalid_argument If the canvas does not belong to this writer's pool.
+  */
+ void FrameWriter::submit(Canvas &canvas, const std::string &filename, ImageFormat format)
+ {
+     auto owned = std::find_if(canvases.begin(), canvases.end(), [&canvas](const auto &c) { return c.get() == &canvas; });
+     if (owned == canvases.end())
+     {
+         throw std::invalid_argument("Canvas was not acquired from this FrameWriter.");
+     }
+
+     {
+         std::lock_guard<std::mutex> lock(mutex);
+         jobs.push_back({&canvas, filename, format});
+     }
+     jobQueued.notify_one();
+ }
+
+ /**
+  * @brief Waits until every submitted frame has been written.
+  */
+ void FrameWriter::finish()
+ {
+     std::unique_lock<std::mutex> lock(mutex);
+     canvasFreed.wait(lock, [this] { return jobs.empty() && busy == 0; });
+ }
+
+ /**
+  * @brief Body of a writer thread: writes queued frames until the writer is stopped.
+  *
+  * Each canvas is cleared on the writer thread too, so it comes back from acquire() ready to render into.
+  */
+ void FrameWriter::writerLoop()
+ {
+     std::unique_lock<std::mutex> lock(mutex);
+     while (true)
+     {
+         jobQueued.wait(lock, [this] { return stopping || !jobs.empty(); });
+         if (jobs.empty())
+         {
+             return; // Stopping, and nothing left to write
+         }
+
+         Job job = std::move(jobs.front());
+         jobs.pop_front();
+         ++busy;
+         lock.unlock();
+
+         job.canvas->writeImage(job.filename, job.format);
+         job.canvas->clear();
+
+         lock.lock();
+         --busy;
+         freeCanvases.push_back(job.canvas);
+         canvasFreed.notify_all(); // Wakes both acquire() and finish()
+     }
+ }
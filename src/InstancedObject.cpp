@@ -0,0 +1,139 @@
+/**
+ * @file InstancedObject.cpp
+ * @brief This file contains the implementation of the InstancedObject class.
+ *
+ * An InstancedObject draws many copies of one mesh, such as the fasteners of a fixture layout. The mesh, its
+ * hierarchy and its levels of detail are loaded once and shared; each copy only adds its transform and color.
+ * Every copy is projected in turn through the same pipeline as a TriangleObject, into one set of buffers, so
+ * neither load time nor memory grows with the number of copies. Copies whose hierarchy misses the canvas are
+ * skipped after a single box test.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <utility>
+ #include "color.h"
+ #include "instanced_object.h"
+
+ /**
+  * @brief Constructs an InstancedObject, without copies yet, by loading an STL file.
+  *
+  * @param stlFileName The path to the STL file containing the triangle data.
+  * @param options How to weld the vertices, whether to use the mesh cache and whether to build levels of detail.
+  */
+ InstancedObject::InstancedObject(const std::string &stlFileName, const LoadOptions &options)
+     : InstancedObject(loadGeometry(stlFileName, options))
+ {
+ }
+
+ /**
+  * @brief Constructs an InstancedObject, without copies yet, that draws geometry already loaded.
+  *
+  * @param geometry The geometry to draw, for example that of a TriangleObject.
+  */
+ InstancedObject::InstancedObject(std::shared_ptr<const MeshGeometry> geometry) : geometry(std::move(geometry))
+ {
+ }
+
+ /**
+  * @brief Adds a copy drawn in the faces' own colors.
+  *
+  * @param model The transform from the mesh's own frame.
+  * @return The index of the new copy.
+  */
+ size_t InstancedObject::addInstance(const Mat4 &model)
+ {
+     instances.push_back({model});
+     return instances.size() - 1;
+ }
+
+ /**
+  * @brief Adds a copy drawn in a single color.
+  *
+  * @param model The transform from the mesh's own frame.
+  * @param color The RGB color of all its faces, each component in [0, 1].
+  * @return The index of the new copy.
+  */
+ size_t InstancedObject::addInstance(const Mat4 &model, const std::vector<float> &color)
+ {
+     instances.push_back({model, packColor(color[0], color[1], color[2]), true});
+     return instances.size() - 1;
+ }
+
+ /**
+  * @brief Returns a copy, to change its transform or color.
+  *
+  * @param index The index of the copy.
+  * @return The copy.
+  */
+ Instance &InstancedObject::getInstance(size_t index)
+ {
+     return instances.at(index);
+ }
+
+ /**
+  * @brief Returns a copy.
+  *
+  * @param index The index of the copy.
+  * @return The copy.
+  */
+ const Instance &InstancedObject::getInstance(size_t index) const
+ {
+     return instances.at(index);
+ }
+
+ /**
+  * @brief Returns the number of copies.
+  *
+  * @return The number of copies.
+  */
+ size_t InstancedObject::instanceCount() const
+ {
+     return instances.size();
+ }
+
+ /**
+  * @brief Removes every copy, keeping the geometry.
+  */
+ void InstancedObject::clearInstances()
+ {
+     instances.clear();
+ }
+
+ /**
+  * @brief Projects every copy onto the canvas, in the order they were added; see projectGeometry.
+  *
+  * @param c The canvas onto which the triangles are projected.
+  * @param options Which faces to cull, in which order to draw them and which level of detail to draw.
+  * @return The counts summed over the copies, and the coarsest level of detail drawn.
+  */
+ RenderStats InstancedObject::project(Canvas &c, const RenderOptions &options)
+ {
+     RenderStats stats;
+     for (const Instance &instance : instances)
+     {
+         stats += projectGeometry(*geometry, instance.model, instance.hasColor ? &instance.color : nullptr, c, options, scratch);
+     }
+     return stats;
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the object.
+  *
+  * @return The capacity in bytes of the geometry, the projection buffers and the copies.
+  */
+ size_t InstancedObject::getMemoryUsage() const
+ {
+     return geometry->getMemoryUsage() + scratch.getMemoryUsage() + instances.capacity() * sizeof(Instance);
+ }
+
+ /**
+  * @brief Returns the geometry the copies share.
+  *
+  * @return The shared, immutable geometry.
+  */
+ std::shared_ptr<const MeshGeometry> InstancedObject::getGeometry() const
+ {
+     return geometry;
+ }
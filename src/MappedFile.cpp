@@ -0,0 +1,88 @@
+/**
+ * @file MappedFile.cpp
+ * @brief This file contains the implementation of the MappedFile class.
+ *
+ * The MappedFile class maps a whole file read-only into memory so that loaders can decode
+ * its contents in place, without copying the file through stream buffers first.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <fcntl.h>
+ #include <sys/mman.h>
+ #include <sys/stat.h>
+ #include <unistd.h>
+ #include "mapped_file.h"
+
+ /**
+  * @brief Maps the given file read-only into memory.
+  *
+  * If the file cannot be opened or mapped, the object is left closed and `isOpen` returns false.
+  * An empty file is reported as open with a size of zero and no mapping.
+  *
+  * @param filename The path to the file to map.
+  */
+ MappedFile::MappedFile(const std::string &filename) : mapping(nullptr), length(0), open(false)
+ {
+     int fd = ::open(filename.c_str(), O_RDONLY);
+     if (fd < 0)
+     {
+         return;
+     }
+
+     struct stat info;
+     if (fstat(fd, &info) == 0)
+     {
+         length = static_cast<size_t>(info.st_size);
+
+         if (length == 0)
+         {
+             open = true;
+         }
+         else
+         {
+             void *ptr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+             if (ptr != MAP_FAILED)
+             {
+                 madvise(ptr, length, MADV_SEQUENTIAL); // Loaders walk the file front to back
+                 mapping = ptr;
+                 open = true;
+             }
+         }
+     }
+
+     ::close(fd); // The mapping stays valid after the descriptor is closed
+ }
+
+ /**
+  * @brief Unmaps the file.
+  */
+ MappedFile::~MappedFile()
+ {
+     if (mapping != nullptr)
+     {
+         munmap(mapping, length);
+     }
+ }
+
+ /**
+  * @brief Returns whether the file was mapped successfully.
+  *
+  * @return True if the file is mapped (or empty), false otherwise.
+  */
+ bool MappedFile::isOpen() const { return open; }
+
+ /**
+  * @brief Returns a pointer to the first byte of the mapped file.
+  *
+  * @return A pointer to the file contents, or nullptr if the file is empty or not mapped.
+  */
+ const char *MappedFile::data() const { return static_cast<const char *>(mapping); }
+
+ /**
+  * @brief Returns the size of the mapped file in bytes.
+  *
+  * @return The file size in bytes.
+  */
+ size_t MappedFile::size() const { return open ? length : 0; }
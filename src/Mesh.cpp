@@ -0,0 +1,477 @@
+/**
+ * @file Mesh.cpp
+ * @brief This file contains the construction of indexed meshes from triangle soups.
+ *
+ * STL files store the three vertices of every face separately, so a vertex shared by six faces
+ * appears six times. Welding finds these duplicates (exactly, or within a tolerance) and replaces
+ * them by one shared vertex, so transforms and projections only touch each vertex once.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <cmath>
+ #include <limits>
+ #include <cstring>
+ #include <functional>
+ #include <unordered_map>
+ #include "color.h"
+ #include "linalg.h"
+ #include "mesh.h"
+
+ namespace
+ {
+     /**
+      * @brief Integer key of a 3D vertex or grid cell, usable in an unordered_map.
+      */
+     struct Key3
+     {
+         int64_t x, y, z;
+
+         bool operator==(const Key3 &other) const { return x == other.x && y == other.y && z == other.z; }
+     };
+
+     /**
+      * @brief Hash of a Key3, mixing the three components.
+      */
+     struct Key3Hash
+     {
+         size_t operator()(const Key3 &k) const
+         {
+             size_t h = std::hash<int64_t>()(k.x);
+             h ^= std::hash<int64_t>()(k.y) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+             h ^= std::hash<int64_t>()(k.z) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+             return h;
+         }
+     };
+
+     /**
+      * @brief Returns the bit pattern of a float, with -0 folded onto +0 so both weld together.
+      */
+     inline int64_t floatBits(float value)
+     {
+         if (value == 0.0f)
+             value = 0.0f;
+
+         uint32_t bits;
+         std::memcpy(&bits, &value, sizeof(bits));
+         return bits;
+     }
+
+     /**
+      * @brief Appends a unique vertex to the coordinate arrays of the mesh.
+      */
+     inline void appendVertex(Mesh &mesh, const float *p)
+     {
+         mesh.x.push_back(p[0]);
+         mesh.y.push_back(p[1]);
+         mesh.z.push_back(p[2]);
+     }
+
+     /**
+      * @brief Computes the unit normal of every face of a soup.
+      *
+      * The normal stored in the file is used when there is one; faces without one (all zeros, as many
+      * exporters write) get the normal of their vertices' counter-clockwise winding.
+      */
+     void computeFaceNormals(const TriangleSoup &soup, Mesh &mesh)
+     {
+         const long long faceCount = static_cast<long long>(soup.size());
+         const bool hasNormals = soup.normals.size() == 3 * soup.size();
+         mesh.normals.resize(3 * soup.size());
+
+         #pragma omp parallel for // Parallelize the loop using OpenMP
+         for (long long f = 0; f < faceCount; ++f)
+         {
+             Vec3 normal;
+             if (hasNormals)
+             {
+                 normal = {soup.normals[3 * f], soup.normals[3 * f + 1], soup.normals[3 * f + 2]};
+             }
+             if (normal == Vec3())
+             {
+                 const float *v = soup.vertices.data() + 9 * f;
+                 const Vec3 a = {v[0], v[1], v[2]}, b = {v[3], v[4], v[5]}, c = {v[6], v[7], v[8]};
+                 normal = cross(b - a, c - a);
+             }
+
+             float size = length(normal);
+             if (size > 0.0f && std::isfinite(size))
+             {
+                 normal /= size;
+             }
+             else
+             {
+                 normal = Vec3();
+             }
+             mesh.normals[3 * f] = normal.x;
+             mesh.normals[3 * f + 1] = normal.y;
+             mesh.normals[3 * f + 2] = normal.z;
+         }
+     }
+
+     /**
+      * @brief Welds identical vertices using their exact bit patterns as the key.
+      */
+     void weldExact(const TriangleSoup &soup, Mesh &mesh)
+     {
+         std::unordered_map<Key3, uint32_t, Key3Hash> lookup;
+         lookup.reserve(soup.size() / 2 + 2); // Closed meshes share each vertex among ~6 faces
+
+         for (size_t v = 0; v < soup.vertices.size() / 3; ++v)
+         {
+             const float *p = soup.vertices.data() + 3 * v;
+             Key3 key = {floatBits(p[0]), floatBits(p[1]), floatBits(p[2])};
+
+             auto [it, inserted] = lookup.emplace(key, static_cast<uint32_t>(mesh.vertexCount()));
+             if (inserted)
+             {
+                 appendVertex(mesh, p);
+             }
+             mesh.indices[v] = it->second;
+         }
+     }
+
+     /**
+      * @brief Welds vertices that are at most epsilon apart on every axis.
+      *
+      * Vertices are bucketed into a grid of epsilon-sized cells, so a match can only be in the same or one
+      * of the 26 neighboring cells. Each cell keeps a linked list of its unique vertices through `next`.
+      */
+     void weldWithTolerance(const TriangleSoup &soup, float epsilon, Mesh &mesh)
+     {
+         const uint32_t none = UINT32_MAX;
+         std::unordered_map<Key3, uint32_t, Key3Hash> cellHead; // First unique vertex of each cell
+         std::vector<uint32_t> next;                            // Next unique vertex in the same cell
+         cellHead.reserve(soup.size() / 2 + 2);
+
+         auto cellOf = [epsilon](float value) { return static_cast<int64_t>(std::floor(value / epsilon)); };
+
+         for (size_t v = 0; v < soup.vertices.size() / 3; ++v)
+         {
+             const float *p = soup.vertices.data() + 3 * v;
+             Key3 cell = {cellOf(p[0]), cellOf(p[1]), cellOf(p[2])};
+             uint32_t match = none;
+
+             // Search the surrounding cells for an existing vertex within epsilon
+             for (int dx = -1; dx <= 1 && match == none; ++dx)
+             {
+                 for (int dy = -1; dy <= 1 && match == none; ++dy)
+                 {
+                     for (int dz = -1; dz <= 1 && match == none; ++dz)
+                     {
+                         auto it = cellHead.find({cell.x + dx, cell.y + dy, cell.z + dz});
+                         for (uint32_t u = (it == cellHead.end()) ? none : it->second; u != none; u = next[u])
+                         {
+                             if (std::fabs(p[0] - mesh.x[u]) <= epsilon && std::fabs(p[1] - mesh.y[u]) <= epsilon &&
+                                 std::fabs(p[2] - mesh.z[u]) <= epsilon)
+                             {
+                                 match = u;
+                                 break;
+                             }
+                         }
+                     }
+                 }
+             }
+
+             if (match == none)
+             {
+                 match = static_cast<uint32_t>(mesh.vertexCount());
+                 appendVertex(mesh, p);
+
+                 auto [it, inserted] = cellHead.emplace(cell, match);
+                 next.push_back(inserted ? none : it->second);
+                 it->second = match;
+             }
+             mesh.indices[v] = match;
+         }
+     }
+
+     /**
+      * @brief Spreads the low 10 bits of a value so that two zero bits follow each of them.
+      *
+      * @param value The value, below 1024.
+      * @return The spread bits, ready to be interleaved with those of two other axes.
+      */
+     inline uint32_t spreadBits(uint32_t value)
+     {
+         value = (value | (value << 16)) & 0x030000FF;
+         value = (value | (value << 8)) & 0x0300F00F;
+         value = (value | (value << 4)) & 0x030C30C3;
+         value = (value | (value << 2)) & 0x09249249;
+         return value;
+     }
+ }
+
+ /**
+  * @brief Returns the number of unique vertices in the mesh.
+  *
+  * @return The number of vertices.
+  */
+ size_t Mesh::vertexCount() const { return isQuantized() ? quantized.x.size() : x.size(); }
+
+ /**
+  * @brief Returns whether the vertices are only held as 16-bit codes.
+  *
+  * @return True once quantizeVertices has been called and x, y and z have been cleared.
+  */
+ bool Mesh::isQuantized() const { return x.empty() && !quantized.x.empty(); }
+
+ /**
+  * @brief Returns the position of a vertex, whichever way the vertices are stored.
+  *
+  * @param index The index of the vertex.
+  * @param position Receives its x, y and z.
+  */
+ void Mesh::getVertex(size_t index, float position[3]) const
+ {
+     if (isQuantized())
+     {
+         const std::vector<uint16_t> *codes[3] = {&quantized.x, &quantized.y, &quantized.z};
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             position[axis] = quantized.origin[axis] + (*codes[axis])[index] * quantized.step[axis];
+         }
+     }
+     else
+     {
+         position[0] = x[index], position[1] = y[index], position[2] = z[index];
+     }
+ }
+
+ /**
+  * @brief Returns the number of faces in the mesh.
+  *
+  * @return The number of faces.
+  */
+ size_t Mesh::faceCount() const { return indices.size() / 3; }
+
+ /**
+  * @brief Computes the axis-aligned bounding box of the mesh vertices.
+  *
+  * An empty mesh gets an empty box, with every minimum above its maximum. The box of a mesh whose vertices are
+  * only held as codes spans its whole grid, which holds them exactly as quantizeVertices lays it out.
+  *
+  * @param boundsMin Receives the smallest x, y and z of any vertex.
+  * @param boundsMax Receives the largest x, y and z of any vertex.
+  */
+ void Mesh::getBounds(float boundsMin[3], float boundsMax[3]) const
+ {
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         boundsMin[axis] = std::numeric_limits<float>::max();
+         boundsMax[axis] = std::numeric_limits<float>::lowest();
+     }
+
+     if (isQuantized())
+     {
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             boundsMin[axis] = quantized.origin[axis];
+             boundsMax[axis] = quantized.origin[axis] + 65535.0f * quantized.step[axis];
+         }
+         return;
+     }
+
+     const std::vector<float> *coords[3] = {&x, &y, &z};
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         for (float value : *coords[axis])
+         {
+             boundsMin[axis] = std::min(boundsMin[axis], value);
+             boundsMax[axis] = std::max(boundsMax[axis], value);
+         }
+     }
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the mesh.
+  *
+  * @return The capacity in bytes of the vertex, quantized vertex, index, color and normal arrays.
+  */
+ size_t Mesh::getMemoryUsage() const
+ {
+     return (x.capacity() + y.capacity() + z.capacity() + normals.capacity()) * sizeof(float) +
+            (quantized.x.capacity() + quantized.y.capacity() + quantized.z.capacity()) * sizeof(uint16_t) +
+            (indices.capacity() + colors.capacity()) * sizeof(uint32_t);
+ }
+
+ /**
+  * @brief Builds an indexed mesh from a triangle soup by welding duplicate vertices.
+  *
+  * Faces keep their order, and their colors are packed to 8 bits per channel. Each unique vertex is stored
+  * at the position of its first occurrence in the soup, so the result does not depend on hash table ordering.
+  * Every face also gets a unit normal, from the file or from its vertices.
+  *
+  * @param soup The faces read from an STL file.
+  * @param epsilon The largest per-axis distance at which two vertices are merged; 0 merges only identical ones.
+  * @return The indexed mesh.
+  */
+ Mesh weldVertices(const TriangleSoup &soup, float epsilon)
+ {
+     Mesh mesh;
+     mesh.indices.resize(soup.vertices.size() / 3);
+     for (std::vector<float> *coords : {&mesh.x, &mesh.y, &mesh.z})
+     {
+         coords->reserve(soup.size() / 2 + 2); // A closed mesh has about half as many vertices as faces
+     }
+
+     mesh.colors.resize(soup.size());
+     for (size_t f = 0; f < soup.size(); ++f)
+     {
+         mesh.colors[f] = packColor(soup.colors[3 * f], soup.colors[3 * f + 1], soup.colors[3 * f + 2]);
+     }
+
+     computeFaceNormals(soup, mesh);
+
+     if (epsilon > 0.0f)
+     {
+         weldWithTolerance(soup, epsilon, mesh);
+     }
+     else
+     {
+         weldExact(soup, mesh);
+     }
+
+     mesh.x.shrink_to_fit();
+     mesh.y.shrink_to_fit();
+     mesh.z.shrink_to_fit();
+     return mesh;
+ }
+
+ /**
+  * @brief Reorders the faces of a mesh along a Morton (Z-order) curve through their centroids.
+  *
+  * Each centroid is placed on a 1024^3 grid over the mesh's bounding box, and the bits of its three grid
+  * coordinates are interleaved into a 30-bit code. Sorting the faces by their codes puts faces that are near
+  * each other in space near each other in the arrays, whatever order the STL exporter wrote them in. The
+  * vertices are then renumbered in the order the sorted faces first use them, so the faces of a region share
+  * a run of nearby vertices. Faces with equal codes keep their relative order.
+  *
+  * Drawing the faces in another order may change which of two faces at exactly the same depth is seen.
+  *
+  * @param mesh The mesh to reorder; its faces keep their vertices, colors and normals.
+  */
+ void sortFacesByMortonCode(Mesh &mesh)
+ {
+     const size_t faceCount = mesh.faceCount();
+     if (faceCount < 2)
+     {
+         return;
+     }
+
+     float boundsMin[3], boundsMax[3], scale[3];
+     mesh.getBounds(boundsMin, boundsMax);
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         const float extent = boundsMax[axis] - boundsMin[axis];
+         scale[axis] = extent > 0.0f ? 1023.0f / extent : 0.0f;
+     }
+
+     // Code of each face in the high half, face index in the low half, so equal codes keep their order
+     std::vector<uint64_t> keys(faceCount);
+     const long long count = static_cast<long long>(faceCount);
+
+     #pragma omp parallel for // Parallelize the loop using OpenMP
+     for (long long f = 0; f < count; ++f)
+     {
+         const uint32_t *face = mesh.indices.data() + 3 * f;
+         const std::vector<float> *coords[3] = {&mesh.x, &mesh.y, &mesh.z};
+         uint32_t code = 0;
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             const std::vector<float> &c = *coords[axis];
+             const float centroid = (c[face[0]] + c[face[1]] + c[face[2]]) / 3.0f;
+             const float cell = std::clamp((centroid - boundsMin[axis]) * scale[axis], 0.0f, 1023.0f);
+             code |= spreadBits(static_cast<uint32_t>(cell)) << axis;
+         }
+         keys[f] = (static_cast<uint64_t>(code) << 32) | static_cast<uint64_t>(f);
+     }
+     std::sort(keys.begin(), keys.end());
+
+     // Move the faces to their sorted places, numbering each vertex when a face first uses it
+     const uint32_t unused = UINT32_MAX;
+     std::vector<uint32_t> newIndex(mesh.vertexCount(), unused);
+     std::vector<uint32_t> indices(3 * faceCount), colors(faceCount);
+     std::vector<float> normals(mesh.normals.size()), x(mesh.vertexCount()), y(mesh.vertexCount()), z(mesh.vertexCount());
+     const bool hasNormals = mesh.normals.size() == 3 * faceCount;
+     uint32_t nextVertex = 0;
+
+     for (size_t k = 0; k < faceCount; ++k)
+     {
+         const size_t f = static_cast<uint32_t>(keys[k]);
+         for (int corner = 0; corner < 3; ++corner)
+         {
+             const uint32_t v = mesh.indices[3 * f + corner];
+             if (newIndex[v] == unused)
+             {
+                 x[nextVertex] = mesh.x[v];
+                 y[nextVertex] = mesh.y[v];
+                 z[nextVertex] = mesh.z[v];
+                 newIndex[v] = nextVertex++;
+             }
+             indices[3 * k + corner] = newIndex[v];
+         }
+         colors[k] = mesh.colors[f];
+         if (hasNormals)
+         {
+             std::copy(mesh.normals.begin() + 3 * f, mesh.normals.begin() + 3 * f + 3, normals.begin() + 3 * k);
+         }
+     }
+
+     // Vertices no face uses keep their relative order after the used ones
+     for (size_t v = 0; v < newIndex.size(); ++v)
+     {
+         if (newIndex[v] == unused)
+         {
+             x[nextVertex] = mesh.x[v];
+             y[nextVertex] = mesh.y[v];
+             z[nextVertex] = mesh.z[v];
+             newIndex[v] = nextVertex++;
+         }
+     }
+
+     mesh.indices = std::move(indices);
+     mesh.colors = std::move(colors);
+     mesh.normals = std::move(normals);
+     mesh.x = std::move(x);
+     mesh.y = std::move(y);
+     mesh.z = std::move(z);
+ }
+
+ /**
+  * @brief Stores the vertices of a mesh as 16-bit codes across its bounding box.
+  *
+  * Along each axis the box is split into 65535 equal steps, and each coordinate is rounded to the nearest
+  * one. The float coordinates are then replaced by the positions the codes decode to, so a hierarchy or a
+  * level of detail built from them afterwards bounds exactly what is drawn. The caller clears x, y and z once
+  * nothing else needs them; drawing then decodes the codes inside the vertex transform, at no extra cost.
+  *
+  * @param mesh The mesh to quantize; its faces are unchanged.
+  */
+ void quantizeVertices(Mesh &mesh)
+ {
+     float boundsMin[3], boundsMax[3];
+     mesh.getBounds(boundsMin, boundsMax);
+     QuantizedVertices &quantized = mesh.quantized;
+     std::vector<float> *coords[3] = {&mesh.x, &mesh.y, &mesh.z};
+     std::vector<uint16_t> *codes[3] = {&quantized.x, &quantized.y, &quantized.z};
+
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         std::vector<float> &c = *coords[axis];
+         std::vector<uint16_t> &code = *codes[axis];
+         const float extent = c.empty() ? 0.0f : boundsMax[axis] - boundsMin[axis];
+         quantized.origin[axis] = c.empty() ? 0.0f : boundsMin[axis];
+         quantized.step[axis] = extent / 65535.0f;
+         const float scale = extent > 0.0f ? 65535.0f / extent : 0.0f;
+
+         code.resize(c.size());
+         for (size_t v = 0; v < c.size(); ++v)
+         {
+             code[v] = static_cast<uint16_t>(std::clamp(std::lround((c[v] - boundsMin[axis]) * scale), 0L, 65535L));
+             c[v] = quantized.origin[axis] + code[v] * quantized.step[axis];
+         }
+     }
+ }
@@ -0,0 +1,251 @@
+/**
+ * @file MeshCache.cpp
+ * @brief This file contains the reading and writing of mesh cache files.
+ *
+ * Parsing and welding a large STL file takes seconds, while the resulting mesh is just a few flat arrays.
+ * The first load of an STL file writes those arrays to a cache file next to it; later loads map the cache
+ * and copy the arrays out directly, as long as the STL file still has the size and modification time
+ * recorded in the cache.
+ *
+ * Layout (native byte order): MeshCacheHeader, then vertexCount floats each for x, y and z, faceCount * 3
+ * uint32 indices, faceCount uint32 packed colors and faceCount * 3 float face normals.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <atomic>
+ #include <cstdint>
+ #include <cstring>
+ #include <filesystem>
+ #include <fstream>
+ #include <system_error>
+ #include <vector>
+ #include <unistd.h> // getpid
+ #include "mapped_file.h"
+ #include "mesh_cache.h"
+
+ namespace
+ {
+     constexpr char kMagic[8] = {'S', 'T', 'L', 'M', 'E', 'S', 'H', '\0'};
+     constexpr uint32_t kVersion = 4; // Bump whenever the layout below or the meaning of its arrays changes
+
+     /**
+      * @brief Fixed-size header at the start of every cache file.
+      */
+     struct MeshCacheHeader
+     {
+         char magic[8];        // kMagic
+         uint32_t version;     // kVersion
+         uint32_t headerSize;  // sizeof(MeshCacheHeader), guards against layout changes without a version bump
+         uint64_t sourceSize;  // Size of the STL file the cache was built from
+         int64_t sourceMtime;  // Modification time of that file, in file clock ticks
+         float weldEpsilon;    // Weld tolerance the mesh was built with
+         uint32_t reserved;    // Keeps the counts 8-byte aligned
+         uint64_t vertexCount; // Number of unique vertices
+         uint64_t faceCount;   // Number of faces
+         float boundsMin[3];   // Smallest x, y and z of any vertex
+         float boundsMax[3];   // Largest x, y and z of any vertex
+     };
+
+     /**
+      * @brief Looks up the size and modification time of the STL file.
+      *
+      * @return False if the file cannot be inspected.
+      */
+     bool sourceStamp(const std::string &stlFileName, uint64_t &size, int64_t &mtime)
+     {
+         std::error_code error;
+         size = std::filesystem::file_size(stlFileName, error);
+         if (error)
+             return false;
+
+         auto time = std::filesystem::last_write_time(stlFileName, error);
+         if (error)
+             return false;
+
+         mtime = static_cast<int64_t>(time.time_since_epoch().count());
+         return true;
+     }
+
+     std::atomic<uint64_t> tempFileCounter{0}; // Tells apart the temporary files written by this process
+
+     /**
+      * @brief Returns a temporary file name next to the cache that no other writer uses.
+      *
+      * The process id tells processes apart and a counter the writers within one process, so concurrent
+      * writers never share a file; each publishes its own complete file with an atomic rename.
+      */
+     std::string uniqueTempPath(const std::string &cachePath)
+     {
+         return cachePath + "." + std::to_string(getpid()) + "." + std::to_string(tempFileCounter++) + ".tmp";
+     }
+
+     constexpr uint64_t kVertexBytes = 3 * sizeof(float);                                       // x, y and z
+     constexpr uint64_t kFaceBytes = 3 * sizeof(uint32_t) + sizeof(uint32_t) + 3 * sizeof(float); // Indices, color, normal
+
+     /**
+      * @brief Checks that the header's counts describe a file of exactly the given size.
+      *
+      * Each count is bounded by the file size before anything is multiplied, so counts from a damaged file
+      * cannot wrap around to a plausible total.
+      */
+     bool countsMatchFileSize(const MeshCacheHeader &header, uint64_t fileSize)
+     {
+         if (fileSize < sizeof(MeshCacheHeader))
+             return false;
+
+         const uint64_t arrayBytes = fileSize - sizeof(MeshCacheHeader);
+         if (header.vertexCount > arrayBytes / kVertexBytes || header.faceCount > arrayBytes / kFaceBytes)
+             return false;
+
+         return header.vertexCount * kVertexBytes + header.faceCount * kFaceBytes == arrayBytes;
+     }
+ }
+
+ /**
+  * @brief Returns the path of the cache file kept next to an STL file.
+  *
+  * @param stlFileName The path to the STL file.
+  * @return The STL path with ".meshcache" appended.
+  */
+ std::string meshCachePath(const std::string &stlFileName)
+ {
+     return stlFileName + ".meshcache";
+ }
+
+ /**
+  * @brief Loads a mesh from the cache file of an STL file.
+  *
+  * The cache is memory-mapped and validated against the current format version, the weld epsilon and
+  * the size and modification time of the STL file, and its counts must match the file size exactly. If it is
+  * valid and every index names a cached vertex, each array is copied out with a single bulk copy.
+  *
+  * @param stlFileName The path to the STL file the cache belongs to.
+  * @param weldEpsilon The weld tolerance the caller would build the mesh with.
+  * @param mesh Receives the cached mesh. It is left untouched if the cache cannot be used.
+  * @return True if the mesh was loaded from the cache.
+  */
+ bool readMeshCache(const std::string &stlFileName, float weldEpsilon, Mesh &mesh)
+ {
+     uint64_t sourceSize;
+     int64_t sourceMtime;
+     if (!sourceStamp(stlFileName, sourceSize, sourceMtime))
+     {
+         return false;
+     }
+
+     MappedFile mapped(meshCachePath(stlFileName));
+     if (!mapped.isOpen() || mapped.size() < sizeof(MeshCacheHeader))
+     {
+         return false;
+     }
+
+     MeshCacheHeader header;
+     std::memcpy(&header, mapped.data(), sizeof(header));
+
+     if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+         header.headerSize != sizeof(MeshCacheHeader) || header.sourceSize != sourceSize ||
+         header.sourceMtime != sourceMtime || header.weldEpsilon != weldEpsilon ||
+         !countsMatchFileSize(header, mapped.size()))
+     {
+         return false; // Stale, foreign or truncated cache
+     }
+
+     const char *cursor = mapped.data() + sizeof(MeshCacheHeader);
+     auto copyArray = [](auto &dst, const char *src, size_t count)
+     {
+         dst.resize(count);
+         std::memcpy(dst.data(), src, count * sizeof(dst[0]));
+     };
+
+     // The indices are checked before anything is copied into the mesh, so a damaged cache leaves it untouched
+     std::vector<uint32_t> indices;
+     copyArray(indices, cursor + 3 * header.vertexCount * sizeof(float), header.faceCount * 3);
+     if (std::any_of(indices.begin(), indices.end(), [&header](uint32_t index) { return index >= header.vertexCount; }))
+     {
+         return false; // Damaged cache; the mesh is rebuilt from the STL file
+     }
+
+     for (std::vector<float> *axis : {&mesh.x, &mesh.y, &mesh.z})
+     {
+         copyArray(*axis, cursor, header.vertexCount);
+         cursor += header.vertexCount * sizeof(float);
+     }
+     mesh.indices = std::move(indices);
+     cursor += header.faceCount * 3 * sizeof(uint32_t);
+     copyArray(mesh.colors, cursor, header.faceCount);
+     cursor += header.faceCount * sizeof(uint32_t);
+     copyArray(mesh.normals, cursor, header.faceCount * 3);
+     return true;
+ }
+
+ /**
+  * @brief Writes the cache file of a mesh loaded from an STL file.
+  *
+  * The file is written under a temporary name of its own and then renamed, so a concurrent reader never sees
+  * a partially written cache, and writers loading the same STL file at once, from several threads or
+  * processes, never write into each other's file. The last rename wins.
+  *
+  * @param stlFileName The path to the STL file the mesh was loaded from.
+  * @param weldEpsilon The weld tolerance the mesh was built with.
+  * @param mesh The mesh to cache.
+  * @return True if the cache file was written.
+  */
+ bool writeMeshCache(const std::string &stlFileName, float weldEpsilon, const Mesh &mesh)
+ {
+     MeshCacheHeader header = {};
+     std::memcpy(header.magic, kMagic, sizeof(kMagic));
+     header.version = kVersion;
+     header.headerSize = sizeof(MeshCacheHeader);
+     header.weldEpsilon = weldEpsilon;
+     header.vertexCount = mesh.vertexCount();
+     header.faceCount = mesh.faceCount();
+     mesh.getBounds(header.boundsMin, header.boundsMax);
+
+     if (!sourceStamp(stlFileName, header.sourceSize, header.sourceMtime))
+     {
+         return false;
+     }
+
+     const std::string cachePath = meshCachePath(stlFileName);
+     const std::string tempPath = uniqueTempPath(cachePath);
+     {
+         std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+         if (!file)
+         {
+             return false; // For example a read-only directory; loading still works without the cache
+         }
+
+         file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+         auto writeArray = [&file](const auto &src)
+         {
+             file.write(reinterpret_cast<const char *>(src.data()), src.size() * sizeof(src[0]));
+         };
+
+         writeArray(mesh.x);
+         writeArray(mesh.y);
+         writeArray(mesh.z);
+         writeArray(mesh.indices);
+         writeArray(mesh.colors);
+         writeArray(mesh.normals);
+
+         if (!file)
+         {
+             file.close();
+             std::error_code error;
+             std::filesystem::remove(tempPath, error); // Best effort; a leftover temporary file is never read
+             return false;
+         }
+     }
+
+     std::error_code error;
+     std::filesystem::rename(tempPath, cachePath, error);
+     if (error)
+     {
+         std::filesystem::remove(tempPath, error);
+         return false;
+     }
+     return true;
+ }
@@ -0,0 +1,390 @@
+/**
+ * @file Scene.cpp
+ * @brief This file contains the implementation of the Scene class.
+ *
+ * A scene holds the meshes of an assembly, each drawn through its own model transform. Its STL files are
+ * loaded by a pool of threads, each taking the next file until none is left, so the parts load side by side
+ * and the largest one bounds the load time. Each object keeps the bounds of its mesh, which are mapped by its
+ * transform to give its bounds in the scene.
+ *
+ * A frame runs the per-object part of the pipeline (level of detail, culling and the vertex kernel) for each
+ * object in turn, writing into one set of buffers, and hands all the faces to the rasterizer in one batch. The
+ * faces are binned into screen tiles once and every tile is drawn once, rather than once per object.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <atomic>
+ #include <cmath>
+ #include <exception>
+ #include <limits>
+ #include <numeric>
+ #include <omp.h> // OpenMP for parallel processing
+ #include <stdexcept>
+ #include <thread>
+ #include <unordered_map>
+ #include <utility>
+ #include "Canvas.h"
+ #include "raster.h"
+ #include "scene.h"
+
+ namespace
+ {
+     /**
+      * @brief Maps a box through an affine transform and returns the box around the result.
+      *
+      * @param transform The affine transform.
+      * @param boundsMin Smallest x, y and z of the box; replaced by those of the mapped box.
+      * @param boundsMax Largest x, y and z of the box; replaced by those of the mapped box.
+      */
+     void mapBox(const Mat4 &transform, float boundsMin[3], float boundsMax[3])
+     {
+         float center[3], extent[3];
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             center[axis] = (boundsMin[axis] + boundsMax[axis]) * 0.5f;
+             extent[axis] = (boundsMax[axis] - boundsMin[axis]) * 0.5f;
+         }
+         for (int i = 0; i < 3; ++i)
+         {
+             float mappedCenter = transform[i][3], mappedExtent = 0.0f;
+             for (int j = 0; j < 3; ++j)
+             {
+                 mappedCenter += transform[i][j] * center[j];
+                 mappedExtent += std::abs(transform[i][j]) * extent[j];
+             }
+             boundsMin[i] = mappedCenter - mappedExtent;
+             boundsMax[i] = mappedCenter + mappedExtent;
+         }
+     }
+ }
+
+ /**
+  * @brief Adds an object that draws geometry already loaded, sharing it rather than copying it.
+  *
+  * @param geometry The geometry to draw.
+  * @param model The transform from the mesh's own frame.
+  * @return The index of the new object.
+  */
+ size_t Scene::add(std::shared_ptr<const MeshGeometry> geometry, const Mat4 &model)
+ {
+     SceneObject object = {std::move(geometry), model};
+     object.geometry->mesh.getBounds(object.boundsMin, object.boundsMax);
+     objects.push_back(std::move(object));
+     batchLevels.clear();
+     return objects.size() - 1;
+ }
+
+ /**
+  * @brief Loads STL files concurrently and adds an object for each, with no transform.
+  *
+  * Each thread loads the next file not yet taken until none is left, with its share of the OpenMP threads
+  * for the parallel loops inside the load. The objects are added in the order of the file names, whichever
+  * file finishes first. A file named more than once, like a part used several times in an assembly, is loaded
+  * once and its objects share the geometry. A file that cannot be read gives an empty object, as for a
+  * TriangleObject.
+  *
+  * @param stlFileNames The paths to the STL files.
+  * @param options How to weld the vertices, whether to use the mesh cache and whether to build levels of detail.
+  * @param threadCount The number of loading threads; 0 uses one per hardware thread. Never more than the files.
+  * @return The index of the object of the first file.
+  * @throws Whatever a load threw, once every thread has finished; no object is added then.
+  */
+ size_t Scene::load(const std::vector<std::string> &stlFileNames, const LoadOptions &options, size_t threadCount)
+ {
+     if (threadCount == 0)
+     {
+         threadCount = std::max(1u, std::thread::hardware_concurrency());
+     }
+
+     // Each distinct file is loaded once
+     std::vector<std::string> files;
+     std::vector<size_t> fileOf(stlFileNames.size());
+     std::unordered_map<std::string, size_t> seen;
+     for (size_t k = 0; k < stlFileNames.size(); ++k)
+     {
+         auto [it, inserted] = seen.emplace(stlFileNames[k], files.size());
+         if (inserted)
+         {
+             files.push_back(stlFileNames[k]);
+         }
+         fileOf[k] = it->second;
+     }
+     threadCount = std::min(threadCount, files.size());
+
+     std::vector<std::shared_ptr<const MeshGeometry>> loaded(files.size());
+     std::vector<std::exception_ptr> errors(threadCount);
+     std::atomic<size_t> next = 0;
+     const int innerThreads = std::max(1, omp_get_max_threads() / static_cast<int>(std::max<size_t>(threadCount, 1)));
+
+     auto loader = [&](size_t thread)
+     {
+         omp_set_num_threads(innerThreads); // Applies to this thread only
+         try
+         {
+             for (size_t k = next++; k < files.size(); k = next++)
+             {
+                 loaded[k] = loadGeometry(files[k], options);
+             }
+         }
+         catch (...)
+         {
+             errors[thread] = std::current_exception();
+             next = files.size(); // Let the other threads stop early
+         }
+     };
+
+     std::vector<std::thread> threads;
+     for (size_t thread = 0; thread < threadCount; ++thread)
+     {
+         threads.emplace_back(loader, thread);
+     }
+     for (std::thread &thread : threads)
+     {
+         thread.join();
+     }
+     for (const std::exception_ptr &error : errors)
+     {
+         if (error)
+         {
+             std::rethrow_exception(error);
+         }
+     }
+
+     const size_t first = objects.size();
+     for (size_t file : fileOf)
+     {
+         add(loaded[file]);
+     }
+     return first;
+ }
+
+ /**
+  * @brief Returns the number of objects in the scene.
+  *
+  * @return The number of objects.
+  */
+ size_t Scene::objectCount() const
+ {
+     return objects.size();
+ }
+
+ /**
+  * @brief Returns the transform of an object.
+  *
+  * @param index The index of the object.
+  * @return The transform from the object's own frame to the scene.
+  * @throws std::out_of_range If there is no such object.
+  */
+ const Mat4 &Scene::getTransform(size_t index) const
+ {
+     return objects.at(index).model;
+ }
+
+ /**
+  * @brief Replaces the transform of an object.
+  *
+  * @param index The index of the object.
+  * @param model The new transform from the object's own frame to the scene.
+  * @throws std::out_of_range If there is no such object.
+  */
+ void Scene::setTransform(size_t index, const Mat4 &model)
+ {
+     objects.at(index).model = model;
+ }
+
+ /**
+  * @brief Returns the geometry an object draws, to share it with other objects.
+  *
+  * @param index The index of the object.
+  * @return The shared, immutable geometry.
+  * @throws std::out_of_range If there is no such object.
+  */
+ std::shared_ptr<const MeshGeometry> Scene::getGeometry(size_t index) const
+ {
+     return objects.at(index).geometry;
+ }
+
+ /**
+  * @brief Returns the axis-aligned box around an object, in the scene's frame.
+  *
+  * The box of the mesh is mapped by the object's transform, so it may be looser than the box of the mapped
+  * vertices when the transform rotates.
+  *
+  * @param index The index of the object.
+  * @param boundsMin Receives the smallest x, y and z; larger than boundsMax for an empty mesh.
+  * @param boundsMax Receives the largest x, y and z.
+  * @throws std::out_of_range If there is no such object.
+  */
+ void Scene::getBounds(size_t index, float boundsMin[3], float boundsMax[3]) const
+ {
+     const SceneObject &object = objects.at(index);
+     std::copy(object.boundsMin, object.boundsMin + 3, boundsMin);
+     std::copy(object.boundsMax, object.boundsMax + 3, boundsMax);
+     if (object.geometry->mesh.vertexCount() > 0)
+     {
+         mapBox(object.model, boundsMin, boundsMax);
+     }
+ }
+
+ /**
+  * @brief Returns the axis-aligned box around every object, in the scene's frame.
+  *
+  * @param boundsMin Receives the smallest x, y and z; larger than boundsMax when no object has a vertex.
+  * @param boundsMax Receives the largest x, y and z.
+  */
+ void Scene::getBounds(float boundsMin[3], float boundsMax[3]) const
+ {
+     std::fill(boundsMin, boundsMin + 3, std::numeric_limits<float>::max());
+     std::fill(boundsMax, boundsMax + 3, std::numeric_limits<float>::lowest());
+     for (size_t index = 0; index < objects.size(); ++index)
+     {
+         float objectMin[3], objectMax[3];
+         getBounds(index, objectMin, objectMax);
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             boundsMin[axis] = std::min(boundsMin[axis], objectMin[axis]);
+             boundsMax[axis] = std::max(boundsMax[axis], objectMax[axis]);
+         }
+     }
+ }
+
+ /**
+  * @brief Projects every object onto the canvas in a single rasterization pass.
+  *
+  * Each object picks its level of detail, has its faces culled and its vertices mapped by cullAndMapFaces
+  * into its own range of one shared vertex buffer. The faces of all the objects, with their vertex indices
+  * moved to those ranges, then form one batch for rasterizeBatch: faces are binned into screen tiles once,
+  * and each tile is drawn once with every object's faces in it. The image is the same as projecting the
+  * objects one after another in order, and so are the counts, bar the tile counts of faces that span objects.
+  *
+  * With deferred shading, each pixel is colored once per frame, whichever object won it; the single pass makes
+  * that hold across objects, not just within one.
+  *
+  * When sorting front to back, each object's faces are ordered as for a single object, and the objects are
+  * drawn from the one whose box has the nearest corner.
+  *
+  * @param c The canvas onto which the triangles are projected.
+  * @param options Which faces to cull, in which order to draw them and which level of detail to draw.
+  * @return The counts summed over the objects, and the coarsest level of detail drawn.
+  */
+ RenderStats Scene::project(Canvas &c, const RenderOptions &options)
+ {
+     const Mat4 cameraView = c.getCamera().getView();
+     std::vector<Mat4> views(objects.size());
+     std::vector<size_t> levels(objects.size());
+     for (size_t k = 0; k < objects.size(); ++k)
+     {
+         views[k] = cameraView * objects[k].model;
+         levels[k] = objects[k].geometry->selectLevel(views[k], options.lodPixelError);
+     }
+
+     // Gather the faces of the levels picked, unless the same levels were gathered last time
+     if (levels != batchLevels)
+     {
+         vertexStart.assign(1, 0);
+         faceStart.assign(1, 0);
+         for (size_t k = 0; k < objects.size(); ++k)
+         {
+             const Mesh &source = objects[k].geometry->levelMesh(levels[k]);
+             vertexStart.push_back(vertexStart.back() + source.vertexCount());
+             faceStart.push_back(faceStart.back() + source.faceCount());
+         }
+         if (vertexStart.back() > std::numeric_limits<uint32_t>::max())
+         {
+             throw std::length_error("A scene can hold at most 2^32 - 1 vertices.");
+         }
+
+         indices.resize(3 * faceStart.back());
+         colors.resize(faceStart.back());
+         for (size_t k = 0; k < objects.size(); ++k)
+         {
+             const Mesh &source = objects[k].geometry->levelMesh(levels[k]);
+             const uint32_t offset = static_cast<uint32_t>(vertexStart[k]);
+             std::transform(source.indices.begin(), source.indices.end(), indices.begin() + 3 * faceStart[k],
+                            [offset](uint32_t index) { return index + offset; });
+             std::copy(source.colors.begin(), source.colors.end(), colors.begin() + faceStart[k]);
+         }
+         batchLevels = levels;
+     }
+
+     projected.resize(3 * vertexStart.back());
+     faceMask.resize(faceStart.back());
+     RenderStats stats;
+     for (size_t k = 0; k < objects.size(); ++k)
+     {
+         const MeshGeometry &geometry = *objects[k].geometry;
+         RenderStats objectStats = cullAndMapFaces(geometry.levelMesh(levels[k]), geometry.levelBvh(levels[k]),
+                                                   objects[k].model, c, options, faceMask.data() + faceStart[k],
+                                                   projected.data() + 3 * vertexStart[k], blockUsed);
+         objectStats.lodLevel = levels[k];
+         stats += objectStats;
+     }
+     if (stats.facesDrawn == 0)
+     {
+         return stats;
+     }
+
+     ScreenBatch batch = {projected.data(), indices.data(), colors.data(), faceStart.back()};
+     batch.faceMask = faceMask.data();
+     batch.cullOccluded = options.cullOccluded;
+     batch.deferShading = options.deferShading;
+     if (options.sortFrontToBack)
+     {
+         // Nearest depth of each object's box: the depth of its center less the reach of its half extents
+         std::vector<float> nearest(objects.size());
+         for (size_t k = 0; k < objects.size(); ++k)
+         {
+             const SceneObject &object = objects[k];
+             float depth = views[k][2][3];
+             for (int axis = 0; axis < 3; ++axis)
+             {
+                 depth += views[k][2][axis] * (object.boundsMin[axis] + object.boundsMax[axis]) * 0.5f -
+                          std::abs(views[k][2][axis]) * (object.boundsMax[axis] - object.boundsMin[axis]) * 0.5f;
+             }
+             nearest[k] = depth;
+         }
+         std::vector<size_t> byDepth(objects.size());
+         std::iota(byDepth.begin(), byDepth.end(), 0);
+         std::stable_sort(byDepth.begin(), byDepth.end(), [&](size_t a, size_t b) { return nearest[a] < nearest[b]; });
+
+         drawOrder.resize(faceStart.back());
+         auto out = drawOrder.begin();
+         for (size_t k : byDepth)
+         {
+             const uint32_t offset = static_cast<uint32_t>(faceStart[k]);
+             orderFacesFrontToBack(objects[k].geometry->levelBvh(levels[k]), views[k], objectOrder);
+             out = std::transform(objectOrder.begin(), objectOrder.end(), out, [offset](uint32_t f) { return f + offset; });
+         }
+         batch.order = drawOrder.data();
+     }
+
+     RasterStats raster = rasterizeBatch(c, batch); // Draw the triangles of every object in screen tiles on all cores
+     stats.faceTiles = raster.faceTiles;
+     stats.faceTilesOccluded = raster.faceTilesOccluded;
+     stats.pixelsWritten = raster.pixelsWritten;
+     stats.pixelsShaded = raster.pixelsShaded;
+     return stats;
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the scene.
+  *
+  * A geometry shared by several objects is counted once per object.
+  *
+  * @return The capacity in bytes of the geometries, the gathered faces and the projection buffers.
+  */
+ size_t Scene::getMemoryUsage() const
+ {
+     size_t bytes = objects.capacity() * sizeof(SceneObject);
+     for (const SceneObject &object : objects)
+     {
+         bytes += object.geometry->getMemoryUsage();
+     }
+     bytes += (batchLevels.capacity() + vertexStart.capacity() + faceStart.capacity()) * sizeof(size_t);
+     bytes += (indices.capacity() + colors.capacity() + drawOrder.capacity() + objectOrder.capacity()) * sizeof(uint32_t);
+     bytes += projected.capacity() * sizeof(float) + faceMask.capacity() + blockUsed.capacity();
+     return bytes;
+ }
@@ -1,139 +1,590 @@
 /**
  * @file triangle_object.cpp
  * @brief This file contains the implementation of the TriangleObject class.
- * 
- * The TriangleObject class represents a collection of TriangleSurface objects, typically loaded from an STL file.
- * It provides methods for projecting all triangles onto a canvas, applying transformations (rotation, scaling, translation)
- * to all triangles, and querying the number of triangles in the object.
- * 
+ *
+ * The TriangleObject class represents a triangle mesh, typically loaded from an STL file. The mesh is stored
+ * indexed: every distinct vertex is kept once and shared by the faces that use it, so transforms and projections
+ * touch each vertex once. The coordinates live in separate contiguous x, y and z arrays (structure of arrays),
+ * which the projection loop streams over linearly. Transforms are not applied to the vertices: they are
+ * composed into a model matrix, which is folded into the projection. The mesh and its hierarchies are loaded
+ * into an immutable MeshGeometry, which objects and instanced copies drawn from the same file share. The class
+ * provides methods for projecting all triangles onto a canvas, applying transformations (rotation, scaling,
+ * translation) to the mesh, and querying the number of triangles in the object.
+ *
  * @author Ben Benyamin
  * @date March 2025
  */
 
+ #include <algorithm>
+ #include <cmath>
  #include <omp.h> // OpenMP for parallel processing
  #include "TriangleObject.h"
  #include "TriangleSurface.h"
  #include "Canvas.h"
+ #include "color.h"
+ #include "linalg.h"
+ #include "mesh_cache.h"
+ #include "raster.h"
  #include "stl.h"
- 
+ #include "vertex_kernel.h"
+
+ /**
+  * @brief Loads the geometry of an STL file.
+  *
+  * If the STL file has an up-to-date mesh cache next to it, the mesh is loaded from the cache. Otherwise the
+  * faces are read from the file and welded into an indexed mesh, and the cache is written for the next load.
+  * If asked for, the faces are then sorted along a Morton curve, so that faces near each other on the canvas are
+  * near each other in memory, and so are their vertices. A bounding volume hierarchy is then built over the
+  * faces. If asked for, a chain of coarser levels of detail is simplified from the mesh, each with its own
+  * hierarchy.
+  *
+  * With compact vertices, the vertices of the mesh and of every level are snapped to 16-bit codes across
+  * their bounding box before anything is built from them, and only the codes are kept once the hierarchies
+  * and levels are built; see quantizeVertices.
+  *
+  * @param stlFileName The path to the STL file containing the triangle data.
+  * @param options How to weld the vertices, whether to use the mesh cache, whether to reorder the faces, whether
+  * to build levels of detail and whether to keep the vertices compact.
+  * @return The geometry, ready to be shared by any number of objects and instances.
+  */
+ std::shared_ptr<const MeshGeometry> loadGeometry(const std::string &stlFileName, const LoadOptions &options)
+ {
+     auto geometry = std::make_shared<MeshGeometry>();
+     Mesh &mesh = geometry->mesh;
+     if (!options.useCache || !readMeshCache(stlFileName, options.weldEpsilon, mesh))
+     {
+         TriangleSoup soup;
+         readSTL(stlFileName, soup); // Load triangle data from the STL file
+         mesh = weldVertices(soup, options.weldEpsilon);
+
+         if (options.useCache && mesh.faceCount() > 0)
+         {
+             writeMeshCache(stlFileName, options.weldEpsilon, mesh); // A failed write only costs the next load time
+         }
+     }
+
+     if (options.reorderFaces)
+     {
+         sortFacesByMortonCode(mesh); // Not cached: the cache holds the faces in file order for every caller
+     }
+     if (options.compactVertices)
+     {
+         quantizeVertices(mesh); // Before the hierarchy, so its boxes hold the vertices as drawn
+     }
+
+     geometry->bvh = buildBvh(mesh);
+
+     if (options.buildLods)
+     {
+         geometry->lods = buildLodChain(mesh);
+         for (MeshLod &lod : geometry->lods)
+         {
+             if (options.compactVertices)
+             {
+                 quantizeVertices(lod.mesh);
+             }
+             geometry->lodBvhs.push_back(buildBvh(lod.mesh));
+         }
+     }
+
+     if (options.compactVertices)
+     {
+         // Everything that needs the float vertices is built; from now on only the codes are kept
+         auto dropFloats = [](Mesh &compact)
+         {
+             std::vector<float>().swap(compact.x);
+             std::vector<float>().swap(compact.y);
+             std::vector<float>().swap(compact.z);
+         };
+         dropFloats(mesh);
+         for (MeshLod &lod : geometry->lods)
+         {
+             dropFloats(lod.mesh);
+         }
+     }
+     return geometry;
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the geometry.
+  *
+  * @return The capacity in bytes of the mesh, its hierarchy and every level of detail with its hierarchy.
+  */
+ size_t MeshGeometry::getMemoryUsage() const
+ {
+     size_t bytes = mesh.getMemoryUsage() + bvh.getMemoryUsage();
+     for (size_t level = 0; level < lods.size(); ++level)
+     {
+         bytes += lods[level].mesh.getMemoryUsage() + lodBvhs[level].getMemoryUsage();
+     }
+     return bytes;
+ }
+
+ /**
+  * @brief Adds the counts of another projection to these, as when both drew into the same frame.
+  *
+  * @param other The stats to add.
+  * @return These stats, with the coarser of the two levels of detail.
+  */
+ RenderStats &RenderStats::operator+=(const RenderStats &other)
+ {
+     facesDrawn += other.facesDrawn;
+     facesCulled += other.facesCulled;
+     facesOffCanvas += other.facesOffCanvas;
+     faceTiles += other.faceTiles;
+     faceTilesOccluded += other.faceTilesOccluded;
+     pixelsWritten += other.pixelsWritten;
+     pixelsShaded += other.pixelsShaded;
+     lodLevel = std::max(lodLevel, other.lodLevel);
+     return *this;
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the buffers.
+  *
+  * @return The capacity in bytes of the projection and culling buffers.
+  */
+ size_t RenderScratch::getMemoryUsage() const
+ {
+     return projected.capacity() * sizeof(float) + faceMask.capacity() + blockUsed.capacity() +
+            drawOrder.capacity() * sizeof(uint32_t);
+ }
+
  /**
   * @brief Constructs a TriangleObject by loading triangle data from an STL file.
-  * 
+  *
   * @param stlFileName The path to the STL file containing the triangle data.
+  * @param options How to weld the vertices, whether to use the mesh cache and whether to build levels of detail.
+  */
+ TriangleObject::TriangleObject(const std::string &stlFileName, const LoadOptions &options)
+     : TriangleObject(loadGeometry(stlFileName, options))
+ {
+ }
+
+ /**
+  * @brief Constructs a TriangleObject that draws geometry already loaded, sharing it rather than copying it.
+  *
+  * @param geometry The geometry to draw, for example that of another object.
+  */
+ TriangleObject::TriangleObject(std::shared_ptr<const MeshGeometry> geometry) : geometry(std::move(geometry))
+ {
+ }
+
+ /**
+  * @brief Picks the coarsest level of detail whose error stays within a number of pixels on the canvas.
+  *
+  * A level's error is a distance in the mesh's own frame. The view stretches a distance across the canvas by
+  * at most the largest singular value of its row and column rows, which is the square root of the largest
+  * eigenvalue of their 2x2 Gram matrix; depth does not move pixels.
+  *
+  * @param view The affine transform from the mesh's frame to canvas row, column and depth.
+  * @param maxPixelError The largest error to accept, in pixels; 0 or less always picks the full mesh.
+  * @return 0 for the full mesh, or l for lods[l - 1].
+  */
+ size_t MeshGeometry::selectLevel(const Mat4 &view, float maxPixelError) const
+ {
+     if (!(maxPixelError > 0.0f) || lods.empty())
+     {
+         return 0;
+     }
+
+     const Vec3 row = {view[0][0], view[0][1], view[0][2]}, col = {view[1][0], view[1][1], view[1][2]};
+     const float a = dot(row, row), b = dot(row, col), d = dot(col, col);
+     const float stretch = std::sqrt((a + d) * 0.5f + std::sqrt((a - d) * (a - d) * 0.25f + b * b));
+
+     // The errors grow from level to level, so the first level that fits from the coarse end is the coarsest
+     for (size_t level = lods.size(); level > 0; --level)
+     {
+         if (lods[level - 1].error * stretch <= maxPixelError)
+         {
+             return level;
+         }
+     }
+     return 0;
+ }
+
+ /**
+  * @brief Returns the mesh of a level of detail.
+  *
+  * @param level 0 for the full mesh, or l for lods[l - 1], as picked by selectLevel.
+  * @return The mesh of that level.
+  */
+ const Mesh &MeshGeometry::levelMesh(size_t level) const
+ {
+     return level == 0 ? mesh : lods[level - 1].mesh;
+ }
+
+ /**
+  * @brief Returns the bounding volume hierarchy of a level of detail.
+  *
+  * @param level 0 for the full mesh, or l for lods[l - 1], as picked by selectLevel.
+  * @return The hierarchy over the faces of that level.
+  */
+ const Bvh &MeshGeometry::levelBvh(size_t level) const
+ {
+     return level == 0 ? bvh : lodBvhs[level - 1];
+ }
+
+ /**
+  * @brief Culls the faces of a mesh and maps the vertices of the faces left to screen space.
+  *
+  * The model transform and the camera axes are combined into a single affine matrix, which maps each
+  * vertex of the source mesh straight to its screen-space position. Every unique vertex is mapped once by
+  * the vectorized vertex kernel, in parallel.
+  *
+  * With off-canvas culling, the boxes of the bounding volume hierarchy are mapped by the same matrix first,
+  * and the faces under a box that misses the canvas are left out. Blocks of vertices that none of the
+  * remaining faces use are not mapped at all, so the part of a zoomed-in mesh outside the canvas costs
+  * little more than the walk down the hierarchy. The faces left out could not have drawn a pixel, so the
+  * image does not change. A mesh whose hierarchy misses the canvas altogether costs one box test.
+  *
+  * With back-face culling, faces whose normal points away from the camera are left out. Rather than
+  * transforming every face normal by the model matrix, the viewing direction is mapped back into the mesh's
+  * own frame once, through the transpose of the model's cofactor matrix, and compared with the stored
+  * normals; the sign of the result is the same. Only closed meshes should be culled: the inside of an open
+  * mesh is visible and faces away from the camera.
+  *
+  * @param source The mesh, usually one level of detail of a geometry.
+  * @param hierarchy The bounding volume hierarchy over the faces of the mesh.
+  * @param model The transform from the mesh's own frame.
+  * @param c The canvas the faces are bound for.
+  * @param options Which faces to cull.
+  * @param faceMask Receives 1 for each face to draw and 0 for each face culled; one entry per face.
+  * @param projected Receives the row, column and depth of each vertex; those only culled faces use may be left unset.
+  * @param blockUsed Scratch buffer, reused between calls.
+  * @return The number of faces left to draw and of faces culled.
+  */
+ RenderStats cullAndMapFaces(const Mesh &source, const Bvh &hierarchy, const Mat4 &model, const Canvas &c,
+                             const RenderOptions &options, uint8_t *faceMask, float *projected, std::vector<uint8_t> &blockUsed)
+ {
+     const Mat4 view = c.getCamera().getView() * model; // Camera view times the model transform
+     RenderStats stats;
+     const long long faceCount = static_cast<long long>(source.faceCount());
+
+     if (options.cullOffCanvas)
+     {
+         stats.facesOffCanvas = source.faceCount() - markFacesOnCanvas(hierarchy, view, c.getHeight(), c.getWidth(), faceMask);
+         if (stats.facesOffCanvas == source.faceCount())
+         {
+             return stats; // Nothing reaches the canvas
+         }
+     }
+     else
+     {
+         std::fill(faceMask, faceMask + faceCount, 1);
+     }
+
+     if (options.cullBackFaces && source.normals.size() == 3 * source.faceCount())
+     {
+         // A face points away from the camera when its transformed normal has a positive component along the
+         // viewing direction, which is the same as its stored normal having one along `away`
+         const Vec3 away = transpose(cofactor(model.linear())) * c.getCamera().getNormal();
+         long long culled = 0;
+
+         #pragma omp parallel for reduction(+ : culled) // Parallelize the loop using OpenMP
+         for (long long f = 0; f < faceCount; ++f)
+         {
+             const float *normal = source.normals.data() + 3 * f;
+             const bool backFacing = normal[0] * away.x + normal[1] * away.y + normal[2] * away.z > 0.0f;
+             culled += faceMask[f] && backFacing;
+             faceMask[f] = faceMask[f] && !backFacing;
+         }
+
+         stats.facesCulled = static_cast<size_t>(culled);
+     }
+
+     // Map the vertices in blocks, so the vectorized kernel runs on several threads at once. The projected
+     // vertices stay interleaved, so the rasterizer fetches each one from a single cache line.
+     const size_t blockSize = 4096;
+     const long long blockCount = static_cast<long long>((source.vertexCount() + blockSize - 1) / blockSize);
+
+     // Only the blocks with a vertex of a face that is still drawn are needed
+     const bool skipBlocks = stats.facesOffCanvas > 0;
+     if (skipBlocks)
+     {
+         blockUsed.assign(blockCount, 0);
+         for (long long f = 0; f < faceCount; ++f)
+         {
+             if (faceMask[f])
+             {
+                 const uint32_t *face = source.indices.data() + 3 * f;
+                 blockUsed[face[0] / blockSize] = blockUsed[face[1] / blockSize] = blockUsed[face[2] / blockSize] = 1;
+             }
+         }
+     }
+
+     // Quantized vertices are decoded by the same matrix: codes to the mesh's frame, then on to the canvas
+     const QuantizedVertices &codes = source.quantized;
+     const bool quantized = source.isQuantized();
+     const Mat4 decodedView = quantized ? view * Mat4::affine({{{codes.step[0], 0, 0}, {0, codes.step[1], 0}, {0, 0, codes.step[2]}}},
+                                                             {codes.origin[0], codes.origin[1], codes.origin[2]})
+                                        : view;
+
+     #pragma omp parallel for // Parallelize the loop using OpenMP
+     for (long long block = 0; block < blockCount; ++block)
+     {
+         if (skipBlocks && !blockUsed[block])
+         {
+             continue;
+         }
+         size_t begin = block * blockSize;
+         size_t count = std::min(blockSize, source.vertexCount() - begin);
+         if (quantized)
+         {
+             transformVertices(decodedView.m, codes.x.data() + begin, codes.y.data() + begin, codes.z.data() + begin,
+                               count, projected + 3 * begin);
+         }
+         else
+         {
+             transformVertices(view.m, source.x.data() + begin, source.y.data() + begin, source.z.data() + begin,
+                               count, projected + 3 * begin);
+         }
+     }
+
+     stats.facesDrawn = source.faceCount() - stats.facesOffCanvas - stats.facesCulled;
+     return stats;
+ }
+
+ /**
+  * @brief Projects all triangles of a geometry onto the canvas.
+  *
+  * The faces are culled and their vertices mapped to screen space by cullAndMapFaces. The triangles are then
+  * rasterized from the mapped vertices in screen tiles, in parallel; the image is the same as drawing them
+  * one by one in order.
+  *
+  * With occlusion culling, a face is skipped in every screen tile where the canvas's depth blocks show it to
+  * be hidden behind what was drawn before, including earlier objects; see rasterizeBatch.
+  *
+  * With a pixel error for the levels of detail, the coarsest level whose error the view maps to at most that
+  * many pixels is drawn instead of the full mesh; see MeshGeometry::selectLevel.
+  *
+  * With deferred shading, the faces are rasterized into depths and face indices only, and each pixel they
+  * win is colored once afterwards, however many faces were drawn over it; see rasterizeBatch.
+  *
+  * @param geometry The mesh, its hierarchy and its levels of detail.
+  * @param model The transform from the mesh's own frame.
+  * @param color The packed RGB color to draw every face in, or nullptr for the faces' own colors.
+  * @param c The canvas onto which the triangles are projected.
+  * @param options Which faces to cull, in which order to draw them and which level of detail to draw.
+  * @param scratch The buffers to project into, reused between calls.
+  * @return The number of faces rasterized and culled, and of face and tile pairs skipped as hidden.
   */
- TriangleObject::TriangleObject(const std::string &stlFileName)
+ RenderStats projectGeometry(const MeshGeometry &geometry, const Mat4 &model, const uint32_t *color, Canvas &c,
+                             const RenderOptions &options, RenderScratch &scratch)
  {
-     triangles = std::make_shared<std::vector<TriangleSurface>>(); // Initialize the shared pointer for triangles
-     readSTL(stlFileName, triangles); // Load triangle data from the STL file
+     const Mat4 view = c.getCamera().getView() * model;
+     const size_t level = geometry.selectLevel(view, options.lodPixelError);
+     const Mesh &source = geometry.levelMesh(level);
+     const Bvh &hierarchy = geometry.levelBvh(level);
+
+     scratch.faceMask.resize(source.faceCount());
+     scratch.projected.resize(3 * source.vertexCount());
+     RenderStats stats = cullAndMapFaces(source, hierarchy, model, c, options, scratch.faceMask.data(),
+                                         scratch.projected.data(), scratch.blockUsed);
+     stats.lodLevel = level;
+     if (stats.facesDrawn == 0)
+     {
+         return stats;
+     }
+
+     ScreenBatch batch = {scratch.projected.data(), source.indices.data(), color ? color : source.colors.data(), source.faceCount()};
+     batch.sharedColor = color != nullptr;
+     batch.faceMask = scratch.faceMask.data();
+     batch.cullOccluded = options.cullOccluded;
+     batch.deferShading = options.deferShading;
+     if (options.sortFrontToBack)
+     {
+         orderFacesFrontToBack(hierarchy, view, scratch.drawOrder);
+         batch.order = scratch.drawOrder.data();
+     }
+
+     RasterStats raster = rasterizeBatch(c, batch); // Draw the triangles in screen tiles on all cores
+     stats.faceTiles = raster.faceTiles;
+     stats.faceTilesOccluded = raster.faceTilesOccluded;
+     stats.pixelsWritten = raster.pixelsWritten;
+     stats.pixelsShaded = raster.pixelsShaded;
+     return stats;
  }
- 
+
  /**
-  * @brief Projects all triangles in the object onto the canvas.
-  * 
-  * This function iterates over all triangles and projects each one onto the canvas using the `project` method
-  * of the TriangleSurface class.
-  * 
+  * @brief Projects all triangles in the object onto the canvas, through its model transform; see projectGeometry.
+  *
   * @param c The canvas onto which the triangles are projected.
+  * @param options Which faces to cull, in which order to draw them and which level of detail to draw.
+  * @return The number of faces rasterized and culled, and of face and tile pairs skipped as hidden.
+  */
+ RenderStats TriangleObject::project(Canvas &c, const RenderOptions &options)
+ {
+     return projectGeometry(*geometry, model, nullptr, c, options, scratch);
+ }
+
+ /**
+  * @brief Applies a transform after the current model transform.
+  *
+  * Only the model matrix is updated; the mesh itself is never modified, so a transform costs the
+  * same regardless of the number of triangles and rounding errors do not build up in the vertices.
+  *
+  * @param transform The affine transform to apply.
+  */
+ void TriangleObject::compose(const Mat4 &transform)
+ {
+     model = transform * model;
+ }
+
+ /**
+  * @brief Rotates the object about a point.
+  *
+  * @param rotation The 3x3 rotation matrix.
+  * @param rotationPoint The point around which the object is rotated.
   */
- void TriangleObject::project(Canvas &c)
+ void TriangleObject::rotate(const Mat3 &rotation, const std::vector<float> &rotationPoint)
  {
-     for (int i = 0; i < triangles->size(); ++i)
+     // Translate to the origin, rotate, and translate back: x' = R (x - p) + p = R x + (p - R p)
+     const Vec3 p = toVec3(rotationPoint);
+     Vec3 offset = p;
+     for (int i = 0; i < 3; ++i)
      {
-         (*triangles)[i].project(c); // Project each triangle onto the canvas
+         for (int j = 0; j < 3; ++j)
+         {
+             offset[i] -= rotation[i][j] * p[j];
+         }
      }
+     compose(Mat4::affine(rotation, offset));
  }
- 
+
  /**
   * @brief Rotates all triangles in the object around the X-axis by a given angle.
-  * 
-  * This function applies a rotation transformation to all triangles in parallel using OpenMP.
-  * 
+  *
   * @param angle The angle of rotation in degrees.
   * @param rotationPoint The point around which the triangles are rotated.
   */
  void TriangleObject::rotateAroundX(float angle, const std::vector<float> &rotationPoint)
  {
-     #pragma omp parallel for // Parallelize the loop using OpenMP
-     for (int i = 0; i < triangles->size(); ++i)
-     {
-         (*triangles)[i].rotateAroundX(angle, rotationPoint); // Rotate each triangle around the X-axis
-     }
+     // Convert angle from degrees to radians
+     float rad = angle * M_PI / 180.0f;
+     float cosA = cos(rad);
+     float sinA = sin(rad);
+
+     const Mat3 rotation = {{{1, 0, 0}, {0, cosA, -sinA}, {0, sinA, cosA}}};
+     rotate(rotation, rotationPoint);
  }
- 
+
  /**
   * @brief Rotates all triangles in the object around the Y-axis by a given angle.
-  * 
-  * This function applies a rotation transformation to all triangles in parallel using OpenMP.
-  * 
+  *
   * @param angle The angle of rotation in degrees.
   * @param rotationPoint The point around which the triangles are rotated.
   */
  void TriangleObject::rotateAroundY(float angle, const std::vector<float> &rotationPoint)
  {
-     #pragma omp parallel for // Parallelize the loop using OpenMP
-     for (int i = 0; i < triangles->size(); ++i)
-     {
-         (*triangles)[i].rotateAroundY(angle, rotationPoint); // Rotate each triangle around the Y-axis
-     }
+     // Convert angle from degrees to radians
+     float rad = angle * M_PI / 180.0f;
+     float cosA = cos(rad);
+     float sinA = sin(rad);
+
+     const Mat3 rotation = {{{cosA, 0, sinA}, {0, 1, 0}, {-sinA, 0, cosA}}};
+     rotate(rotation, rotationPoint);
  }
- 
+
  /**
   * @brief Rotates all triangles in the object around the Z-axis by a given angle.
-  * 
-  * This function applies a rotation transformation to all triangles in parallel using OpenMP.
-  * 
+  *
   * @param angle The angle of rotation in degrees.
   * @param rotationPoint The point around which the triangles are rotated.
   */
  void TriangleObject::rotateAroundZ(float angle, const std::vector<float> &rotationPoint)
  {
-     #pragma omp parallel for // Parallelize the loop using OpenMP
-     for (int i = 0; i < triangles->size(); ++i)
-     {
-         (*triangles)[i].rotateAroundZ(angle, rotationPoint); // Rotate each triangle around the Z-axis
-     }
+     // Convert angle from degrees to radians
+     float rad = angle * M_PI / 180.0f;
+     float cosA = cos(rad);
+     float sinA = sin(rad);
+
+     const Mat3 rotation = {{{cosA, -sinA, 0}, {sinA, cosA, 0}, {0, 0, 1}}};
+     rotate(rotation, rotationPoint);
  }
- 
+
  /**
   * @brief Scales all triangles in the object by a given factor.
-  * 
-  * This function applies a scaling transformation to all triangles in parallel using OpenMP.
-  * 
+  *
   * @param k The scaling factor.
   */
  void TriangleObject::scale(float k)
  {
-     #pragma omp parallel for // Parallelize the loop using OpenMP
-     for (int i = 0; i < triangles->size(); ++i)
-     {
-         (*triangles)[i].scale(k); // Scale each triangle
-     }
+     compose(Mat4::affine({{{k, 0, 0}, {0, k, 0}, {0, 0, k}}}, Vec3()));
  }
- 
+
  /**
   * @brief Translates all triangles in the object by a given offset.
-  * 
-  * This function applies a translation transformation to all triangles in parallel using OpenMP.
-  * 
+  *
   * @param x The offset in the X direction.
   * @param y The offset in the Y direction.
   * @param z The offset in the Z direction.
   */
  void TriangleObject::translate(float x, float y, float z)
  {
-     #pragma omp parallel for // Parallelize the loop using OpenMP
-     for (int i = 0; i < triangles->size(); ++i)
-     {
-         (*triangles)[i].translate(x, y, z); // Translate each triangle
-     }
+     compose(Mat4::affine(Mat3(), {x, y, z}));
  }
- 
+
  /**
   * @brief Returns the number of triangles in the object.
-  * 
+  *
   * @return The number of triangles in the object.
   */
  int TriangleObject::size()
  {
-     return static_cast<int>(triangles->size()); // Return the size of the triangles vector
- }
\ No newline at end of file
+     return static_cast<int>(geometry->mesh.faceCount()); // Return the number of faces in the mesh
+ }
+
+ /**
+  * @brief Returns the number of bytes held by the object's geometry buffers.
+  *
+  * The geometry is counted in full even when other objects share it.
+  *
+  * @return The capacity in bytes of the vertex, index, color, normal, hierarchy, level of detail, projection and
+  * culling buffers.
+  */
+ size_t TriangleObject::getMemoryUsage() const
+ {
+     return geometry->getMemoryUsage() + scratch.getMemoryUsage();
+ }
+
+ /**
+  * @brief Returns the geometry the object draws, to share it with other objects and instances.
+  *
+  * @return The shared, immutable geometry.
+  */
+ std::shared_ptr<const MeshGeometry> TriangleObject::getGeometry() const
+ {
+     return geometry;
+ }
+
+ /**
+  * @brief Builds a TriangleSurface for every face of the mesh, with the model transform applied.
+  *
+  * The returned triangles are copies: transforming them does not affect the object.
+  *
+  * @return A shared pointer to a vector with one TriangleSurface per face, in face order.
+  */
+ std::shared_ptr<std::vector<TriangleSurface>> TriangleObject::toTriangles() const
+ {
+     const Mesh &mesh = geometry->mesh;
+     auto triangles = std::make_shared<std::vector<TriangleSurface>>();
+     triangles->reserve(mesh.faceCount());
+
+     auto vertex = [this, &mesh](uint32_t index)
+     {
+         float position[3];
+         mesh.getVertex(index, position);
+         return transformPoint(model, {position[0], position[1], position[2]});
+     };
+
+     for (size_t f = 0; f < mesh.faceCount(); ++f)
+     {
+         const uint32_t *face = mesh.indices.data() + 3 * f;
+         float color[3];
+         unpackColor(mesh.colors[f], color);
+         triangles->emplace_back(vertex(face[0]), vertex(face[1]), vertex(face[2]), Vec3{color[0], color[1], color[2]});
+     }
+
+     return triangles;
+ }
@@ -5,6 +5,7 @@
  * The TriangleSurface class represents a 3D triangle surface defined by three vertices (A, B, C)
  * and a color. It provides methods for projecting the triangle onto a 2D canvas, checking if a point
  * lies inside the triangle, and applying transformations such as rotation, scaling, and translation.
+ * The vertices and the color are held by value as Vec3, so a triangle needs no heap allocations.
  * 
  * @author Ben Benyamin
  * @date March 2025
@@ -16,7 +17,9 @@
  #include <iostream>
  #include "TriangleSurface.h"
  #include "Canvas.h"
+ #include "color.h"
  #include "linalg.h"
+ #include "raster.h"
  
  /**
   * @brief Constructs a TriangleSurface object with the given vertices and color.
@@ -24,52 +27,60 @@
   * @param a The first vertex of the triangle.
   * @param b The second vertex of the triangle.
   * @param c The third vertex of the triangle.
-  * @param color The color of the triangle as a vector of three floats (RGB).
+  * @param color The color of the triangle as three floats (RGB).
   */
- TriangleSurface::TriangleSurface(const std::vector<float> &a, const std::vector<float> &b, const std::vector<float> &c, const std::vector<float> &color)
+ TriangleSurface::TriangleSurface(const Vec3 &a, const Vec3 &b, const Vec3 &c, const Vec3 &color)
      : A{a}, B{b}, C{c}, color{color} {}
  
  /**
-  * @brief Projects the triangle onto the canvas and renders it.
-  * 
-  * This function projects the triangle's vertices onto the canvas using the camera's normal vector
-  * and renders the triangle by iterating over the projected area. It uses the `isInside` function
-  * to determine if a point lies inside the triangle and the `putPixel` method of the canvas to render it.
+  * @brief Projects the triangle onto the canvas and renders it, using the canvas camera.
   * 
   * @param c The canvas onto which the triangle is projected.
   */
  void TriangleSurface::project(Canvas &c)
- {   
-     auto cameraAxis = c.getCameraAxis();
-     auto normal = cameraAxis[0];
- 
-     // Project the triangle's vertices onto the plane defined by the camera's normal vector
-     std::vector<float> projectedA = projectPointToPlane(A, normal);
-     std::vector<float> projectedB = projectPointToPlane(B, normal);
-     std::vector<float> projectedC = projectPointToPlane(C, normal);
- 
-     // Calculate the extremes of the projected triangle for rendering
-     auto extremes = calculateDotProductExtremes(projectedA, projectedB, projectedC, cameraAxis);
+ {
+     project(c, c.getCamera());
+ }
  
-     // Iterate over the projected area and render the triangle
-     for (int i = extremes.first.first; i < extremes.first.second; ++i)
+ /**
+  * @brief Projects the triangle onto the canvas with a given camera and renders it.
+  * 
+  * This function maps the triangle's vertices with the camera's view matrix, giving each vertex a canvas
+  * row, a canvas column and a depth along the camera's normal vector, and renders the projected triangle
+  * with `rasterizeTriangle`.
+  * 
+  * @param c The canvas onto which the triangle is projected.
+  * @param camera The camera to project with.
+  */
+ void TriangleSurface::project(Canvas &c, const Camera &camera) const
+ {
+     float projected[3][3];
+     const Vec3 *vertices[3] = {&A, &B, &C};
+     for (int k = 0; k < 3; ++k)
      {
-         for (int j = extremes.second.first; j <  extremes.second.second; ++j)
-         {
-             std::vector<float> point = {static_cast<float>(i), static_cast<float>(j)};
- 
-             // Check if the point is inside the triangle
-             auto point3D = isInside(point, projectedA, projectedB, projectedC);
+         Vec3 screen = camera.toScreen(*vertices[k]);
+         projected[k][0] = screen.x;
+         projected[k][1] = screen.y;
+         projected[k][2] = screen.z;
+     }
  
-             if (!point3D.empty()) // If the point is inside the triangle, render it
-             {
-                 // Calculate the depth of the point
-                 auto depth = static_cast<int>(dotProduct(point3D, normal));
+     rasterizeTriangle(c, projected[0], projected[1], projected[2], packColor(color.x, color.y, color.z));
+ }
  
-                 // Render the pixel on the canvas
-                 c.putPixel(i, j, depth, color);
-             }
-         }
+ /**
+  * @brief Projects a batch of triangles onto the canvas.
+  * 
+  * The canvas camera is looked up once and shared by all the triangles.
+  * 
+  * @param c The canvas onto which the triangles are projected.
+  * @param triangles The triangles to project, drawn in order.
+  */
+ void projectTriangles(Canvas &c, const std::vector<TriangleSurface> &triangles)
+ {
+     const Camera &camera = c.getCamera();
+     for (const TriangleSurface &triangle : triangles)
+     {
+         triangle.project(c, camera);
      }
  }
  
@@ -112,14 +123,7 @@
      if (u >= 0 && v >= 0 && u + v <= 1)
      {
          // Calculate the 3D coordinates of the point inside the triangle
-         std::vector<float> point3D = 
-         {
-             A[0] + u * (B[0] - A[0]) + v * (C[0] - A[0]),
-             A[1] + u * (B[1] - A[1]) + v * (C[1] - A[1]),
-             A[2] + u * (B[2] - A[2]) + v * (C[2] - A[2])
-         };
- 
-         return point3D;
+         return toVector(A + u * (B - A) + v * (C - A));
      }
  
      return {}; // Point is not inside the triangle
@@ -137,14 +141,25 @@
      const std::vector<float> &normal) const
  {
      // Project the point onto the plane
-     std::vector<float> projection = point;
-     
-     float dProd = dotProduct(point, normal);
-     projection[0] -= dProd * normal[0];
-     projection[1] -= dProd * normal[1];
-     projection[2] -= dProd * normal[2];
+     Vec3 p = toVec3(point);
+     Vec3 n = toVec3(normal);
+     return toVector(p - dot(p, n) * n);
+ }
  
-     return projection;
+ /**
+  * @brief Rotates the triangle about a point.
+  *
+  * @param rotation The 3x3 rotation matrix.
+  * @param rotationPoint The point around which the triangle is rotated.
+  */
+ void TriangleSurface::rotate(const Mat3 &rotation, const std::vector<float> &rotationPoint)
+ {
+     // Translate to the origin, rotate, and translate back
+     Vec3 p = toVec3(rotationPoint);
+     for (Vec3 *point : {&A, &B, &C})
+     {
+         *point = rotation * (*point - p) + p;
+     }
  }
  
  /**
@@ -160,30 +175,8 @@
      float cosA = cos(rad);
      float sinA = sin(rad);
  
-     // Translate points to origin by subtracting the rotation point
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         point.get()[0] -= rotationPoint[0];
-         point.get()[1] -= rotationPoint[1];
-         point.get()[2] -= rotationPoint[2];
-     }
- 
-     // Rotate each vector around the X-axis
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         float newY = point.get()[1] * cosA - point.get()[2] * sinA;
-         float newZ = point.get()[1] * sinA + point.get()[2] * cosA;
-         point.get()[1] = newY;
-         point.get()[2] = newZ;
-     }
- 
-     // Translate points back to original position
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         point.get()[0] += rotationPoint[0];
-         point.get()[1] += rotationPoint[1];
-         point.get()[2] += rotationPoint[2];
-     }
+     const Mat3 rotation = {{{1, 0, 0}, {0, cosA, -sinA}, {0, sinA, cosA}}};
+     rotate(rotation, rotationPoint);
  }
  
  /**
@@ -199,30 +192,8 @@
      float cosA = cos(rad);
      float sinA = sin(rad);
  
-     // Translate points to origin by subtracting the rotation point
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         point.get()[0] -= rotationPoint[0];
-         point.get()[1] -= rotationPoint[1];
-         point.get()[2] -= rotationPoint[2];
-     }
- 
-     // Rotate each vector around the Y-axis
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         float newX = point.get()[0] * cosA + point.get()[2] * sinA;
-         float newZ = -point.get()[0] * sinA + point.get()[2] * cosA;
-         point.get()[0] = newX;
-         point.get()[2] = newZ;
-     }
- 
-     // Translate points back to original position
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         point.get()[0] += rotationPoint[0];
-         point.get()[1] += rotationPoint[1];
-         point.get()[2] += rotationPoint[2];
-     }
+     const Mat3 rotation = {{{cosA, 0, sinA}, {0, 1, 0}, {-sinA, 0, cosA}}};
+     rotate(rotation, rotationPoint);
  }
  
  /**
@@ -238,30 +209,8 @@
      float cosA = cos(rad);
      float sinA = sin(rad);
  
-     // Translate points to origin by subtracting the rotation point
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         point.get()[0] -= rotationPoint[0];
-         point.get()[1] -= rotationPoint[1];
-         point.get()[2] -= rotationPoint[2];
-     }
- 
-     // Rotate each vector around the Z-axis
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         float newX = point.get()[0] * cosA - point.get()[1] * sinA;
-         float newY = point.get()[0] * sinA + point.get()[1] * cosA;
-         point.get()[0] = newX;
-         point.get()[1] = newY;
-     }
- 
-     // Translate points back to original position
-     for (auto &point : {std::ref(A), std::ref(B), std::ref(C)})
-     {
-         point.get()[0] += rotationPoint[0];
-         point.get()[1] += rotationPoint[1];
-         point.get()[2] += rotationPoint[2];
-     }
+     const Mat3 rotation = {{{cosA, -sinA, 0}, {sinA, cosA, 0}, {0, 0, 1}}};
+     rotate(rotation, rotationPoint);
  }
  
  /**
@@ -271,17 +220,9 @@
   */
  void TriangleSurface::scale(float k)
  {
-     this->A[0] *= k;
-     this->A[1] *= k;
-     this->A[2] *= k;
- 
-     this->B[0] *= k;
-     this->B[1] *= k;
-     this->B[2] *= k;
- 
-     this->C[0] *= k;
-     this->C[1] *= k;
-     this->C[2] *= k;
+     A *= k;
+     B *= k;
+     C *= k;
  }
  
  /**
@@ -293,15 +234,8 @@
   */
  void TriangleSurface::translate(float x, float y, float z)
  {
-     this->A[0] += x;
-     this->A[1] += y;
-     this->A[2] += z;
- 
-     this->B[0] += x;
-     this->B[1] += y;
-     this->B[2] += z;
- 
-     this->C[0] += x;
-     this->C[1] += y;
-     this->C[2] += z;
+     const Vec3 offset = {x, y, z};
+     A += offset;
+     B += offset;
+     C += offset;
  }
\ No newline at end of file
@@ -0,0 +1,263 @@
+/**
+ * @file VertexKernel.cpp
+ * @brief This file contains the batched vertex transform kernel used to project whole meshes.
+ *
+ * The kernel reads vertices from structure-of-arrays storage and writes them interleaved, which is the layout
+ * the rasterizer reads. The coordinates are either floats or 16-bit quantized codes; codes are widened to
+ * floats in registers, and the matrix is expected to decode them as part of the transform. It has an AVX2 version (8 vertices per step), an SSE version (4 vertices per step) and a
+ * scalar version, chosen at run time from what the CPU supports, so the library does not need to be compiled
+ * for a particular CPU.
+ *
+ * All versions use the same operations in the same order and no fused multiply-add, so they produce
+ * bit-identical results and a rendered image does not depend on the machine it was rendered on.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <cstdint>
+ #include "vertex_kernel.h"
+
+ #if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+ #define VERTEX_KERNEL_X86
+ #include <immintrin.h>
+ #endif
+
+ namespace
+ {
+     /**
+      * @brief Transforms vertices one at a time; also handles the tail left over by the vector versions.
+      */
+     template <typename Coord>
+     void transformScalar(const float m[3][4], const Coord *x, const Coord *y, const Coord *z, size_t begin,
+                          size_t end, float *out)
+     {
+         for (size_t v = begin; v < end; ++v)
+         {
+             for (int i = 0; i < 3; ++i)
+             {
+                 out[3 * v + i] = m[i][0] * static_cast<float>(x[v]) + m[i][1] * static_cast<float>(y[v]) +
+                                  m[i][2] * static_cast<float>(z[v]) + m[i][3];
+             }
+         }
+     }
+
+ #ifdef VERTEX_KERNEL_X86
+     /**
+      * @brief Loads four coordinates as floats with SSE.
+      */
+     inline __m128 load4(const float *p)
+     {
+         return _mm_loadu_ps(p);
+     }
+
+     /**
+      * @brief Loads four 16-bit codes and widens them to floats with SSE2 alone.
+      */
+     inline __m128 load4(const uint16_t *p)
+     {
+         const __m128i codes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+         return _mm_cvtepi32_ps(_mm_unpacklo_epi16(codes, _mm_setzero_si128()));
+     }
+
+     /**
+      * @brief Loads eight coordinates as floats with AVX2.
+      */
+     __attribute__((target("avx2")))
+     inline __m256 load8(const float *p)
+     {
+         return _mm256_loadu_ps(p);
+     }
+
+     /**
+      * @brief Loads eight 16-bit codes and widens them to floats with AVX2.
+      */
+     __attribute__((target("avx2")))
+     inline __m256 load8(const uint16_t *p)
+     {
+         const __m128i codes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+         return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(codes));
+     }
+
+     /**
+      * @brief Transforms four vertices per step with SSE, which every x86-64 CPU supports.
+      *
+      * @return The number of vertices transformed; the rest is left to the scalar version.
+      */
+     template <typename Coord>
+     size_t transformSSE(const float m[3][4], const Coord *x, const Coord *y, const Coord *z, size_t count, float *out)
+     {
+         __m128 row[3][4];
+         for (int i = 0; i < 3; ++i)
+         {
+             for (int j = 0; j < 4; ++j)
+             {
+                 row[i][j] = _mm_set1_ps(m[i][j]);
+             }
+         }
+
+         size_t v = 0;
+         for (; v + 4 <= count; v += 4)
+         {
+             __m128 vx = load4(x + v), vy = load4(y + v), vz = load4(z + v);
+             __m128 r[3];
+             for (int i = 0; i < 3; ++i)
+             {
+                 r[i] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(row[i][0], vx), _mm_mul_ps(row[i][1], vy)),
+                                              _mm_mul_ps(row[i][2], vz)),
+                                   row[i][3]);
+             }
+
+             // Interleave (a0..a3), (b0..b3), (c0..c3) into a0 b0 c0 a1 | b1 c1 a2 b2 | c2 a3 b3 c3
+             __m128 abLow = _mm_unpacklo_ps(r[0], r[1]);  // a0 b0 a1 b1
+             __m128 abHigh = _mm_unpackhi_ps(r[0], r[1]); // a2 b2 a3 b3
+             __m128 c0a1 = _mm_shuffle_ps(r[2], abLow, _MM_SHUFFLE(2, 2, 0, 0));
+             __m128 b1c1 = _mm_shuffle_ps(abLow, r[2], _MM_SHUFFLE(1, 1, 3, 3));
+             __m128 c2a3 = _mm_shuffle_ps(r[2], abHigh, _MM_SHUFFLE(2, 2, 2, 2));
+             __m128 b3c3 = _mm_shuffle_ps(abHigh, r[2], _MM_SHUFFLE(3, 3, 3, 3));
+
+             float *dst = out + 3 * v;
+             _mm_storeu_ps(dst + 0, _mm_shuffle_ps(abLow, c0a1, _MM_SHUFFLE(2, 0, 1, 0)));
+             _mm_storeu_ps(dst + 4, _mm_shuffle_ps(b1c1, abHigh, _MM_SHUFFLE(1, 0, 2, 0)));
+             _mm_storeu_ps(dst + 8, _mm_shuffle_ps(c2a3, b3c3, _MM_SHUFFLE(2, 0, 2, 0)));
+         }
+         return v;
+     }
+
+     /**
+      * @brief Transforms eight vertices per step with AVX2.
+      *
+      * The shuffles work within each 128-bit half, so each half is interleaved exactly like the SSE version and
+      * the halves are then reordered into three contiguous stores.
+      *
+      * @return The number of vertices transformed; the rest is left to the scalar version.
+      */
+     template <typename Coord>
+     __attribute__((target("avx2")))
+     size_t transformAVX2(const float m[3][4], const Coord *x, const Coord *y, const Coord *z, size_t count, float *out)
+     {
+         __m256 row[3][4];
+         for (int i = 0; i < 3; ++i)
+         {
+             for (int j = 0; j < 4; ++j)
+             {
+                 row[i][j] = _mm256_set1_ps(m[i][j]);
+             }
+         }
+
+         size_t v = 0;
+         for (; v + 8 <= count; v += 8)
+         {
+             __m256 vx = load8(x + v), vy = load8(y + v), vz = load8(z + v);
+             __m256 r[3];
+             for (int i = 0; i < 3; ++i)
+             {
+                 r[i] = _mm256_add_ps(
+                     _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(row[i][0], vx), _mm256_mul_ps(row[i][1], vy)),
+                                   _mm256_mul_ps(row[i][2], vz)),
+                     row[i][3]);
+             }
+
+             __m256 abLow = _mm256_unpacklo_ps(r[0], r[1]);
+             __m256 abHigh = _mm256_unpackhi_ps(r[0], r[1]);
+             __m256 c0a1 = _mm256_shuffle_ps(r[2], abLow, _MM_SHUFFLE(2, 2, 0, 0));
+             __m256 b1c1 = _mm256_shuffle_ps(abLow, r[2], _MM_SHUFFLE(1, 1, 3, 3));
+             __m256 c2a3 = _mm256_shuffle_ps(r[2], abHigh, _MM_SHUFFLE(2, 2, 2, 2));
+             __m256 b3c3 = _mm256_shuffle_ps(abHigh, r[2], _MM_SHUFFLE(3, 3, 3, 3));
+
+             __m256 first = _mm256_shuffle_ps(abLow, c0a1, _MM_SHUFFLE(2, 0, 1, 0));   // Vertices 0-3 and 4-7, part 1
+             __m256 second = _mm256_shuffle_ps(b1c1, abHigh, _MM_SHUFFLE(1, 0, 2, 0)); // Part 2
+             __m256 third = _mm256_shuffle_ps(c2a3, b3c3, _MM_SHUFFLE(2, 0, 2, 0));    // Part 3
+
+             float *dst = out + 3 * v;
+             _mm256_storeu_ps(dst + 0, _mm256_permute2f128_ps(first, second, 0x20));
+             _mm256_storeu_ps(dst + 8, _mm256_permute2f128_ps(third, first, 0x30));
+             _mm256_storeu_ps(dst + 16, _mm256_permute2f128_ps(second, third, 0x31));
+         }
+         return v;
+     }
+ #endif
+
+     /**
+      * @brief Runs the fastest supported version of the kernel on as many vertices as it can, then the scalar one.
+      */
+     template <typename Coord>
+     void dispatchTransform(const float matrix[3][4], const Coord *x, const Coord *y, const Coord *z, size_t count,
+                            float *out, SimdLevel level)
+     {
+         size_t done = 0;
+         if (level > detectSimdLevel())
+         {
+             level = detectSimdLevel();
+         }
+
+ #ifdef VERTEX_KERNEL_X86
+         if (level == SimdLevel::AVX2)
+         {
+             done = transformAVX2(matrix, x, y, z, count, out);
+         }
+         else if (level == SimdLevel::SSE)
+         {
+             done = transformSSE(matrix, x, y, z, count, out);
+         }
+ #endif
+
+         transformScalar(matrix, x, y, z, done, count, out);
+     }
+ }
+
+ /**
+  * @brief Detects the fastest instruction set the vertex kernel can use on this CPU.
+  *
+  * The result is computed once and reused.
+  *
+  * @return The detected SIMD level.
+  */
+ SimdLevel detectSimdLevel()
+ {
+ #ifdef VERTEX_KERNEL_X86
+     static const SimdLevel level = __builtin_cpu_supports("avx2") ? SimdLevel::AVX2 : SimdLevel::SSE;
+     return level;
+ #else
+     return SimdLevel::Scalar;
+ #endif
+ }
+
+ /**
+  * @brief Maps a batch of vertices through a 3x4 affine matrix.
+  *
+  * Vertex v is read from x[v], y[v] and z[v], and row i of the matrix applied to it is written to out[3 * v + i].
+  *
+  * @param matrix The affine matrix: a 3x3 linear part followed by a translation column.
+  * @param x The x coordinates of the vertices.
+  * @param y The y coordinates of the vertices.
+  * @param z The z coordinates of the vertices.
+  * @param count The number of vertices.
+  * @param out Receives three floats per vertex.
+  * @param level The instruction set to use. Levels the CPU does not support fall back to the best supported one.
+  */
+ void transformVertices(const float matrix[3][4], const float *x, const float *y, const float *z, size_t count,
+                        float *out, SimdLevel level)
+ {
+     dispatchTransform(matrix, x, y, z, count, out, level);
+ }
+
+ /**
+  * @brief Maps a batch of vertices stored as 16-bit codes through a 3x4 affine matrix.
+  *
+  * The codes are widened to floats exactly, so the matrix applies to the codes themselves: to land in a
+  * frame, it has to include the decoding of the codes, see quantizeVertices.
+  *
+  * @param matrix The affine matrix: a 3x3 linear part followed by a translation column.
+  * @param x The x codes of the vertices.
+  * @param y The y codes of the vertices.
+  * @param z The z codes of the vertices.
+  * @param count The number of vertices.
+  * @param out Receives three floats per vertex.
+  * @param level The instruction set to use. Levels the CPU does not support fall back to the best supported one.
+  */
+ void transformVertices(const float matrix[3][4], const uint16_t *x, const uint16_t *y, const uint16_t *z, size_t count,
+                        float *out, SimdLevel level)
+ {
+     dispatchTransform(matrix, x, y, z, count, out, level);
+ }
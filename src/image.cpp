@@ -0,0 +1,414 @@
+/**
+ * @file image.cpp
+ * @brief This file contains the image encoders used to write canvases to disk.
+ *
+ * Every encoder splits the image into bands of rows and encodes the bands in parallel into separate
+ * buffers, which are then joined into one buffer so the file can be written with a single call. The bands
+ * always have the same height, so the bytes written do not depend on the number of threads.
+ *
+ * - PPM (P3) writes the same text as the original writePPM.
+ * - P6 writes the raw RGB bytes.
+ * - QOI bands continue the encoder state of the previous band: the previous pixel and the 64-entry color
+ *   index at the start of each band are reconstructed from the pixels before it, so the stream decodes
+ *   with any standard QOI decoder.
+ * - PNG keeps the data uncompressed in stored deflate blocks. Each band becomes its own IDAT chunk with its
+ *   own CRC, and the Adler-32 checksums of the bands are combined into the one the zlib stream needs.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <array>
+ #include <charconv>
+ #include <cstring>
+ #include <omp.h> // OpenMP for parallel processing
+ #include "image.h"
+
+ namespace
+ {
+     constexpr int kBandRows = 64; // Height of the bands encoded in parallel
+
+     /**
+      * @brief Encodes every band of rows in parallel and appends the results to the output in band order.
+      *
+      * @param height The number of rows in the image.
+      * @param out The buffer the encoded bands are appended to.
+      * @param encodeBand Called as encodeBand(band, firstRow, endRow, bandBuffer).
+      */
+     template <typename EncodeBand>
+     void encodeBands(int height, std::vector<uint8_t> &out, EncodeBand &&encodeBand)
+     {
+         const int bandCount = (height + kBandRows - 1) / kBandRows;
+         std::vector<std::vector<uint8_t>> bands(bandCount);
+
+         #pragma omp parallel for schedule(dynamic) // Parallelize the loop using OpenMP
+         for (int band = 0; band < bandCount; ++band)
+         {
+             encodeBand(band, band * kBandRows, std::min(height, (band + 1) * kBandRows), bands[band]);
+         }
+
+         size_t total = out.size();
+         for (const auto &band : bands)
+         {
+             total += band.size();
+         }
+         out.reserve(total);
+         for (const auto &band : bands)
+         {
+             out.insert(out.end(), band.begin(), band.end());
+         }
+     }
+
+     /**
+      * @brief Appends text to a byte buffer.
+      */
+     void appendText(std::vector<uint8_t> &out, const std::string &text)
+     {
+         out.insert(out.end(), text.begin(), text.end());
+     }
+
+     /**
+      * @brief Appends a 32-bit value in big-endian byte order, as QOI and PNG store them.
+      */
+     void appendBigEndian(std::vector<uint8_t> &out, uint32_t value)
+     {
+         for (int shift = 24; shift >= 0; shift -= 8)
+         {
+             out.push_back(static_cast<uint8_t>(value >> shift));
+         }
+     }
+
+     /**
+      * @brief Encodes the image as ASCII PPM: "r g b " for every pixel and a newline after every row.
+      */
+     void encodeP3(const uint32_t *pixels, int width, int height, std::vector<uint8_t> &out)
+     {
+         appendText(out, "P3\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n");
+         encodeBands(height, out, [&](int, int rowBegin, int rowEnd, std::vector<uint8_t> &band)
+         {
+             band.resize(static_cast<size_t>(rowEnd - rowBegin) * (width * 12 + 1)); // At most "255 255 255 " per pixel
+             char *cursor = reinterpret_cast<char *>(band.data());
+             for (int i = rowBegin; i < rowEnd; ++i)
+             {
+                 for (int j = 0; j < width; ++j)
+                 {
+                     uint32_t pixel = pixels[static_cast<size_t>(i) * width + j];
+                     for (int k = 0; k < 3; ++k)
+                     {
+                         cursor = std::to_chars(cursor, cursor + 3, (pixel >> (8 * k)) & 0xFF).ptr;
+                         *cursor++ = ' ';
+                     }
+                 }
+                 *cursor++ = '\n';
+             }
+             band.resize(cursor - reinterpret_cast<char *>(band.data()));
+         });
+     }
+
+     /**
+      * @brief Encodes the image as binary PPM.
+      */
+     void encodeP6(const uint32_t *pixels, int width, int height, std::vector<uint8_t> &out)
+     {
+         appendText(out, "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n");
+         encodeBands(height, out, [&](int, int rowBegin, int rowEnd, std::vector<uint8_t> &band)
+         {
+             band.resize(static_cast<size_t>(rowEnd - rowBegin) * width * 3);
+             uint8_t *cursor = band.data();
+             for (size_t p = static_cast<size_t>(rowBegin) * width; p < static_cast<size_t>(rowEnd) * width; ++p)
+             {
+                 *cursor++ = static_cast<uint8_t>(pixels[p]);
+                 *cursor++ = static_cast<uint8_t>(pixels[p] >> 8);
+                 *cursor++ = static_cast<uint8_t>(pixels[p] >> 16);
+             }
+         });
+     }
+
+     // QOI works on RGBA; canvas pixels are opaque, so their alpha byte is set to 255
+     constexpr uint32_t kOpaque = 0xFF000000u;
+
+     /**
+      * @brief Returns the slot of a pixel in the QOI color index.
+      */
+     inline int qoiHash(uint32_t rgba)
+     {
+         uint32_t r = rgba & 0xFF, g = (rgba >> 8) & 0xFF, b = (rgba >> 16) & 0xFF, a = rgba >> 24;
+         return (r * 3 + g * 5 + b * 7 + a * 11) % 64;
+     }
+
+     /**
+      * @brief Encodes the image as QOI with three channels.
+      *
+      * A QOI decoder stores every decoded pixel in the index, except for runs, whose pixel is already there.
+      * The one exception is a run of black pixels at the very start of the image, which repeats the implicit
+      * starting pixel and is never stored. So the index at the start of a band holds, for each slot, the last
+      * earlier pixel with that hash, skipping that leading run; each band finds its own last pixels in
+      * parallel, and those are merged in band order.
+      */
+     void encodeQOI(const uint32_t *pixels, int width, int height, std::vector<uint8_t> &out)
+     {
+         appendText(out, "qoif");
+         appendBigEndian(out, width);
+         appendBigEndian(out, height);
+         out.push_back(3); // RGB
+         out.push_back(0); // sRGB with linear alpha
+
+         const size_t pixelCount = static_cast<size_t>(width) * height;
+         const size_t leadingBlack = std::find_if(pixels, pixels + pixelCount, [](uint32_t p) { return p != 0; }) - pixels;
+         const int bandCount = (height + kBandRows - 1) / kBandRows;
+
+         // Last pixel stored in each index slot by each band; 0 (transparent black) marks an unused slot
+         std::vector<std::array<uint32_t, 64>> bandIndex(bandCount);
+         #pragma omp parallel for // Parallelize the loop using OpenMP
+         for (int band = 0; band < bandCount; ++band)
+         {
+             bandIndex[band].fill(0);
+             size_t begin = std::max(static_cast<size_t>(band) * kBandRows * width, leadingBlack);
+             size_t end = std::min(static_cast<size_t>(band + 1) * kBandRows * width, pixelCount);
+             for (size_t p = begin; p < end; ++p)
+             {
+                 uint32_t rgba = pixels[p] | kOpaque;
+                 bandIndex[band][qoiHash(rgba)] = rgba;
+             }
+         }
+
+         encodeBands(height, out, [&](int band, int rowBegin, int rowEnd, std::vector<uint8_t> &bytes)
+         {
+             std::array<uint32_t, 64> index = {};
+             for (int earlier = 0; earlier < band; ++earlier)
+             {
+                 for (int slot = 0; slot < 64; ++slot)
+                 {
+                     if (bandIndex[earlier][slot] != 0)
+                         index[slot] = bandIndex[earlier][slot];
+                 }
+             }
+
+             size_t begin = static_cast<size_t>(rowBegin) * width, end = static_cast<size_t>(rowEnd) * width;
+             uint32_t previous = begin == 0 ? kOpaque : pixels[begin - 1] | kOpaque;
+             int run = 0;
+             bytes.reserve((end - begin) * 2);
+
+             for (size_t p = begin; p < end; ++p)
+             {
+                 uint32_t rgba = pixels[p] | kOpaque;
+                 if (rgba == previous)
+                 {
+                     if (++run == 62 || p + 1 == end) // Runs end with the band, so bands stay independent
+                     {
+                         bytes.push_back(static_cast<uint8_t>(0xC0 | (run - 1))); // QOI_OP_RUN
+                         run = 0;
+                     }
+                     continue;
+                 }
+                 if (run > 0)
+                 {
+                     bytes.push_back(static_cast<uint8_t>(0xC0 | (run - 1))); // QOI_OP_RUN
+                     run = 0;
+                 }
+
+                 int slot = qoiHash(rgba);
+                 if (index[slot] == rgba)
+                 {
+                     bytes.push_back(static_cast<uint8_t>(slot)); // QOI_OP_INDEX
+                 }
+                 else
+                 {
+                     index[slot] = rgba;
+                     int8_t dr = static_cast<int8_t>((rgba & 0xFF) - (previous & 0xFF));
+                     int8_t dg = static_cast<int8_t>(((rgba >> 8) & 0xFF) - ((previous >> 8) & 0xFF));
+                     int8_t db = static_cast<int8_t>(((rgba >> 16) & 0xFF) - ((previous >> 16) & 0xFF));
+                     int drg = dr - dg, dbg = db - dg;
+
+                     if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1)
+                     {
+                         bytes.push_back(static_cast<uint8_t>(0x40 | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2))); // QOI_OP_DIFF
+                     }
+                     else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+                     {
+                         bytes.push_back(static_cast<uint8_t>(0x80 | (dg + 32))); // QOI_OP_LUMA
+                         bytes.push_back(static_cast<uint8_t>((drg + 8) << 4 | (dbg + 8)));
+                     }
+                     else
+                     {
+                         bytes.push_back(0xFE); // QOI_OP_RGB
+                         bytes.push_back(static_cast<uint8_t>(rgba));
+                         bytes.push_back(static_cast<uint8_t>(rgba >> 8));
+                         bytes.push_back(static_cast<uint8_t>(rgba >> 16));
+                     }
+                 }
+                 previous = rgba;
+             }
+         });
+
+         const uint8_t endMarker[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+         out.insert(out.end(), endMarker, endMarker + 8);
+     }
+
+     /**
+      * @brief Returns the CRC-32 lookup table used by PNG chunks.
+      */
+     const std::array<uint32_t, 256> &crcTable()
+     {
+         static const std::array<uint32_t, 256> table = []
+         {
+             std::array<uint32_t, 256> t;
+             for (uint32_t n = 0; n < 256; ++n)
+             {
+                 uint32_t c = n;
+                 for (int k = 0; k < 8; ++k)
+                     c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                 t[n] = c;
+             }
+             return t;
+         }();
+         return table;
+     }
+
+     /**
+      * @brief Appends a PNG chunk: length, type, data and the CRC of type and data.
+      */
+     void appendChunk(std::vector<uint8_t> &out, const char type[4], const uint8_t *data, size_t size)
+     {
+         appendBigEndian(out, static_cast<uint32_t>(size));
+         size_t crcStart = out.size();
+         out.insert(out.end(), type, type + 4);
+         out.insert(out.end(), data, data + size);
+
+         uint32_t crc = 0xFFFFFFFFu;
+         for (size_t k = crcStart; k < out.size(); ++k)
+             crc = crcTable()[(crc ^ out[k]) & 0xFF] ^ (crc >> 8);
+         appendBigEndian(out, crc ^ 0xFFFFFFFFu);
+     }
+
+     constexpr uint32_t kAdlerModulus = 65521;
+
+     /**
+      * @brief Combines the Adler-32 checksums of two consecutive pieces of data.
+      *
+      * @param first The checksum of the first piece.
+      * @param second The checksum of the second piece.
+      * @param secondLength The length of the second piece in bytes.
+      * @return The checksum of both pieces together.
+      */
+     uint32_t adlerCombine(uint32_t first, uint32_t second, size_t secondLength)
+     {
+         uint64_t a1 = first & 0xFFFF, b1 = first >> 16, a2 = second & 0xFFFF, b2 = second >> 16;
+         uint64_t length = secondLength % kAdlerModulus;
+         uint64_t a = (a1 + a2 + kAdlerModulus - 1) % kAdlerModulus;
+         uint64_t b = (b1 + b2 + length * a1 + kAdlerModulus - length) % kAdlerModulus;
+         return static_cast<uint32_t>(b << 16 | a);
+     }
+
+     /**
+      * @brief Encodes the image as an 8-bit RGB PNG whose zlib stream uses stored (uncompressed) blocks.
+      */
+     void encodePNG(const uint32_t *pixels, int width, int height, std::vector<uint8_t> &out)
+     {
+         const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+         out.insert(out.end(), signature, signature + 8);
+
+         std::vector<uint8_t> header;
+         appendBigEndian(header, width);
+         appendBigEndian(header, height);
+         header.insert(header.end(), {8, 2, 0, 0, 0}); // 8 bits per channel, RGB, deflate, no filter choice, no interlace
+         appendChunk(out, "IHDR", header.data(), header.size());
+
+         const uint8_t zlibHeader[2] = {0x78, 0x01}; // Deflate with a 32 KiB window, no preset dictionary
+         appendChunk(out, "IDAT", zlibHeader, sizeof(zlibHeader));
+
+         const int bandCount = (height + kBandRows - 1) / kBandRows;
+         const size_t rowSize = 1 + static_cast<size_t>(width) * 3; // Filter type byte and the RGB bytes
+         std::vector<uint32_t> bandAdler(bandCount);
+
+         encodeBands(height, out, [&](int band, int rowBegin, int rowEnd, std::vector<uint8_t> &chunk)
+         {
+             // Raw scanlines, each with filter type 0 (none)
+             std::vector<uint8_t> raw(static_cast<size_t>(rowEnd - rowBegin) * rowSize);
+             uint8_t *cursor = raw.data();
+             for (int i = rowBegin; i < rowEnd; ++i)
+             {
+                 *cursor++ = 0;
+                 for (const uint32_t *p = pixels + static_cast<size_t>(i) * width, *e = p + width; p != e; ++p)
+                 {
+                     *cursor++ = static_cast<uint8_t>(*p);
+                     *cursor++ = static_cast<uint8_t>(*p >> 8);
+                     *cursor++ = static_cast<uint8_t>(*p >> 16);
+                 }
+             }
+
+             uint32_t a = 1, b = 0;
+             for (size_t offset = 0; offset < raw.size(); offset += 5552) // The most bytes before b can overflow
+             {
+                 for (size_t k = offset, end = std::min(raw.size(), offset + 5552); k < end; ++k)
+                 {
+                     a += raw[k];
+                     b += a;
+                 }
+                 a %= kAdlerModulus;
+                 b %= kAdlerModulus;
+             }
+             bandAdler[band] = b << 16 | a;
+
+             // Stored deflate blocks of at most 65535 bytes; only the very last block is final
+             std::vector<uint8_t> blocks;
+             blocks.reserve(raw.size() + (raw.size() / 65535 + 1) * 5);
+             for (size_t offset = 0; offset < raw.size(); offset += 65535)
+             {
+                 uint16_t length = static_cast<uint16_t>(std::min<size_t>(65535, raw.size() - offset));
+                 bool final = band == bandCount - 1 && offset + length == raw.size();
+                 blocks.insert(blocks.end(), {static_cast<uint8_t>(final ? 1 : 0), static_cast<uint8_t>(length),
+                                              static_cast<uint8_t>(length >> 8), static_cast<uint8_t>(~length),
+                                              static_cast<uint8_t>(~length >> 8)});
+                 blocks.insert(blocks.end(), raw.begin() + offset, raw.begin() + offset + length);
+             }
+             appendChunk(chunk, "IDAT", blocks.data(), blocks.size());
+         });
+
+         uint32_t adler = 1;
+         for (int band = 0; band < bandCount; ++band)
+         {
+             int rows = std::min(height, (band + 1) * kBandRows) - band * kBandRows;
+             adler = adlerCombine(adler, bandAdler[band], rows * rowSize);
+         }
+         std::vector<uint8_t> trailer;
+         if (bandCount == 0)
+         {
+             trailer = {1, 0, 0, 0xFF, 0xFF}; // An empty final stored block
+         }
+         appendBigEndian(trailer, adler);
+         appendChunk(out, "IDAT", trailer.data(), trailer.size());
+         appendChunk(out, "IEND", nullptr, 0);
+     }
+ }
+
+ /**
+  * @brief Encodes packed RGB pixels into a complete image file.
+  *
+  * @param pixels The pixels, packed with packColor and stored row by row.
+  * @param width The number of pixels per row.
+  * @param height The number of rows.
+  * @param format The file format to encode.
+  * @return The bytes of the file.
+  */
+ std::vector<uint8_t> encodeImage(const uint32_t *pixels, int width, int height, ImageFormat format)
+ {
+     std::vector<uint8_t> out;
+     switch (format)
+     {
+     case ImageFormat::PPM:
+         encodeP3(pixels, width, height, out);
+         break;
+     case ImageFormat::P6:
+         encodeP6(pixels, width, height, out);
+         break;
+     case ImageFormat::QOI:
+         encodeQOI(pixels, width, height, out);
+         break;
+     case ImageFormat::PNG:
+         encodePNG(pixels, width, height, out);
+         break;
+     }
+     return out;
+ }
@@ -5,15 +5,100 @@
  * The functions in this file provide essential linear algebra operations, such as calculating
  * determinants, dot products, vector norms, and orthonormal bases. Additionally, it includes
  * utility functions for computing extreme values of dot products for projected points.
+ *
+ * The vector types and their arithmetic are defined inline in linalg.h. The functions here work on Vec3 and
+ * Mat3; the overloads taking std::vector<float> convert their arguments and forward to them.
  * 
  * @author Ben Benyamin
  * @date March 2025
  */
 
  #include <vector>
- #include <random>
  #include <cmath>
  #include <algorithm>
+ #include "linalg.h"
+ 
+ /**
+  * @brief Calculates an orthonormal basis for a given 3D vector using the Gram-Schmidt process.
+  * 
+  * This function generates two orthonormal vectors that are perpendicular to the input vector v1. They are
+  * made from the two standard basis vectors least aligned with v1, so the result depends only on v1, and a
+  * vector along an axis gets the other two axes exactly. The larger of the two in lexicographic order is
+  * returned first.
+  * 
+  * @param v1 The input 3D unit vector.
+  * @return A pair of orthonormal vectors perpendicular to v1.
+  */
+ std::pair<Vec3, Vec3> calculateOrthonormals(const Vec3 &v1)
+ {
+     // Skip the standard basis vector closest to v1; the other two are independent of it
+     int skipped = 0;
+     for (int i = 1; i < 3; ++i)
+     {
+         if (std::fabs(v1[i]) > std::fabs(v1[skipped]))
+         {
+             skipped = i;
+         }
+     }
+ 
+     Vec3 v2, v3;
+     v2[skipped == 0 ? 1 : 0] = 1.0f;
+     v3[skipped == 2 ? 1 : 2] = 1.0f;
+ 
+     // Gram–Schmidt process
+     v2 -= dot(v1, v2) * v1;
+     v2 /= length(v2);
+ 
+     v3 -= dot(v1, v3) * v1 + dot(v2, v3) * v2;
+     v3 /= length(v3);
+ 
+     // Compare the vectors lexicographically: first by x, then by y, then by z
+     auto less = [](const Vec3 &a, const Vec3 &b)
+     {
+         if (a[0] != b[0]) return a[0] < b[0];
+         if (a[1] != b[1]) return a[1] < b[1];
+         return a[2] < b[2];
+     };
+ 
+     return less(v3, v2) ? std::make_pair(v2, v3) : std::make_pair(v3, v2);
+ }
+ 
+ /**
+  * @brief Calculates the minimum and maximum dot products of projected points with camera axis vectors.
+  * 
+  * This function computes the dot products of projected points with the second and third rows of the camera
+  * basis and returns the minimum and maximum values for each axis.
+  * 
+  * @param projectedA The first projected 3D point.
+  * @param projectedB The second projected 3D point.
+  * @param projectedC The third projected 3D point.
+  * @param cameraBasis The camera normal followed by its two orthonormal vectors, as rows.
+  * @return A pair of pairs containing the minimum and maximum dot products for each axis.
+  */
+ std::pair<std::pair<float, float>, std::pair<float, float>> calculateDotProductExtremes
+ (
+     const Vec3 &projectedA, const Vec3 &projectedB, const Vec3 &projectedC, const Mat3 &cameraBasis)
+ {
+     // Calculate dot products with cameraBasis[1] and cameraBasis[2] for projected points
+     float dotA1 = dot(projectedA, cameraBasis[1]);
+     float dotA2 = dot(projectedA, cameraBasis[2]);
+ 
+     float dotB1 = dot(projectedB, cameraBasis[1]);
+     float dotB2 = dot(projectedB, cameraBasis[2]);
+ 
+     float dotC1 = dot(projectedC, cameraBasis[1]);
+     float dotC2 = dot(projectedC, cameraBasis[2]);
+  
+     // Calculate the min and max i,j values for the projections
+     float minDot1 = std::min({dotA1, dotB1, dotC1});
+     float maxDot1 = std::max({dotA1, dotB1, dotC1});
+ 
+     float minDot2 = std::min({dotA2, dotB2, dotC2});
+     float maxDot2 = std::max({dotA2, dotB2, dotC2});
+ 
+     // Return the results as a pair of pairs
+     return std::make_pair(std::make_pair(minDot1, maxDot1), std::make_pair(minDot2, maxDot2));
+ }
  
  /**
   * @brief Calculates the determinant of a 3x3 matrix formed by three 3D vectors.
@@ -25,10 +110,7 @@
   */
  float determinant3x3(const std::vector<float> &v1, const std::vector<float> &v2, const std::vector<float> &v3)
  {
-     // Determinant of the 3x3 matrix formed by v1, v2, v3
-     return v1[0] * (v2[1] * v3[2] - v2[2] * v3[1]) -
-            v1[1] * (v2[0] * v3[2] - v2[2] * v3[0]) +
-            v1[2] * (v2[0] * v3[1] - v2[1] * v3[0]);
+     return determinant(Mat3{{toVec3(v1), toVec3(v2), toVec3(v3)}});
  }
  
  /**
@@ -40,7 +122,7 @@
   */
  float dotProduct(const std::vector<float> &v1, const std::vector<float> &v2)
  {
-     return v1[0] * v2[0] + v1[1] * v2[1] + v1[2] * v2[2];
+     return dot(toVec3(v1), toVec3(v2));
  }
  
  /**
@@ -51,81 +133,28 @@
   */
  float norm(const std::vector<float> &v1)
  {
-     return std::sqrt(dotProduct(v1, v1));
+     return length(toVec3(v1));
  }
  
  /**
   * @brief Calculates an orthonormal basis for a given 3D vector using the Gram-Schmidt process.
   * 
-  * This function generates two orthonormal vectors that are perpendicular to the input vector v1.
-  * The vectors are sorted lexicographically before being returned.
-  * 
   * @param v1 The input 3D vector.
   * @return A pair of orthonormal vectors perpendicular to v1.
   */
  std::vector<std::vector<float>> calculateOrthonormals(const std::vector<float> &v1)
  {
-     float det = 0;
-     std::vector<float> v2, v3;
-     while (det == 0)
-     // Get 2 Random vectors from the standard base
-     {
-         int index2 = rand() % 3;
-         int index3 = rand() % 3;
- 
-         v2 = (index2 == 0) ? std::vector<float>{1.0f, 0.0f, 0.0f} : (index2 == 1) ? std::vector<float>{0.0f, 1.0f, 0.0f}
-                                                                                   : std::vector<float>{0.0f, 0.0f, 1.0f};
- 
-         v3 = (index3 == 0) ? std::vector<float>{1.0f, 0.0f, 0.0f} : (index3 == 1) ? std::vector<float>{0.0f, 1.0f, 0.0f}
-                                                                                   : std::vector<float>{0.0f, 0.0f, 1.0f};
- 
-         det = determinant3x3(v1, v2, v3);
-     }
- 
-     // Gram–Schmidt process
- 
-     v2[0] -= dotProduct(v1, v2) * v1[0];
-     v2[1] -= dotProduct(v1, v2) * v1[1];
-     v2[2] -= dotProduct(v1, v2) * v1[2];
- 
-     float v2_norm = norm(v2);
- 
-     v2[0] /= v2_norm;
-     v2[1] /= v2_norm;
-     v2[2] /= v2_norm;
- 
-     v3[0] -= dotProduct(v1, v3) * v1[0] + dotProduct(v2, v3) * v3[0];
-     v3[1] -= dotProduct(v1, v3) * v1[1] + dotProduct(v2, v3) * v3[1];
-     v3[2] -= dotProduct(v1, v3) * v1[2] + dotProduct(v2, v3) * v3[2];
- 
-     float v3_norm = norm(v3);
- 
-     v3[0] /= v3_norm;
-     v3[1] /= v3_norm;
-     v3[2] /= v3_norm;
- 
-     std::vector<std::vector<float>> result = {v2, v3};
- 
-     std::sort(result.begin(), result.end(), [](const std::vector<float> &a, const std::vector<float> &b)
-               {
-         // Compare the vectors lexicographically: first by x, then by y, then by z
-         if (a[0] != b[0]) return a[0] < b[0];
-         if (a[1] != b[1]) return a[1] < b[1];
-         return a[2] < b[2]; });
- 
-     return {result[1], result[0]};
+     auto [first, second] = calculateOrthonormals(toVec3(v1));
+     return {toVector(first), toVector(second)};
  }
  
  /**
   * @brief Calculates the minimum and maximum dot products of projected points with camera axis vectors.
   * 
-  * This function computes the dot products of projected points with two camera axis vectors and
-  * returns the minimum and maximum values for each axis.
-  * 
   * @param projectedA The first projected 3D point.
   * @param projectedB The second projected 3D point.
   * @param projectedC The third projected 3D point.
-  * @param cameraAxis A pair of orthonormal camera axis vectors.
+  * @param cameraAxis The camera normal followed by its two orthonormal vectors.
   * @return A pair of pairs containing the minimum and maximum dot products for each axis.
   */
  std::pair<std::pair<float, float>, std::pair<float, float>> calculateDotProductExtremes
@@ -133,23 +162,6 @@
      const std::vector<float>& projectedA, const std::vector<float>& projectedB, const std::vector<float>& projectedC, 
      const std::vector<std::vector<float>>& cameraAxis)
  {
-     // Calculate dot products with cameraAxis[1] and cameraAxis[2] for projected points
-     float dotA1 = dotProduct(projectedA, cameraAxis[1]);
-     float dotA2 = dotProduct(projectedA, cameraAxis[2]);
- 
-     float dotB1 = dotProduct(projectedB, cameraAxis[1]);
-     float dotB2 = dotProduct(projectedB, cameraAxis[2]);
- 
-     float dotC1 = dotProduct(projectedC, cameraAxis[1]);
-     float dotC2 = dotProduct(projectedC, cameraAxis[2]);
-  
-     // Calculate the min and max i,j values for the projections
-     float minDot1 = std::min({dotA1, dotB1, dotC1});
-     float maxDot1 = std::max({dotA1, dotB1, dotC1});
- 
-     float minDot2 = std::min({dotA2, dotB2, dotC2});
-     float maxDot2 = std::max({dotA2, dotB2, dotC2});
- 
-     // Return the results as a pair of pairs
-     return std::make_pair(std::make_pair(minDot1, maxDot1), std::make_pair(minDot2, maxDot2));
- }
\ No newline at end of file
+     Mat3 cameraBasis = {{toVec3(cameraAxis[0]), toVec3(cameraAxis[1]), toVec3(cameraAxis[2])}};
+     return calculateDotProductExtremes(toVec3(projectedA), toVec3(projectedB), toVec3(projectedC), cameraBasis);
+ }
@@ -4,6 +4,7 @@
  * 
  * The program loads an STL file, processes the 3D model, and renders it onto a 2D canvas. It applies transformations
  * such as scaling, rotation, and translation to the model and generates multiple PPM images of the rendered model.
+ * The images are written by a FrameWriter on a background thread, overlapping disk output with rendering.
  * 
  * @author Ben Benyamin
  * @date March 2025
@@ -15,7 +16,8 @@
  #include <filesystem>
  #include "Canvas.h"
  #include "TriangleSurface.h"
- #include "stl.cpp"
+ #include "frame_writer.h"
+ #include "stl.h"
  #include "TriangleObject.h"
  
  /**
@@ -35,6 +37,7 @@
      // Set the camera normal vector
      std::vector<float> cameraNormal = {0.0f, 0.0f, 1.0f};
      canvas.setCameraNormal(cameraNormal);
+     canvas.setClearMode(ClearMode::Epoch); // Clearing between frames only advances the canvas epoch
  
      // Load the STL file
      std::string filename = "../example/ASCII.stl";
@@ -51,17 +54,20 @@
      triangleObject.translate(-200, 0, 0); // Translate the model
      triangleObject.rotateAroundY(-15, rotationCenter); // Rotate around the Y-axis again
  
-     // Render the model and generate PPM images
+     // Render the model and generate PPM images; each frame is written in the background while the next
+     // one is rendered into another canvas
+     FrameWriter writer(canvas);
      for (int i = 0; i < 3; i++)
      {
-         triangleObject.project(canvas); // Project the model onto the canvas
+         Canvas &frame = writer.acquire(); // A cleared canvas with the same camera
+         triangleObject.project(frame); // Project the model onto the canvas
          triangleObject.rotateAroundX(6, rotationCenter); // Rotate around the X-axis
  
          // Save the rendered canvas as a PPM file
          std::string outFileName = "../output/MODEL_" + std::to_string(i) + ".ppm";
-         canvas.writePPM(outFileName);
-         canvas.clear(); // Clear the canvas for the next iteration
+         writer.submit(frame, outFileName, ImageFormat::PPM);
      }
+     writer.finish(); // Wait for the last frames to be written
  
      return 0; // Exit the program
  }
\ No newline at end of file
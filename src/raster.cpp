@@ -0,0 +1,708 @@
+/**
+ * @file raster.cpp
+ * @brief This file contains the triangle rasterizer shared by TriangleSurface and TriangleObject.
+ *
+ * The rasterizer works on vertices that have already been projected to screen space, so callers can
+ * project each vertex once and reuse the result for every triangle that shares it.
+ *
+ * Each triangle is set up once: its vertices are snapped to fixed point, and the three edge functions and
+ * the depth plane are set up at the corner of its bounding box. Scanning the box then only adds constant
+ * steps and evaluates the depth plane, with no divisions and no allocations per pixel. Because the edge functions are exact integers, the
+ * top-left fill rule decides reliably which of two triangles owns the pixels on their shared edge.
+ *
+ * Batches of triangles are binned into square screen tiles, and the tiles are rasterized in parallel. Each
+ * tile only writes its own pixels and visits its triangles in batch order, so no locks are needed and the
+ * image is the same as with a single thread.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <cmath>
+ #include <limits>
+ #include <utility>
+ #include <vector>
+ #include <omp.h> // OpenMP for parallel processing
+ #include "Canvas.h"
+ #include "color.h"
+ #include "raster.h"
+
+ namespace
+ {
+     constexpr int kSubPixelBits = 8;                      // Fixed-point precision of the snapped vertices
+     constexpr int64_t kOne = int64_t(1) << kSubPixelBits; // One pixel in fixed point
+     constexpr float kMaxCoordinate = float(1 << 21);      // Guard band: farther edge ends could overflow the edge functions
+     constexpr int kTileSize = 64;                         // Tile edge length in pixels
+     constexpr int kTileBlocks = kTileSize / Canvas::kDepthBlockSize; // Depth blocks along a tile edge
+     constexpr int kRefreshInterval = 32;                  // Faces drawn over a depth block between its refreshes
+     constexpr uint32_t kNoFace = UINT32_MAX;              // Pixel of a tile that no face of the batch won
+
+     static_assert(kTileSize % Canvas::kDepthBlockSize == 0, "A depth block must not straddle two tiles");
+
+     /**
+      * @brief Rounds a screen coordinate to fixed point.
+      */
+     inline int64_t toFixed(float value)
+     {
+         return static_cast<int64_t>(std::llround(value * kOne));
+     }
+
+     /**
+      * @brief Rounds a screen coordinate computed in double precision to fixed point.
+      */
+     inline int64_t toFixed(double value)
+     {
+         return static_cast<int64_t>(std::llround(value * kOne));
+     }
+
+     /**
+      * @brief Divides by one pixel in fixed point, rounding toward negative infinity.
+      */
+     inline int64_t floorPixel(int64_t value)
+     {
+         return value >= 0 ? value / kOne : -((-value + kOne - 1) / kOne);
+     }
+
+     /**
+      * @brief Tells whether an edge owns the pixels lying exactly on it.
+      *
+      * Rows grow downward and columns to the right, and the triangle is wound so its interior is on the
+      * positive side of each edge. A top edge (horizontal, interior below) or a left edge (interior to its
+      * right) owns its pixels. Two triangles sharing an edge traverse it in opposite directions, so exactly
+      * one of them owns it.
+      *
+      * @param dRow The row extent of the edge.
+      * @param dCol The column extent of the edge.
+      */
+     inline bool isTopLeft(int64_t dRow, int64_t dCol)
+     {
+         return dRow > 0 || (dRow == 0 && dCol < 0);
+     }
+
+     /**
+      * @brief Moves the ends of an edge onto the guard band where its line crosses it.
+      *
+      * An edge only matters through the half plane on the positive side of its line, and any two points of
+      * the line give the same half plane. The ends are moved to where the line enters and leaves the square
+      * of side 2 * kMaxCoordinate around the origin, which holds every canvas, so the snapped ends stay small
+      * enough for exact edge functions. The ends are put in a fixed order before clipping, so a triangle that
+      * shares the edge and traverses it the other way gets the same two points and the fill rule still holds.
+      *
+      * @param from The start of the edge: row and column; replaced by the clipped start.
+      * @param to The end of the edge; replaced by the clipped end.
+      * @return 0 if the ends were clipped; otherwise the line misses the square, which then lies wholly inside
+      *         the edge's half plane (1) or wholly outside it (-1).
+      */
+     int clipEdgeToGuardBand(double from[2], double to[2])
+     {
+         const bool swapped = std::make_pair(from[0], from[1]) > std::make_pair(to[0], to[1]);
+         const double *p = swapped ? to : from, *q = swapped ? from : to;
+         const double d[2] = {q[0] - p[0], q[1] - p[1]};
+
+         // Range of the line parameter t, with the point at p + t * d, inside the square
+         double tMin = -std::numeric_limits<double>::infinity(), tMax = std::numeric_limits<double>::infinity();
+         bool misses = false;
+         for (int axis = 0; axis < 2; ++axis)
+         {
+             if (d[axis] == 0.0)
+             {
+                 misses = misses || std::fabs(p[axis]) > kMaxCoordinate;
+                 continue;
+             }
+             double t0 = (-kMaxCoordinate - p[axis]) / d[axis], t1 = (kMaxCoordinate - p[axis]) / d[axis];
+             tMin = std::max(tMin, std::min(t0, t1));
+             tMax = std::min(tMax, std::max(t0, t1));
+         }
+         if (misses || !(tMin < tMax))
+         {
+             // The whole square is on the side of the center, the origin
+             const double side = (to[0] - from[0]) * (0.0 - from[1]) - (to[1] - from[1]) * (0.0 - from[0]);
+             return side >= 0.0 ? 1 : -1;
+         }
+
+         double clipped[2][2];
+         for (int axis = 0; axis < 2; ++axis)
+         {
+             clipped[0][axis] = std::clamp(p[axis] + tMin * d[axis], double(-kMaxCoordinate), double(kMaxCoordinate));
+             clipped[1][axis] = std::clamp(p[axis] + tMax * d[axis], double(-kMaxCoordinate), double(kMaxCoordinate));
+         }
+         for (int axis = 0; axis < 2; ++axis)
+         {
+             from[axis] = clipped[swapped ? 1 : 0][axis];
+             to[axis] = clipped[swapped ? 0 : 1][axis];
+         }
+         return 0;
+     }
+
+     /**
+      * @brief Finds the nearest and farthest depths scanTriangle gives the pixels of a rectangle.
+      *
+      * The depth plane is evaluated at the corners of the rectangle exactly as scanTriangle evaluates it. Rounding
+      * never reverses the order of two values, so along a row or a column the evaluated depth is monotonic and
+      * its extremes over the rectangle are at corners. Both are NaN if the plane is not a number at a corner.
+      */
+     inline void depthRange(const TriangleSetup &setup, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                            float &nearest, float &farthest)
+     {
+         nearest = std::numeric_limits<float>::infinity();
+         farthest = -std::numeric_limits<float>::infinity();
+         for (int i : {rowBegin, rowEnd - 1})
+         {
+             float rowDepth = setup.depth + setup.depthStepRow * i;
+             for (int j : {colBegin, colEnd - 1})
+             {
+                 float depth = rowDepth + setup.depthStepCol * j;
+                 if (std::isnan(depth))
+                 {
+                     nearest = farthest = depth;
+                     return;
+                 }
+                 nearest = std::min(nearest, depth);
+                 farthest = std::max(farthest, depth);
+             }
+         }
+     }
+
+     /**
+      * @brief Tells whether a set-up triangle covers every pixel of a rectangle.
+      *
+      * The edge functions are linear and the triangle is convex, so it does when it covers the four corners.
+      */
+     inline bool coversRectangle(const TriangleSetup &setup, int rowBegin, int rowEnd, int colBegin, int colEnd)
+     {
+         for (int k = 0; k < 3; ++k)
+         {
+             for (int i : {rowBegin, rowEnd - 1})
+             {
+                 for (int j : {colBegin, colEnd - 1})
+                 {
+                     if (setup.edge[k] + (i - setup.rowBegin) * setup.edgeStepRow[k] + (j - setup.colBegin) * setup.edgeStepCol[k] < 0)
+                     {
+                         return false;
+                     }
+                 }
+             }
+         }
+         return true;
+     }
+
+     /**
+      * @brief Keeps the canvas's depth blocks within one screen tile up to date and tests faces against them.
+      *
+      * Drawing only brings pixels nearer, so a block's farthest depth can only become too far between refreshes,
+      * which makes the test skip less but never skip a face that would have been visible. A face that covers a
+      * whole block bounds the block's depth by its own at no cost. Any other block has to be refreshed by reading
+      * all of its pixels, which costs more than drawing a small face, so that is done after every few faces drawn
+      * over it, when a large face would be rejected by an up-to-date block, and when the tile is done.
+      */
+     class TileDepthBlocks
+     {
+     public:
+         TileDepthBlocks(Canvas &canvas, int rowBegin, int rowEnd, int colBegin, int colEnd)
+             : canvas(canvas), rowBegin(rowBegin), rowEnd(rowEnd), colBegin(colBegin), colEnd(colEnd) {}
+
+         /**
+          * @brief Tells whether none of the pixels of a set-up triangle can pass the depth test.
+          *
+          * If the nearest depth the triangle gives a pixel is no nearer than the farthest depth of every block its
+          * bounding box overlaps, no pixel would be replaced. Blocks with an empty pixel are never farther than
+          * anything, so a triangle over them is always drawn.
+          */
+         bool hides(const TriangleSetup &setup)
+         {
+             float nearest, farthest;
+             depthRange(setup, setup.rowBegin, setup.rowEnd, setup.colBegin, setup.colEnd, nearest, farthest);
+
+             // Refreshing a block is worth it for a face whose box fills about half of the blocks it overlaps
+             const int blocks = blockCount(setup.rowBegin, setup.rowEnd) * blockCount(setup.colBegin, setup.colEnd);
+             const bool large = 2 * (setup.rowEnd - setup.rowBegin) * (setup.colEnd - setup.colBegin) >= blocks * kBlock * kBlock;
+
+             for (int i = setup.rowBegin - setup.rowBegin % kBlock; i < setup.rowEnd; i += kBlock)
+             {
+                 for (int j = setup.colBegin - setup.colBegin % kBlock; j < setup.colEnd; j += kBlock)
+                 {
+                     if (!isBehind(nearest, canvas.getBlockDepth(i, j)))
+                     {
+                         uint8_t &count = drawn[(i - rowBegin) / kBlock][(j - colBegin) / kBlock];
+                         if (!large || count == 0)
+                         {
+                             return false;
+                         }
+                         canvas.refreshBlockDepth(i, j);
+                         count = 0;
+                         if (!isBehind(nearest, canvas.getBlockDepth(i, j)))
+                         {
+                             return false;
+                         }
+                     }
+                 }
+             }
+             return true;
+         }
+
+         /**
+          * @brief Records that a set-up triangle was drawn over the blocks its bounding box overlaps.
+          */
+         void draw(const TriangleSetup &setup)
+         {
+             for (int i = setup.rowBegin - setup.rowBegin % kBlock; i < setup.rowEnd; i += kBlock)
+             {
+                 for (int j = setup.colBegin - setup.colBegin % kBlock; j < setup.colEnd; j += kBlock)
+                 {
+                     // A block the face covers entirely holds nothing farther than the face now. Depths within one
+                     // of zero are left out: they truncate to the empty depth, which never replaces a pixel.
+                     const int blockRowEnd = std::min(i + kBlock, rowEnd), blockColEnd = std::min(j + kBlock, colEnd);
+                     if (setup.rowBegin <= i && blockRowEnd <= setup.rowEnd && setup.colBegin <= j && blockColEnd <= setup.colEnd &&
+                         coversRectangle(setup, i, blockRowEnd, j, blockColEnd))
+                     {
+                         float nearest, farthest;
+                         depthRange(setup, i, blockRowEnd, j, blockColEnd, nearest, farthest);
+                         if (nearest >= 1.0f || farthest <= -1.0f)
+                         {
+                             canvas.lowerBlockDepth(i, j, std::trunc(farthest));
+                             continue;
+                         }
+                     }
+
+                     uint8_t &count = drawn[(i - rowBegin) / kBlock][(j - colBegin) / kBlock];
+                     if (++count == kRefreshInterval)
+                     {
+                         canvas.refreshBlockDepth(i, j);
+                         count = 0;
+                     }
+                 }
+             }
+         }
+
+         /**
+          * @brief Refreshes every block drawn over since its last refresh, for the batches drawn after this one.
+          */
+         void finish()
+         {
+             for (int i = rowBegin; i < rowEnd; i += kBlock)
+             {
+                 for (int j = colBegin; j < colEnd; j += kBlock)
+                 {
+                     if (drawn[(i - rowBegin) / kBlock][(j - colBegin) / kBlock])
+                     {
+                         canvas.refreshBlockDepth(i, j);
+                     }
+                 }
+             }
+         }
+
+     private:
+         static constexpr int kBlock = Canvas::kDepthBlockSize;
+
+         /**
+          * @brief Tells whether a depth is no nearer than a block's farthest depth, and the block has no empty pixel.
+          */
+         static bool isBehind(float depth, float blockDepth)
+         {
+             return blockDepth < std::numeric_limits<float>::infinity() && depth >= blockDepth;
+         }
+
+         /**
+          * @brief Returns the number of blocks the pixels [begin, end) of a row or column overlap.
+          */
+         static int blockCount(int begin, int end)
+         {
+             return (end - 1) / kBlock - begin / kBlock + 1;
+         }
+
+         Canvas &canvas;
+         int rowBegin, rowEnd, colBegin, colEnd;       // Pixels of the tile
+         uint8_t drawn[kTileBlocks][kTileBlocks] = {}; // Faces drawn over each block since its last refresh
+     };
+
+     /**
+      * @brief Colors every pixel of a tile that a face of the batch won, once, with the color of that face.
+      *
+      * This is the shading pass of deferred shading. The raster pass only wrote depths and recorded the last
+      * face to win each pixel, so a pixel overdrawn many times is still colored once, and anything shading
+      * costs per pixel is only paid for the visible ones.
+      *
+      * @return The number of pixels colored.
+      */
+     long long resolveTile(Canvas &canvas, const ScreenBatch &batch, const uint32_t *visibleFaces, int rowBegin, int rowEnd,
+                           int colBegin, int colEnd)
+     {
+         long long shaded = 0;
+         for (int i = rowBegin; i < rowEnd; ++i)
+         {
+             const uint32_t *row = visibleFaces + (i - rowBegin) * kTileSize;
+             for (int j = colBegin; j < colEnd; ++j)
+             {
+                 const uint32_t f = row[j - colBegin];
+                 if (f != kNoFace)
+                 {
+                     canvas.shadePixel(i, j, batch.colors[batch.sharedColor ? 0 : f]);
+                     ++shaded;
+                 }
+             }
+         }
+         return shaded;
+     }
+
+     /**
+      * @brief Sets edge k of a triangle from its snapped ends, as seen from the first pixel the scan visits.
+      */
+     void setEdge(TriangleSetup &setup, int k, int64_t fromRow, int64_t fromCol, int64_t toRow, int64_t toCol)
+     {
+         const int64_t startRow = int64_t(setup.rowBegin) * kOne, startCol = int64_t(setup.colBegin) * kOne;
+         const int64_t dRow = toRow - fromRow, dCol = toCol - fromCol;
+
+         setup.edge[k] = dRow * (startCol - fromCol) - dCol * (startRow - fromRow) - (isTopLeft(dRow, dCol) ? 0 : 1);
+         setup.edgeStepRow[k] = -dCol * kOne;
+         setup.edgeStepCol[k] = dRow * kOne;
+     }
+
+     /**
+      * @brief Sets up a triangle with a vertex outside the guard band; see setupTriangle.
+      *
+      * The winding, the bounding box and the depth plane come from the vertices themselves, in double precision.
+      * Each edge reaching past the guard band is replaced by its line clipped to the band; an edge whose line
+      * misses the band either never rejects a pixel of the canvas, and is set up to accept all of them, or
+      * rejects every one, and so does the triangle.
+      */
+     bool setupClippedTriangle(const float *a, const float *b, const float *c, int rowBegin, int rowEnd, int colBegin,
+                               int colEnd, TriangleSetup &setup)
+     {
+         double v[3][3] = {{a[0], a[1], a[2]}, {b[0], b[1], b[2]}, {c[0], c[1], c[2]}};
+         const double area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[1][1] - v[0][1]) * (v[2][0] - v[0][0]);
+         if (area == 0.0)
+         {
+             return false;
+         }
+         if (area < 0.0)
+         {
+             std::swap(v[1], v[2]);
+         }
+
+         // Bounding box of the triangle, clipped to the rectangle before it is converted to pixels
+         const double minRow = std::min({v[0][0], v[1][0], v[2][0]}), maxRow = std::max({v[0][0], v[1][0], v[2][0]});
+         const double minCol = std::min({v[0][1], v[1][1], v[2][1]}), maxCol = std::max({v[0][1], v[1][1], v[2][1]});
+         setup.rowBegin = static_cast<int>(std::max<double>(rowBegin, std::ceil(std::min<double>(minRow, rowEnd))));
+         setup.rowEnd = static_cast<int>(std::min<double>(rowEnd, std::floor(std::max<double>(maxRow, rowBegin - 1)) + 1));
+         setup.colBegin = static_cast<int>(std::max<double>(colBegin, std::ceil(std::min<double>(minCol, colEnd))));
+         setup.colEnd = static_cast<int>(std::min<double>(colEnd, std::floor(std::max<double>(maxCol, colBegin - 1)) + 1));
+         if (setup.rowBegin >= setup.rowEnd || setup.colBegin >= setup.colEnd)
+         {
+             return false;
+         }
+
+         for (int k = 0; k < 3; ++k)
+         {
+             double from[2] = {v[k][0], v[k][1]}, to[2] = {v[(k + 1) % 3][0], v[(k + 1) % 3][1]};
+             const bool inGuardBand = std::max({std::fabs(from[0]), std::fabs(from[1]), std::fabs(to[0]), std::fabs(to[1])}) <= kMaxCoordinate;
+             const int side = inGuardBand ? 0 : clipEdgeToGuardBand(from, to);
+             if (side < 0)
+             {
+                 return false;
+             }
+
+             const int64_t fromRow = toFixed(from[0]), fromCol = toFixed(from[1]);
+             const int64_t toRow = toFixed(to[0]), toCol = toFixed(to[1]);
+             if (side > 0 || (fromRow == toRow && fromCol == toCol))
+             {
+                 // Never rejects a pixel; a line that only grazes a corner of the band is far from every canvas
+                 setup.edge[k] = 0;
+                 setup.edgeStepRow[k] = 0;
+                 setup.edgeStepCol[k] = 0;
+                 continue;
+             }
+             setEdge(setup, k, fromRow, fromCol, toRow, toCol);
+         }
+
+         // Depth plane through the three vertices, in double precision so the far vertices do not swamp it
+         const double AB[3] = {v[1][0] - v[0][0], v[1][1] - v[0][1], v[1][2] - v[0][2]};
+         const double AC[3] = {v[2][0] - v[0][0], v[2][1] - v[0][1], v[2][2] - v[0][2]};
+         const double det = AB[0] * AC[1] - AB[1] * AC[0];
+         const double stepRow = (AB[2] * AC[1] - AC[2] * AB[1]) / det, stepCol = (AB[0] * AC[2] - AC[0] * AB[2]) / det;
+         setup.depthStepRow = static_cast<float>(stepRow);
+         setup.depthStepCol = static_cast<float>(stepCol);
+         setup.depth = static_cast<float>(v[0][2] - stepRow * v[0][0] - stepCol * v[0][1]);
+         return true;
+     }
+ }
+
+ /**
+  * @brief Sets up the edge equations and depth plane of a triangle whose vertices are in screen space.
+  *
+  * The edge function of the edge from P to Q at pixel X is (Q - P) x (X - P), in fixed point. The vertices are
+  * ordered so that all three edge functions are positive inside the triangle; edges that do not own their pixels
+  * are biased by -1, so a pixel is covered exactly when all three biased values are non-negative.
+  *
+  * A triangle with a vertex farther than kMaxCoordinate from the origin, as a large face seen close up has, is
+  * set up from the lines of its edges clipped to that guard band (see clipEdgeToGuardBand), so it still covers
+  * the pixels it covers on the canvas.
+  *
+  * @param a The first vertex: canvas row, canvas column and depth.
+  * @param b The second vertex: canvas row, canvas column and depth.
+  * @param c The third vertex: canvas row, canvas column and depth.
+  * @param rowBegin The first row that may be visited.
+  * @param rowEnd One past the last row that may be visited.
+  * @param colBegin The first column that may be visited.
+  * @param colEnd One past the last column that may be visited.
+  * @param setup Receives the set-up triangle.
+  * @return False if the triangle is degenerate, not on the screen plane, or covers no pixel of the given rectangle.
+  */
+ bool setupTriangle(const float *a, const float *b, const float *c, int rowBegin, int rowEnd, int colBegin, int colEnd,
+                    TriangleSetup &setup)
+ {
+     bool inGuardBand = true;
+     for (const float *p : {a, b, c})
+     {
+         if (!(std::isfinite(p[0]) && std::isfinite(p[1])))
+         {
+             return false;
+         }
+         inGuardBand = inGuardBand && std::fabs(p[0]) <= kMaxCoordinate && std::fabs(p[1]) <= kMaxCoordinate;
+     }
+     if (!inGuardBand)
+     {
+         return setupClippedTriangle(a, b, c, rowBegin, rowEnd, colBegin, colEnd, setup);
+     }
+
+     int64_t row[3] = {toFixed(a[0]), toFixed(b[0]), toFixed(c[0])};
+     int64_t col[3] = {toFixed(a[1]), toFixed(b[1]), toFixed(c[1])};
+
+     int64_t area = (row[1] - row[0]) * (col[2] - col[0]) - (col[1] - col[0]) * (row[2] - row[0]);
+     if (area == 0)
+     {
+         return false; // Points are collinear; nothing to draw
+     }
+     if (area < 0)
+     {
+         std::swap(row[1], row[2]); // Wind the triangle so its interior is on the positive side of each edge
+         std::swap(col[1], col[2]);
+     }
+
+     // Bounding box of the triangle, clipped to the rectangle
+     setup.rowBegin = static_cast<int>(std::max<int64_t>(rowBegin, floorPixel(*std::min_element(row, row + 3) + kOne - 1)));
+     setup.rowEnd = static_cast<int>(std::min<int64_t>(rowEnd, floorPixel(*std::max_element(row, row + 3)) + 1));
+     setup.colBegin = static_cast<int>(std::max<int64_t>(colBegin, floorPixel(*std::min_element(col, col + 3) + kOne - 1)));
+     setup.colEnd = static_cast<int>(std::min<int64_t>(colEnd, floorPixel(*std::max_element(col, col + 3)) + 1));
+     if (setup.rowBegin >= setup.rowEnd || setup.colBegin >= setup.colEnd)
+     {
+         return false;
+     }
+
+     for (int k = 0; k < 3; ++k)
+     {
+         int from = k, to = (k + 1) % 3;
+         setEdge(setup, k, row[from], col[from], row[to], col[to]);
+     }
+
+     // Depth plane through the three vertices: depth = a + gradientRow * (row - a) + gradientCol * (col - a)
+     float AB[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+     float AC[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+     float det = AB[0] * AC[1] - AB[1] * AC[0];
+     setup.depthStepRow = (AB[2] * AC[1] - AC[2] * AB[1]) / det;
+     setup.depthStepCol = (AB[0] * AC[2] - AC[0] * AB[2]) / det;
+     setup.depth = a[2] - setup.depthStepRow * a[0] - setup.depthStepCol * a[1];
+     return true;
+ }
+
+ /**
+  * @brief Rasterizes a triangle whose vertices are already in screen space.
+  *
+  * Every covered pixel gets the depth interpolated from the vertex depths, truncated to a whole number, and is
+  * handed to `putPixel`, which performs the depth test.
+  *
+  * @param canvas The canvas onto which the triangle is drawn.
+  * @param a The first vertex: canvas row, canvas column and depth.
+  * @param b The second vertex: canvas row, canvas column and depth.
+  * @param c The third vertex: canvas row, canvas column and depth.
+  * @param color The color of the triangle, packed with packColor.
+  */
+ void rasterizeTriangle(Canvas &canvas, const float *a, const float *b, const float *c, uint32_t color)
+ {
+     TriangleSetup setup;
+     if (!setupTriangle(a, b, c, 0, canvas.getHeight(), 0, canvas.getWidth(), setup))
+     {
+         return;
+     }
+
+     scanTriangle(setup, [&](int i, int j, float depth)
+     {
+         canvas.putPixel(i, j, static_cast<int>(depth), color);
+     });
+ }
+
+ /**
+  * @brief Rasterizes a triangle whose vertices are already in screen space.
+  *
+  * @param canvas The canvas onto which the triangle is drawn.
+  * @param a The first vertex: canvas row, canvas column and depth.
+  * @param b The second vertex: canvas row, canvas column and depth.
+  * @param c The third vertex: canvas row, canvas column and depth.
+  * @param color The color of the triangle as a vector of three floats (RGB).
+  */
+ void rasterizeTriangle(Canvas &canvas, const float *a, const float *b, const float *c, std::vector<float> &color)
+ {
+     if (color.size() == 3)
+     {
+         rasterizeTriangle(canvas, a, b, c, packColor(color[0], color[1], color[2]));
+     }
+ }
+
+ /**
+  * @brief Rasterizes a batch of indexed triangles whose vertices are already in screen space.
+  *
+  * First every face is binned into the tiles its bounding box overlaps, keeping the faces of each tile in
+  * batch order, or in the batch's drawing order when it has one; faces excluded by the batch's face mask are not
+  * binned at all. Then the tiles are rasterized in parallel, each clipping its triangles to its own pixels.
+  *
+  * With occlusion culling, each face is first tested against the farthest depths of the canvas's depth blocks
+  * it overlaps, and skipped when it cannot pass the depth test anywhere in them; see TileDepthBlocks. The depth
+  * blocks never straddle two tiles, so the tiles do not share them. A skipped face would not have changed a
+  * pixel, so the image is the same either way.
+  *
+  * With deferred shading, rasterizing a face only runs the depth test and writes the depth, and records the
+  * face as the one that won each pixel in a buffer of face indices for the tile. Once all the tile's faces are
+  * rasterized, each pixel they won is colored once, from the face that won it last; see resolveTile. That is
+  * the face whose color putPixel would have left, so the image is the same.
+  *
+  * @param canvas The canvas onto which the triangles are drawn.
+  * @param batch The screen-space vertices, faces and face colors.
+  * @return The number of face and tile pairs set up, and how many of them were skipped as hidden; with deferred
+  * shading, also the number of pixels written and shaded.
+  */
+ RasterStats rasterizeBatch(Canvas &canvas, const ScreenBatch &batch)
+ {
+     const int height = canvas.getHeight(), width = canvas.getWidth();
+     const int tileRows = (height + kTileSize - 1) / kTileSize, tileCols = (width + kTileSize - 1) / kTileSize;
+     const long long faceCount = static_cast<long long>(batch.faceCount);
+
+     // Range of tiles overlapped by each face: first row, last row, first column, last column
+     std::vector<int> tileRange(4 * batch.faceCount);
+
+     #pragma omp parallel for // Parallelize the loop using OpenMP
+     for (long long f = 0; f < faceCount; ++f)
+     {
+         int *range = tileRange.data() + 4 * f;
+         if (batch.faceMask && !batch.faceMask[f])
+         {
+             range[0] = 0, range[1] = -1, range[2] = 0, range[3] = -1; // Masked out: not even its vertices are read
+             continue;
+         }
+
+         const float *v[3] = {batch.vertices + 3 * batch.indices[3 * f], batch.vertices + 3 * batch.indices[3 * f + 1],
+                              batch.vertices + 3 * batch.indices[3 * f + 2]};
+         float minRow = std::max(0.0f, std::min({v[0][0], v[1][0], v[2][0]}));
+         float maxRow = std::min(height - 1.0f, std::max({v[0][0], v[1][0], v[2][0]}));
+         float minCol = std::max(0.0f, std::min({v[0][1], v[1][1], v[2][1]}));
+         float maxCol = std::min(width - 1.0f, std::max({v[0][1], v[1][1], v[2][1]}));
+
+         // Skip faces that are off the canvas or not a number
+         if (!(minRow <= maxRow && minCol <= maxCol))
+         {
+             range[0] = 0, range[1] = -1, range[2] = 0, range[3] = -1;
+             continue;
+         }
+         range[0] = static_cast<int>(minRow) / kTileSize;
+         range[1] = static_cast<int>(maxRow) / kTileSize;
+         range[2] = static_cast<int>(minCol) / kTileSize;
+         range[3] = static_cast<int>(maxCol) / kTileSize;
+     }
+
+     // Counting sort of the faces by tile, so the faces of each tile are contiguous and in drawing order
+     std::vector<size_t> tileStart(tileRows * tileCols + 1, 0);
+     for (size_t f = 0; f < batch.faceCount; ++f)
+     {
+         const int *range = tileRange.data() + 4 * f;
+         for (int tr = range[0]; tr <= range[1]; ++tr)
+             for (int tc = range[2]; tc <= range[3]; ++tc)
+                 ++tileStart[tr * tileCols + tc + 1];
+     }
+     for (size_t t = 1; t < tileStart.size(); ++t)
+     {
+         tileStart[t] += tileStart[t - 1];
+     }
+
+     std::vector<uint32_t> tileFaces(tileStart.back());
+     std::vector<size_t> fill(tileStart.begin(), tileStart.end() - 1);
+     for (size_t k = 0; k < batch.faceCount; ++k)
+     {
+         const size_t f = batch.order ? batch.order[k] : k;
+         const int *range = tileRange.data() + 4 * f;
+         for (int tr = range[0]; tr <= range[1]; ++tr)
+             for (int tc = range[2]; tc <= range[3]; ++tc)
+                 tileFaces[fill[tr * tileCols + tc]++] = static_cast<uint32_t>(f);
+     }
+
+     long long faceTiles = 0, occluded = 0, written = 0, shaded = 0;
+
+     #pragma omp parallel for schedule(dynamic) reduction(+ : faceTiles, occluded, written, shaded) // Tiles differ a lot in cost, so hand them out one at a time
+     for (int t = 0; t < tileRows * tileCols; ++t)
+     {
+         const int rowBegin = (t / tileCols) * kTileSize, colBegin = (t % tileCols) * kTileSize;
+         const int rowEnd = std::min(rowBegin + kTileSize, height), colEnd = std::min(colBegin + kTileSize, width);
+
+         TileDepthBlocks depthBlocks(canvas, rowBegin, rowEnd, colBegin, colEnd);
+         uint32_t visibleFaces[kTileSize * kTileSize]; // With deferred shading: the face that last won each pixel
+         if (batch.deferShading)
+         {
+             std::fill(visibleFaces, visibleFaces + kTileSize * kTileSize, kNoFace);
+         }
+
+         for (size_t k = tileStart[t]; k < tileStart[t + 1]; ++k)
+         {
+             const uint32_t f = tileFaces[k];
+             const uint32_t *face = batch.indices + 3 * f;
+
+             TriangleSetup setup;
+             if (!setupTriangle(batch.vertices + 3 * face[0], batch.vertices + 3 * face[1], batch.vertices + 3 * face[2],
+                                rowBegin, rowEnd, colBegin, colEnd, setup))
+             {
+                 continue;
+             }
+             ++faceTiles;
+
+             if (batch.cullOccluded && depthBlocks.hides(setup))
+             {
+                 ++occluded;
+                 continue;
+             }
+
+             if (batch.deferShading)
+             {
+                 scanTriangle(setup, [&](int i, int j, float depth)
+                 {
+                     if (canvas.putDepth(i, j, static_cast<int>(depth)))
+                     {
+                         visibleFaces[(i - rowBegin) * kTileSize + (j - colBegin)] = f;
+                         ++written;
+                     }
+                 });
+             }
+             else
+             {
+                 const uint32_t color = batch.colors[batch.sharedColor ? 0 : f];
+                 scanTriangle(setup, [&](int i, int j, float depth)
+                 {
+                     canvas.putPixel(i, j, static_cast<int>(depth), color);
+                 });
+             }
+
+             if (batch.cullOccluded)
+             {
+                 depthBlocks.draw(setup);
+             }
+         }
+
+         depthBlocks.finish();
+
+         if (batch.deferShading)
+         {
+             shaded += resolveTile(canvas, batch, visibleFaces, rowBegin, rowEnd, colBegin, colEnd);
+         }
+     }
+
+     RasterStats stats = {static_cast<size_t>(faceTiles), static_cast<size_t>(occluded)};
+     stats.pixelsWritten = static_cast<size_t>(written);
+     stats.pixelsShaded = static_cast<size_t>(shaded);
+     return stats;
+ }
@@ -0,0 +1,480 @@
+/**
+ * @file simplify.cpp
+ * @brief This file contains the quadric error mesh simplification that builds levels of detail.
+ *
+ * Each vertex carries a quadric: the sum of the squared distances to the planes of the faces around it
+ * (Garland and Heckbert). Collapsing an edge merges its two vertices into one, placed where the sum of their
+ * quadrics is smallest among the two ends and the midpoint, and the new vertex inherits the summed quadric.
+ * The quadric of a vertex thus keeps measuring the distance to every original face it stands in for, however
+ * many collapses it took to get there. Edges are collapsed cheapest first from a priority queue; an entry is
+ * dropped when one of its vertices has since moved, and an edge is pushed again with its new cost instead.
+ *
+ * The levels of a chain are snapshots of a single run, so each level is a simplification of the one before.
+ * A level's error is the root mean square distance of a merged vertex to the planes it stands in for, the
+ * largest over the collapses so far. The plain square root of the cost would be a strict bound on the distance
+ * to each plane, but it also grows with the number of planes, which overstates the error of coarse levels
+ * many times over.
+ * Open edges get an extra plane at right angles to their face, so the border of an open mesh does not shrink.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <algorithm>
+ #include <cmath>
+ #include <cstdint>
+ #include <functional>
+ #include <limits>
+ #include <queue>
+ #include <vector>
+ #include "simplify.h"
+
+ namespace
+ {
+     /**
+      * @brief Symmetric 4x4 matrix giving the sum of the squared distances of a point to a set of planes.
+      */
+     struct Quadric
+     {
+         double aa = 0, ab = 0, ac = 0, ad = 0, bb = 0, bc = 0, bd = 0, cc = 0, cd = 0, dd = 0;
+         double planes = 0; // Number of planes summed
+
+         // Adds the plane a x + b y + c z + d = 0, whose normal (a, b, c) has unit length
+         void addPlane(double a, double b, double c, double d)
+         {
+             aa += a * a; ab += a * b; ac += a * c; ad += a * d;
+             bb += b * b; bc += b * c; bd += b * d;
+             cc += c * c; cd += c * d;
+             dd += d * d;
+             planes += 1;
+         }
+
+         Quadric &operator+=(const Quadric &q)
+         {
+             aa += q.aa; ab += q.ab; ac += q.ac; ad += q.ad;
+             bb += q.bb; bc += q.bc; bd += q.bd;
+             cc += q.cc; cd += q.cd;
+             dd += q.dd;
+             planes += q.planes;
+             return *this;
+         }
+
+         // Sum of the squared distances of the point p to the planes
+         double evaluate(const double *p) const
+         {
+             const double x = p[0], y = p[1], z = p[2];
+             return aa * x * x + bb * y * y + cc * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) +
+                    2.0 * (ad * x + bd * y + cd * z) + dd;
+         }
+     };
+
+     /**
+      * @brief An edge waiting in the queue, with the stamps its vertices had when its cost was computed.
+      */
+     struct Candidate
+     {
+         double cost;
+         uint32_t keep, remove;           // The vertex that moves to the merged position and the one that goes
+         uint32_t keepStamp, removeStamp;
+
+         bool operator>(const Candidate &other) const
+         {
+             return cost > other.cost || (cost == other.cost && (keep > other.keep || (keep == other.keep && remove > other.remove)));
+         }
+     };
+
+     /**
+      * @brief Collapses the edges of a mesh, cheapest first, and extracts the current state as a new mesh.
+      */
+     class Simplifier
+     {
+     public:
+         explicit Simplifier(const Mesh &mesh);
+
+         bool simplifyTo(size_t targetFaces);
+         Mesh extract() const;
+
+         size_t faceCount() const { return liveFaces; }
+         float error() const { return static_cast<float>(std::sqrt(worstError)); }
+
+     private:
+         double mergedPosition(uint32_t a, uint32_t b, double *p) const;
+         void pushEdge(uint32_t a, uint32_t b);
+         bool flipsFace(uint32_t v, uint32_t other, const double *p) const;
+         void collapse(uint32_t keep, uint32_t remove, const double *p);
+         void faceNormal(uint32_t f, uint32_t moved, const double *p, double *normal) const;
+
+         const Mesh &source;
+         std::vector<double> position;                   // Current x, y and z of every vertex
+         std::vector<Quadric> quadrics;                  // Quadric of every vertex
+         std::vector<uint32_t> stamps;                   // Bumped whenever a vertex moves or goes
+         std::vector<uint8_t> removed;                   // Whether a vertex has been merged into another
+         std::vector<std::vector<uint32_t>> vertexFaces; // Faces around every vertex, including some that went since
+         std::vector<uint32_t> indices;                  // Current three vertices of every face
+         std::vector<uint8_t> faceLive;                  // Whether a face still has three distinct vertices
+         size_t liveFaces;
+         double worstError = 0.0;                        // Largest mean squared distance of a merged vertex so far
+         std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+     };
+
+     /**
+      * @brief Sets up the quadric of every vertex and queues every edge of the mesh.
+      */
+     Simplifier::Simplifier(const Mesh &mesh)
+         : source(mesh), position(3 * mesh.vertexCount()), quadrics(mesh.vertexCount()), stamps(mesh.vertexCount(), 0),
+           removed(mesh.vertexCount(), 0), vertexFaces(mesh.vertexCount()), indices(mesh.indices),
+           faceLive(mesh.faceCount(), 1), liveFaces(mesh.faceCount())
+     {
+         for (size_t v = 0; v < mesh.vertexCount(); ++v)
+         {
+             position[3 * v] = mesh.x[v];
+             position[3 * v + 1] = mesh.y[v];
+             position[3 * v + 2] = mesh.z[v];
+         }
+
+         // Every edge of every face, keyed by its two vertices, smaller index first
+         std::vector<std::pair<uint64_t, uint32_t>> edges;
+         edges.reserve(indices.size());
+         for (uint32_t f = 0; f < mesh.faceCount(); ++f)
+         {
+             const uint32_t *face = indices.data() + 3 * f;
+             if (face[0] == face[1] || face[1] == face[2] || face[2] == face[0])
+             {
+                 faceLive[f] = 0; // Welded into a line or a point; it draws nothing
+                 --liveFaces;
+                 continue;
+             }
+
+             double normal[3];
+             faceNormal(f, UINT32_MAX, nullptr, normal);
+             const double size = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+             if (size > 0.0)
+             {
+                 const double *p = position.data() + 3 * face[0];
+                 const double a = normal[0] / size, b = normal[1] / size, c = normal[2] / size;
+                 Quadric plane;
+                 plane.addPlane(a, b, c, -(a * p[0] + b * p[1] + c * p[2]));
+                 for (int k = 0; k < 3; ++k)
+                 {
+                     quadrics[face[k]] += plane;
+                 }
+             }
+
+             for (int k = 0; k < 3; ++k)
+             {
+                 vertexFaces[face[k]].push_back(f);
+                 const uint64_t u = face[k], w = face[(k + 1) % 3];
+                 edges.push_back({std::min(u, w) << 32 | std::max(u, w), f});
+             }
+         }
+         std::sort(edges.begin(), edges.end());
+
+         for (size_t begin = 0, end; begin < edges.size(); begin = end)
+         {
+             end = begin + 1;
+             while (end < edges.size() && edges[end].first == edges[begin].first)
+             {
+                 ++end;
+             }
+             const uint32_t a = static_cast<uint32_t>(edges[begin].first >> 32);
+             const uint32_t b = static_cast<uint32_t>(edges[begin].first);
+
+             // An open edge: add the plane through it at right angles to its face to both its vertices
+             double normal[3];
+             faceNormal(edges[begin].second, UINT32_MAX, nullptr, normal);
+             if (end - begin == 1)
+             {
+                 const double *p = position.data() + 3 * a, *q = position.data() + 3 * b;
+                 const double e[3] = {q[0] - p[0], q[1] - p[1], q[2] - p[2]};
+                 double m[3] = {e[1] * normal[2] - e[2] * normal[1], e[2] * normal[0] - e[0] * normal[2],
+                                e[0] * normal[1] - e[1] * normal[0]};
+                 const double size = std::sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+                 if (size > 0.0)
+                 {
+                     Quadric plane;
+                     plane.addPlane(m[0] / size, m[1] / size, m[2] / size, -(m[0] * p[0] + m[1] * p[1] + m[2] * p[2]) / size);
+                     quadrics[a] += plane;
+                     quadrics[b] += plane;
+                 }
+             }
+         }
+
+         for (size_t k = 0; k < edges.size(); ++k)
+         {
+             if (k == 0 || edges[k].first != edges[k - 1].first)
+             {
+                 const uint32_t a = static_cast<uint32_t>(edges[k].first >> 32);
+                 pushEdge(a, static_cast<uint32_t>(edges[k].first));
+             }
+         }
+     }
+
+     /**
+      * @brief Computes the (unnormalized) normal of a face, optionally with one of its vertices moved to p.
+      */
+     void Simplifier::faceNormal(uint32_t f, uint32_t moved, const double *p, double *normal) const
+     {
+         const double *corner[3];
+         for (int k = 0; k < 3; ++k)
+         {
+             const uint32_t v = indices[3 * f + k];
+             corner[k] = v == moved ? p : position.data() + 3 * v;
+         }
+         const double e1[3] = {corner[1][0] - corner[0][0], corner[1][1] - corner[0][1], corner[1][2] - corner[0][2]};
+         const double e2[3] = {corner[2][0] - corner[0][0], corner[2][1] - corner[0][1], corner[2][2] - corner[0][2]};
+         normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+         normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+         normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+     }
+
+     /**
+      * @brief Picks where the merged vertex of an edge goes: whichever of its two ends and its midpoint is
+      * closest to the planes of both vertices.
+      *
+      * @return The sum of the squared distances of that point to the planes.
+      */
+     double Simplifier::mergedPosition(uint32_t a, uint32_t b, double *p) const
+     {
+         Quadric q = quadrics[a];
+         q += quadrics[b];
+
+         const double *pa = position.data() + 3 * a, *pb = position.data() + 3 * b;
+         const double mid[3] = {(pa[0] + pb[0]) * 0.5, (pa[1] + pb[1]) * 0.5, (pa[2] + pb[2]) * 0.5};
+         double best = std::numeric_limits<double>::max();
+         for (const double *candidate : {mid, pa, pb})
+         {
+             const double cost = std::max(0.0, q.evaluate(candidate));
+             if (cost < best)
+             {
+                 best = cost;
+                 std::copy(candidate, candidate + 3, p);
+             }
+         }
+         return best;
+     }
+
+     /**
+      * @brief Queues the collapse of the edge between two vertices at its current cost.
+      */
+     void Simplifier::pushEdge(uint32_t a, uint32_t b)
+     {
+         double p[3];
+         queue.push({mergedPosition(a, b, p), a, b, stamps[a], stamps[b]});
+     }
+
+     /**
+      * @brief Checks whether moving vertex v to p would turn any face around it that does not also hold `other`
+      * (those faces go) more than a right angle.
+      */
+     bool Simplifier::flipsFace(uint32_t v, uint32_t other, const double *p) const
+     {
+         for (uint32_t f : vertexFaces[v])
+         {
+             const uint32_t *face = indices.data() + 3 * f;
+             if (!faceLive[f] || face[0] == other || face[1] == other || face[2] == other)
+             {
+                 continue;
+             }
+             double before[3], after[3];
+             faceNormal(f, UINT32_MAX, nullptr, before);
+             faceNormal(f, v, p, after);
+             if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+             {
+                 return true;
+             }
+         }
+         return false;
+     }
+
+     /**
+      * @brief Merges vertex `remove` into vertex `keep`, moved to p, dropping the faces that held both.
+      */
+     void Simplifier::collapse(uint32_t keep, uint32_t remove, const double *p)
+     {
+         std::copy(p, p + 3, position.begin() + 3 * keep);
+         quadrics[keep] += quadrics[remove];
+         removed[remove] = 1;
+         ++stamps[keep];
+         ++stamps[remove];
+
+         for (uint32_t f : vertexFaces[remove])
+         {
+             uint32_t *face = indices.data() + 3 * f;
+             if (!faceLive[f])
+             {
+                 continue; // Dropped by an earlier collapse; the lists of its other vertices are pruned lazily
+             }
+             if (face[0] == keep || face[1] == keep || face[2] == keep)
+             {
+                 faceLive[f] = 0;
+                 --liveFaces;
+             }
+             else
+             {
+                 std::replace(face, face + 3, remove, keep);
+                 vertexFaces[keep].push_back(f);
+             }
+         }
+         std::vector<uint32_t>().swap(vertexFaces[remove]);
+
+         std::vector<uint32_t> &faces = vertexFaces[keep];
+         faces.erase(std::remove_if(faces.begin(), faces.end(), [this](uint32_t f) { return !faceLive[f]; }), faces.end());
+
+         // The edges from the merged vertex have new costs
+         std::vector<uint32_t> neighbors;
+         for (uint32_t f : faces)
+         {
+             for (int k = 0; k < 3; ++k)
+             {
+                 if (indices[3 * f + k] != keep)
+                 {
+                     neighbors.push_back(indices[3 * f + k]);
+                 }
+             }
+         }
+         std::sort(neighbors.begin(), neighbors.end());
+         neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+         for (uint32_t n : neighbors)
+         {
+             pushEdge(keep, n);
+         }
+     }
+
+     /**
+      * @brief Collapses edges, cheapest first, until at most targetFaces faces are left.
+      *
+      * @return False if the queue ran out first: every remaining edge would flip a face.
+      */
+     bool Simplifier::simplifyTo(size_t targetFaces)
+     {
+         while (liveFaces > targetFaces)
+         {
+             if (queue.empty())
+             {
+                 return false;
+             }
+             const Candidate candidate = queue.top();
+             queue.pop();
+             if (removed[candidate.keep] || removed[candidate.remove] || stamps[candidate.keep] != candidate.keepStamp ||
+                 stamps[candidate.remove] != candidate.removeStamp)
+             {
+                 continue; // Stale: a vertex moved or went since the edge was queued
+             }
+
+             double p[3];
+             const double cost = mergedPosition(candidate.keep, candidate.remove, p);
+             if (flipsFace(candidate.keep, candidate.remove, p) || flipsFace(candidate.remove, candidate.keep, p))
+             {
+                 continue; // Queued again if a neighboring collapse changes the faces around it
+             }
+             const double planes = quadrics[candidate.keep].planes + quadrics[candidate.remove].planes;
+             if (planes > 0.0)
+             {
+                 worstError = std::max(worstError, cost / planes);
+             }
+             collapse(candidate.keep, candidate.remove, p);
+         }
+         return true;
+     }
+
+     /**
+      * @brief Builds a mesh from the live faces, in their original order, and the vertices they use.
+      *
+      * Faces keep their original color. Their normal is recomputed from the moved vertices, pointing to the
+      * same side as the original face's normal.
+      */
+     Mesh Simplifier::extract() const
+     {
+         Mesh mesh;
+         std::vector<uint32_t> remap(removed.size(), UINT32_MAX);
+         for (uint32_t f = 0; f < faceLive.size(); ++f)
+         {
+             if (faceLive[f])
+             {
+                 for (int k = 0; k < 3; ++k)
+                 {
+                     remap[indices[3 * f + k]] = 0;
+                 }
+             }
+         }
+         for (uint32_t v = 0; v < remap.size(); ++v)
+         {
+             if (remap[v] == 0)
+             {
+                 remap[v] = static_cast<uint32_t>(mesh.x.size());
+                 mesh.x.push_back(static_cast<float>(position[3 * v]));
+                 mesh.y.push_back(static_cast<float>(position[3 * v + 1]));
+                 mesh.z.push_back(static_cast<float>(position[3 * v + 2]));
+             }
+         }
+
+         const bool hasNormals = source.normals.size() == 3 * source.faceCount();
+         mesh.indices.reserve(3 * liveFaces);
+         mesh.colors.reserve(liveFaces);
+         mesh.normals.reserve(3 * liveFaces);
+         for (uint32_t f = 0; f < faceLive.size(); ++f)
+         {
+             if (!faceLive[f])
+             {
+                 continue;
+             }
+             for (int k = 0; k < 3; ++k)
+             {
+                 mesh.indices.push_back(remap[indices[3 * f + k]]);
+             }
+             mesh.colors.push_back(source.colors[f]);
+
+             double normal[3];
+             faceNormal(f, UINT32_MAX, nullptr, normal);
+             double size = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+             if (hasNormals && normal[0] * source.normals[3 * f] + normal[1] * source.normals[3 * f + 1] +
+                               normal[2] * source.normals[3 * f + 2] < 0.0)
+             {
+                 size = -size;
+             }
+             for (int k = 0; k < 3; ++k)
+             {
+                 mesh.normals.push_back(size != 0.0 ? static_cast<float>(normal[k] / size) : 0.0f);
+             }
+         }
+         return mesh;
+     }
+ }
+
+ /**
+  * @brief Builds a chain of ever coarser levels of detail of a mesh.
+  *
+  * The mesh is simplified in a single run, taking a snapshot each time the face count falls to the next target.
+  *
+  * @param mesh The full mesh.
+  * @param ratio The largest fraction of the previous level's faces a level may keep.
+  * @param minFaces The fewest faces a level may have.
+  * @return The levels, finest first; the full mesh itself is not among them.
+  */
+ std::vector<MeshLod> buildLodChain(const Mesh &mesh, float ratio, size_t minFaces)
+ {
+     std::vector<MeshLod> lods;
+     if (mesh.faceCount() == 0 || !(ratio > 0.0f && ratio < 1.0f))
+     {
+         return lods;
+     }
+
+     Simplifier simplifier(mesh);
+     size_t previous = mesh.faceCount();
+     for (size_t target = static_cast<size_t>(previous * ratio); target >= minFaces && target > 0;
+          target = static_cast<size_t>(previous * ratio))
+     {
+         const bool reached = simplifier.simplifyTo(target);
+         if (simplifier.faceCount() >= previous)
+         {
+             break;
+         }
+         lods.push_back({simplifier.extract(), simplifier.error()});
+         previous = simplifier.faceCount();
+         if (!reached)
+         {
+             break;
+         }
+     }
+     return lods;
+ }
@@ -2,23 +2,172 @@
  * @file stl.cpp
  * @brief This file contains functions for reading and processing STL files.
  * 
- * The file includes functions to generate random colors and read triangle data from an STL file.
- * The triangles are stored in a shared pointer to a vector of TriangleSurface objects, and each
- * triangle is assigned a color for rendering purposes.
+ * The file includes functions to generate random colors and read triangle data from ASCII and binary
+ * STL files. The faces are read into a triangle soup (flat vertex coordinates plus one color per face),
+ * from which indexed meshes or TriangleSurface objects are built. Binary files are memory-mapped and their
+ * facet records are decoded in place; ASCII files are parsed in parallel chunks.
  * 
  * @author Ben Benyamin
  * @date March 2025
  */
 
  #include <iostream>
- #include <fstream>
- #include <sstream>
  #include <vector>
+ #include <algorithm>
+ #include <charconv>
  #include <cstdlib>
  #include <ctime>
+ #include <cstdint>
+ #include <cstring>
  #include <memory> // for std::shared_ptr
+ #include <string_view>
+ #include <omp.h> // OpenMP for parallel processing
  #include "TriangleSurface.h"
  #include "Canvas.h"
+ #include "mapped_file.h"
+ #include "stl.h"
+
+ namespace
+ {
+     constexpr size_t kBinaryHeaderSize = 80;                // Free-form header at the start of a binary STL
+     constexpr size_t kBinaryPreambleSize = kBinaryHeaderSize + sizeof(uint32_t); // Header plus facet count
+     constexpr size_t kBinaryFacetSize = 50;                 // normal + 3 vertices (12 floats) + attribute word
+
+     /**
+      * @brief Assigns the face colors of a triangle soup: a new random color every 1000th face.
+      *
+      * Each soup gets a freshly seeded generator of its own, so the colors only depend on the face order, even
+      * when several files are read at the same time.
+      *
+      * @param soup The soup whose colors are filled in, one RGB triple per face.
+      */
+     void assignFaceColors(TriangleSoup &soup)
+     {
+         RandomSequence random(0); // Same colors as rand() after srand(0) gave when the generator was global
+
+         const size_t faceCount = soup.size();
+         std::vector<float> color = {0.0f, 1.0f, 1.0f}; // Default color (cyan)
+         soup.colors.resize(3 * faceCount);
+
+         for (size_t face = 0; face < faceCount; ++face)
+         {
+             // Assign a random color to every 1000th face
+             if (face % 1000 == 0)
+             {
+                 color = getRandomColor(random); // Generate random color
+             }
+             std::copy(color.begin(), color.end(), soup.colors.begin() + 3 * face);
+         }
+     }
+
+     constexpr size_t kMinChunkSize = 1 << 20; // Smallest ASCII chunk worth handing to its own thread
+
+     /**
+      * @brief Returns true for the whitespace characters that separate ASCII STL tokens.
+      */
+     inline bool isSpace(char c)
+     {
+         return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v';
+     }
+
+     /**
+      * @brief Parses one float token, skipping leading whitespace and an optional '+' sign.
+      *
+      * @param p The current position; advanced past the number on success.
+      * @param end The end of the buffer.
+      * @param value Receives the parsed value.
+      * @return True if a number was parsed.
+      */
+     inline bool parseFloat(const char *&p, const char *end, float &value)
+     {
+         while (p < end && (*p == ' ' || *p == '\t'))
+             ++p;
+         if (p < end && *p == '+')
+             ++p;
+
+         auto result = std::from_chars(p, end, value);
+         if (result.ec != std::errc())
+             return false;
+
+         p = result.ptr;
+         return true;
+     }
+
+     /**
+      * @brief Parses the facets of an ASCII STL chunk into flat lists of coordinates and normals.
+      *
+      * Every three consecutive `vertex` lines form one face; a vertex line that fails to parse is skipped,
+      * like the line-based reader did. The coordinates of each face are appended as nine floats, and the
+      * normal from its `facet normal` line as three, or zeros if that line has none.
+      *
+      * @param chunk The text of the chunk.
+      * @param coords Receives the coordinates of the parsed faces.
+      * @param normals Receives the facet normals of the parsed faces.
+      */
+     void parseAsciiChunk(std::string_view chunk, std::vector<float> &coords, std::vector<float> &normals)
+     {
+         const char *p = chunk.data();
+         const char *end = p + chunk.size();
+         float face[9];
+         float normal[3] = {0.0f, 0.0f, 0.0f};
+         int vertexCount = 0;
+
+         coords.reserve(chunk.size() / 40); // Roughly 250 bytes of text per face
+         normals.reserve(chunk.size() / 120);
+
+         while (p < end)
+         {
+             // Skip to the first token of the line
+             while (p < end && isSpace(*p))
+                 ++p;
+
+             const char *lineEnd = static_cast<const char *>(std::memchr(p, '\n', end - p));
+             if (lineEnd == nullptr)
+                 lineEnd = end;
+
+             if (lineEnd - p > 6 && std::memcmp(p, "vertex", 6) == 0 && isSpace(p[6]))
+             {
+                 const char *q = p + 6;
+                 float *v = face + 3 * vertexCount;
+
+                 if (parseFloat(q, lineEnd, v[0]) && parseFloat(q, lineEnd, v[1]) && parseFloat(q, lineEnd, v[2]))
+                 {
+                     if (++vertexCount == 3)
+                     {
+                         coords.insert(coords.end(), face, face + 9);
+                         normals.insert(normals.end(), normal, normal + 3);
+                         vertexCount = 0;
+                     }
+                 }
+             }
+             else if (lineEnd - p > 5 && std::memcmp(p, "facet", 5) == 0 && isSpace(p[5]))
+             {
+                 const char *q = p + 5;
+                 while (q < lineEnd && isSpace(*q))
+                     ++q;
+
+                 float parsed[3];
+                 bool hasNormal = lineEnd - q > 6 && std::memcmp(q, "normal", 6) == 0 && isSpace(q[6]);
+                 if (hasNormal)
+                 {
+                     q += 6;
+                     hasNormal = parseFloat(q, lineEnd, parsed[0]) && parseFloat(q, lineEnd, parsed[1]) &&
+                                 parseFloat(q, lineEnd, parsed[2]);
+                 }
+                 for (int axis = 0; axis < 3; ++axis)
+                 {
+                     normal[axis] = hasNormal ? parsed[axis] : 0.0f; // A missing normal is computed later
+                 }
+             }
+             else if (lineEnd - p >= 7 && std::memcmp(p, "endloop", 7) == 0)
+             {
+                 vertexCount = 0; // A loop never carries vertices over into the next facet
+             }
+
+             p = lineEnd;
+         }
+     }
+ }
  
  /**
   * @brief Generates a random color as a vector of three floats (RGB).
@@ -32,70 +181,252 @@
              static_cast<float>(rand()) / RAND_MAX, 
              static_cast<float>(rand()) / RAND_MAX};
  }
+
+ /**
+  * @brief Generates a random color from a sequence of its own rather than the global generator.
+  *
+  * @param random The sequence the three components are drawn from, in red, green, blue order.
+  * @return A vector containing three floats representing the RGB color.
+  */
+ std::vector<float> getRandomColor(RandomSequence &random)
+ {
+     const float red = static_cast<float>(random.next()) / RandomSequence::kMax;
+     const float green = static_cast<float>(random.next()) / RandomSequence::kMax;
+     const float blue = static_cast<float>(random.next()) / RandomSequence::kMax;
+     return {red, green, blue};
+ }
+
+ /**
+  * @brief Seeds the sequence the way srandom() does in the GNU C library.
+  *
+  * The state is filled from a Park-Miller generator started at the seed (1 if it is 0), and the first 310
+  * numbers are dropped.
+  *
+  * @param seed The seed, as passed to srand().
+  */
+ RandomSequence::RandomSequence(uint32_t seed)
+ {
+     int32_t word = seed == 0 ? 1 : static_cast<int32_t>(seed);
+     state[0] = static_cast<uint32_t>(word);
+     for (int k = 1; k < 31; ++k)
+     {
+         // 16807 * word mod (2^31 - 1), without overflowing 32 bits
+         const int32_t hi = word / 127773;
+         const int32_t lo = word % 127773;
+         word = 16807 * lo - 2836 * hi;
+         if (word < 0)
+             word += kMax;
+         state[k] = static_cast<uint32_t>(word);
+     }
+     for (int k = 0; k < 310; ++k)
+     {
+         next();
+     }
+ }
+
+ /**
+  * @brief Returns the next number of the sequence.
+  *
+  * @return A number from 0 to kMax.
+  */
+ int32_t RandomSequence::next()
+ {
+     state[front] += state[rear]; // Wraps around, as in the GNU C library
+     const int32_t result = static_cast<int32_t>(state[front] >> 1);
+     front = front == 30 ? 0 : front + 1;
+     rear = rear == 30 ? 0 : rear + 1;
+     return result;
+ }
  
  /**
-  * @brief Reads triangle data from an STL file and stores it in a vector of TriangleSurface objects.
+  * @brief Checks whether a buffer holds a binary STL file.
   * 
-  * This function reads an ASCII STL file, extracts vertex data for each triangle, and assigns a color
-  * to the triangle. The triangles are stored in a shared pointer to a vector of TriangleSurface objects.
+  * A binary STL is an 80-byte header, a 32-bit facet count and 50 bytes per facet. A file whose header does
+  * not start with "solid" is binary as long as it holds every facet its count promises; some writers pad the
+  * file or append data after the last record, which is ignored. Many exporters also start the header of
+  * binary files with "solid", so such a file is only taken as binary if its size matches the count exactly.
+  * 
+  * @param data Pointer to the file contents.
+  * @param size The size of the file in bytes.
+  * @return True if the buffer is a binary STL file, false if it should be parsed as ASCII.
+  */
+ bool isBinarySTL(const char *data, size_t size)
+ {
+     if (data == nullptr || size < kBinaryPreambleSize)
+     {
+         return false;
+     }
+
+     uint32_t facetCount;
+     std::memcpy(&facetCount, data + kBinaryHeaderSize, sizeof(facetCount));
+     const size_t expectedSize = kBinaryPreambleSize + static_cast<size_t>(facetCount) * kBinaryFacetSize;
+
+     if (std::memcmp(data, "solid", 5) == 0)
+     {
+         return size == expectedSize;
+     }
+     return size >= expectedSize;
+ }
+
+ /**
+  * @brief Returns the number of faces in the soup.
+  * 
+  * @return The number of faces.
+  */
+ size_t TriangleSoup::size() const { return vertices.size() / 9; }
+
+ /**
+  * @brief Decodes the facet records of a binary STL file into a triangle soup.
+  * 
+  * The vertex coordinates are copied straight out of the records, so no intermediate text or line storage
+  * is involved. Colors follow the same every-1000th-face scheme as the ASCII reader. The buffer must already
+  * have been validated with `isBinarySTL`. The number of facets is taken from the header, so bytes after the
+  * last record are ignored.
+  * 
+  * @param data Pointer to the file contents.
+  * @param size The size of the file in bytes.
+  * @param soup The soup receiving the faces.
+  */
+ void readBinarySTL(const char *data, size_t size, TriangleSoup &soup)
+ {
+     uint32_t headerCount;
+     std::memcpy(&headerCount, data + kBinaryHeaderSize, sizeof(headerCount));
+     const long long facetCount = static_cast<long long>(
+         std::min<size_t>(headerCount, (size - kBinaryPreambleSize) / kBinaryFacetSize)); // Never past the buffer
+     const char *records = data + kBinaryPreambleSize;
+
+     soup.vertices.resize(9 * facetCount);
+     soup.normals.resize(3 * facetCount);
+
+     #pragma omp parallel for // Decode the records in parallel using OpenMP
+     for (long long face = 0; face < facetCount; ++face)
+     {
+         // Copy the 12-byte facet normal, then the three vertices
+         const char *record = records + face * kBinaryFacetSize;
+         std::memcpy(soup.normals.data() + 3 * face, record, 3 * sizeof(float));
+         std::memcpy(soup.vertices.data() + 9 * face, record + 12, 9 * sizeof(float));
+     }
+
+     assignFaceColors(soup);
+ }
+
+ /**
+  * @brief Parses an ASCII STL buffer into a triangle soup using several threads.
+  * 
+  * The buffer is split into chunks that end right after an `endfacet` line, so no facet straddles two
+  * chunks. Each chunk is parsed on its own thread with `std::from_chars`, and the chunks are merged back
+  * in file order. Colors are assigned after the merge, so every face gets the same color as it would
+  * from a sequential read.
+  * 
+  * @param data Pointer to the file contents.
+  * @param size The size of the file in bytes.
+  * @param soup The soup receiving the faces.
+  * @param chunkCount The number of chunks to split the buffer into, or 0 to pick one from the thread count.
+  */
+ void readAsciiSTL(const char *data, size_t size, TriangleSoup &soup, int chunkCount)
+ {
+     if (chunkCount <= 0)
+     {
+         // A few chunks per thread balances uneven chunks, but keep each chunk large enough to be worth a task
+         size_t bySize = size / kMinChunkSize + 1;
+         chunkCount = static_cast<int>(std::min<size_t>(bySize, static_cast<size_t>(omp_get_max_threads()) * 4));
+     }
+
+     // Place the chunk boundaries just after an endfacet line
+     std::string_view text(data, size);
+     std::vector<size_t> bounds(chunkCount + 1, size);
+     bounds[0] = 0;
+     for (int k = 1; k < chunkCount; ++k)
+     {
+         size_t nominal = std::max(bounds[k - 1], size / chunkCount * k);
+         size_t pos = text.find("endfacet", nominal);
+         pos = (pos == std::string_view::npos) ? std::string_view::npos : text.find('\n', pos);
+         bounds[k] = (pos == std::string_view::npos) ? size : pos + 1;
+     }
+
+     // Parse every chunk into flat lists of vertex coordinates and normals, nine and three floats per face
+     std::vector<std::vector<float>> chunkCoords(chunkCount), chunkNormals(chunkCount);
+
+     #pragma omp parallel for schedule(dynamic) // Parse the chunks in parallel using OpenMP
+     for (int k = 0; k < chunkCount; ++k)
+     {
+         parseAsciiChunk(text.substr(bounds[k], bounds[k + 1] - bounds[k]), chunkCoords[k], chunkNormals[k]);
+     }
+
+     // Offsets of the chunks in the merged coordinates
+     std::vector<size_t> offsets(chunkCount + 1, 0);
+     for (int k = 0; k < chunkCount; ++k)
+     {
+         offsets[k + 1] = offsets[k] + chunkCoords[k].size();
+     }
+
+     // Merge the chunks in file order
+     soup.vertices.resize(offsets[chunkCount]);
+     soup.normals.resize(offsets[chunkCount] / 3);
+
+     #pragma omp parallel for // Copy the chunks in parallel using OpenMP
+     for (int k = 0; k < chunkCount; ++k)
+     {
+         std::copy(chunkCoords[k].begin(), chunkCoords[k].end(), soup.vertices.begin() + offsets[k]);
+         std::copy(chunkNormals[k].begin(), chunkNormals[k].end(), soup.normals.begin() + offsets[k] / 3);
+     }
+
+     assignFaceColors(soup);
+ }
+
+ /**
+  * @brief Reads the faces of an STL file into a triangle soup.
+  * 
+  * This function memory-maps the file and detects whether it is a binary or an ASCII STL. Binary files are
+  * decoded with `readBinarySTL` and ASCII files with the multi-threaded `readAsciiSTL`.
   * 
   * @param filename The path to the STL file.
-  * @param triangles A shared pointer to a vector of TriangleSurface objects where the triangle data will be stored.
+  * @param soup The soup receiving the faces and their colors.
   */
- void readSTL(const std::string &filename, std::shared_ptr<std::vector<TriangleSurface>> triangles)
+ void readSTL(const std::string &filename, TriangleSoup &soup)
  {
-     srand(0); // Set the seed for random color generation
-     std::ifstream file(filename);
- 
+     MappedFile mapped(filename);
+
      // Check if the file was successfully opened
-     if (!file.is_open())
+     if (!mapped.isOpen())
      {
          std::cerr << "Error: Unable to open STL file " << filename << std::endl;
          return;
      }
- 
-     std::string line;
-     std::vector<float> A(3), B(3), C(3); // Vectors to store vertex coordinates
-     std::vector<float> color = {0.0f, 1.0f, 1.0f}; // Default color (cyan)
- 
-     int faceCounter = 0; // Counter to track face pairs
- 
-     // Read the file line by line
-     while (std::getline(file, line))
+
+     if (isBinarySTL(mapped.data(), mapped.size()))
      {
-         std::istringstream iss(line);
-         std::string keyword;
-         iss >> keyword;
- 
-         // Check if the line contains vertex data
-         if (keyword == "vertex")
-         {
-             // Read the coordinates of the first vertex
-             if (!(iss >> A[0] >> A[1] >> A[2]))
-                 continue;
- 
-             // Read the coordinates of the second vertex
-             std::getline(file, line);
-             std::istringstream issB(line);
-             issB >> keyword >> B[0] >> B[1] >> B[2];
- 
-             // Read the coordinates of the third vertex
-             std::getline(file, line);
-             std::istringstream issC(line);
-             issC >> keyword >> C[0] >> C[1] >> C[2];
- 
-             // Assign a random color to every 1000th face
-             if (faceCounter % 1000 == 0)
-             {
-                 color = getRandomColor(); // Generate random color
-             }
- 
-             // Add the triangle to the vector
-             triangles->emplace_back(A, B, C, color);
- 
-             faceCounter++; // Increment the face counter
-         }
+         readBinarySTL(mapped.data(), mapped.size(), soup);
      }
- 
-     file.close(); // Close the file
- }
\ No newline at end of file
+     else
+     {
+         readAsciiSTL(mapped.data(), mapped.size(), soup);
+     }
+ }
+
+ /**
+  * @brief Reads triangle data from an STL file and stores it in a vector of TriangleSurface objects.
+  * 
+  * The file is read into a triangle soup with `readSTL`, and every face becomes one TriangleSurface
+  * with its assigned color.
+  * 
+  * @param filename The path to the STL file.
+  * @param triangles A shared pointer to a vector of TriangleSurface objects where the triangle data will be stored.
+  */
+ void readSTL(const std::string &filename, std::shared_ptr<std::vector<TriangleSurface>> triangles)
+ {
+     TriangleSoup soup;
+     readSTL(filename, soup);
+
+     triangles->reserve(triangles->size() + soup.size());
+
+     for (size_t face = 0; face < soup.size(); ++face)
+     {
+         const float *v = soup.vertices.data() + 9 * face;
+         const float *color = soup.colors.data() + 3 * face;
+
+         // Add the triangle to the vector
+         triangles->emplace_back(Vec3{v[0], v[1], v[2]}, Vec3{v[3], v[4], v[5]}, Vec3{v[6], v[7], v[8]},
+                                 Vec3{color[0], color[1], color[2]});
+     }
+ }
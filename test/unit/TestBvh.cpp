@@ -0,0 +1,145 @@
+/**
+ * @file TestBvh.cpp
+ * @brief This file contains unit tests for the bounding volume hierarchy using the Google Test framework.
+ *
+ * The tests cover the structure of the hierarchy, the bounds of its nodes, marking the faces whose part of the
+ * hierarchy reaches the canvas, and ordering the faces front to back.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <algorithm>
+ #include <vector>
+ #include "bvh.h"
+
+ /**
+  * @brief Test fixture for bounding volume hierarchies.
+  *
+  * This fixture builds a mesh of 64 small triangles in a row along X, from x = -320 to x = 315.
+  */
+ class BvhTest : public ::testing::Test
+ {
+ protected:
+     BvhTest()
+     {
+         TriangleSoup soup;
+         for (int i = 0; i < 64; ++i)
+         {
+             float x = i * 10.0f - 320.0f;
+             soup.vertices.insert(soup.vertices.end(), {x, 0, 0, x + 5, 0, 0, x, 5, 0});
+         }
+         soup.colors.assign(3 * 64, 1.0f);
+         mesh = weldVertices(soup);
+         bvh = buildBvh(mesh, 4);
+     }
+
+     Mesh mesh; // The row of triangles
+     Bvh bvh;   // Its hierarchy, with at most four faces per leaf
+ };
+
+ /**
+  * @brief Tests that every face is in exactly one leaf and every node's box holds its faces.
+  */
+ TEST_F(BvhTest, StructureTest)
+ {
+     ASSERT_FALSE(bvh.nodes.empty());
+     EXPECT_EQ(bvh.nodes[0].first, 0u);
+     EXPECT_EQ(bvh.nodes[0].count, 64u);
+
+     std::vector<int> seen(64, 0);
+     for (size_t n = 0; n < bvh.nodes.size(); ++n)
+     {
+         const BvhNode &node = bvh.nodes[n];
+         if (node.right == 0)
+         {
+             EXPECT_LE(node.count, 4u);
+             for (uint32_t k = node.first; k < node.first + node.count; ++k)
+             {
+                 ++seen[bvh.faces[k]];
+             }
+         }
+         else
+         {
+             // The children split the node's faces between them
+             const BvhNode &left = bvh.nodes[n + 1], &right = bvh.nodes[node.right];
+             EXPECT_EQ(left.first, node.first);
+             EXPECT_EQ(right.first, left.first + left.count);
+             EXPECT_EQ(left.count + right.count, node.count);
+         }
+
+         for (uint32_t k = node.first; k < node.first + node.count; ++k)
+         {
+             for (int corner = 0; corner < 3; ++corner)
+             {
+                 uint32_t v = mesh.indices[3 * bvh.faces[k] + corner];
+                 EXPECT_GE(mesh.x[v], node.boundsMin[0]);
+                 EXPECT_LE(mesh.x[v], node.boundsMax[0]);
+                 EXPECT_GE(mesh.y[v], node.boundsMin[1]);
+                 EXPECT_LE(mesh.y[v], node.boundsMax[1]);
+             }
+         }
+     }
+     EXPECT_EQ(seen, std::vector<int>(64, 1));
+ }
+
+ /**
+  * @brief Tests that the faces far off the canvas are left unmarked and the ones on it are marked.
+  */
+ TEST_F(BvhTest, MarkFacesOnCanvasTest)
+ {
+     // Rows follow x and columns follow y
+     Mat4 view;
+     std::vector<uint8_t> mask(64, 2);
+
+     size_t marked = markFacesOnCanvas(bvh, view, 100, 100, mask.data());
+     EXPECT_EQ(marked, static_cast<size_t>(std::count(mask.begin(), mask.end(), 1)));
+     EXPECT_EQ(std::count(mask.begin(), mask.end(), 2), 0); // Every face gets an entry
+     for (int f = 32; f < 42; ++f)
+     {
+         EXPECT_EQ(mask[f], 1) << "face " << f << " is on the canvas"; // x from 0 to 95
+     }
+     for (int f : {0, 10, 20, 50, 63})
+     {
+         EXPECT_EQ(mask[f], 0) << "face " << f << " is off the canvas";
+     }
+
+     // Moved below the canvas, nothing is marked
+     view = Mat4::affine(Mat3(), {1000, 0, 0});
+     EXPECT_EQ(markFacesOnCanvas(bvh, view, 100, 100, mask.data()), 0u);
+     EXPECT_EQ(std::count(mask.begin(), mask.end(), 0), 64);
+ }
+
+ /**
+  * @brief Tests that the faces are listed once each, nearest cluster first, and in hierarchy order at equal depth.
+  */
+ TEST_F(BvhTest, OrderFacesFrontToBackTest)
+ {
+     // Depth follows -x, so the faces with the largest x are the nearest
+     Mat3 linear;
+     linear[2] = {-1, 0, 0};
+     std::vector<uint32_t> order;
+     orderFacesFrontToBack(bvh, Mat4::affine(linear, {0, 0, 0}), order, 4);
+
+     ASSERT_EQ(order.size(), 64u);
+     std::vector<uint32_t> sorted(order);
+     std::sort(sorted.begin(), sorted.end());
+     for (uint32_t f = 0; f < 64; ++f)
+     {
+         EXPECT_EQ(sorted[f], f);
+     }
+     for (size_t k = 0; k < 32; ++k)
+     {
+         EXPECT_GE(order[k], 32u) << "the nearer half of the row comes first";
+     }
+     // A cluster holds at most four neighboring faces, so no face comes after one more than three places to its left
+     for (size_t k = 1; k < 64; ++k)
+     {
+         EXPECT_LT(order[k], *std::min_element(order.begin(), order.begin() + k) + 4) << "position " << k;
+     }
+
+     // With every face at the same depth the hierarchy order is kept
+     orderFacesFrontToBack(bvh, Mat4(), order);
+     EXPECT_EQ(order, bvh.faces);
+ }
@@ -0,0 +1,59 @@
+/**
+ * @file TestCamera.cpp
+ * @brief This file contains unit tests for the Camera class using the Google Test framework.
+ *
+ * The tests cover the orthonormal view basis, its reproducibility, the view matrix with a moved origin and
+ * the rejection of a zero viewing direction.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <stdexcept>
+ #include "camera.h"
+
+ /**
+  * @brief Tests that the view basis is orthonormal and the same every time it is computed.
+  */
+ TEST(CameraTest, BasisTest)
+ {
+     const Vec3 directions[] = {{0, 0, 1}, {1, 2, 3}, {-0.3f, 0.9f, 0.1f}, {1, 1, 0}, {0, -1, 0}};
+     for (const Vec3 &direction : directions)
+     {
+         Camera camera(direction);
+         const Mat3 &basis = camera.getBasis();
+         for (int i = 0; i < 3; ++i)
+         {
+             EXPECT_NEAR(length(basis[i]), 1.0f, 1e-6f);
+             for (int j = i + 1; j < 3; ++j)
+             {
+                 EXPECT_NEAR(dot(basis[i], basis[j]), 0.0f, 1e-6f);
+             }
+         }
+         EXPECT_NEAR(dot(basis[0], direction / length(direction)), 1.0f, 1e-6f);
+
+         EXPECT_EQ(Camera(direction).getBasis(), basis); // Reproducible
+     }
+ }
+
+ /**
+  * @brief Tests the view matrix of a camera whose origin is not the world origin.
+  */
+ TEST(CameraTest, ViewTest)
+ {
+     Camera camera({0, 0, 2}, {10, 20, 30});
+     EXPECT_EQ(camera.getNormal(), (Vec3{0, 0, 1}));
+
+     // The X and Y axes are the image row and column axes; the origin maps to pixel (0, 0) at depth 0
+     EXPECT_EQ(camera.toScreen({10, 20, 30}), (Vec3{0, 0, 0}));
+     EXPECT_EQ(camera.toScreen({15, 25, 40}), (Vec3{5, 5, 10}));
+ }
+
+ /**
+  * @brief Tests that a zero viewing direction is rejected.
+  */
+ TEST(CameraTest, ZeroNormalTest)
+ {
+     EXPECT_THROW(Camera(Vec3{0, 0, 0}), std::invalid_argument);
+ }
@@ -11,6 +11,12 @@
 
  #include <gtest/gtest.h> // Google Test framework
  #include "Canvas.h"
+ #include "color.h"
+ #include <cstdio>
+ #include <fstream>
+ #include <iterator>
+ #include <limits>
+ #include <string>
  #include <vector>
  
  /**
@@ -67,18 +73,107 @@
      const auto& pixels = canvas.getPixels();
      const auto& depth = canvas.getDepthBuffer();
  
-     // Manually compare each color component of the pixel
-     for (size_t i = 0; i < redColor.size(); ++i)
-     {
-         EXPECT_FLOAT_EQ(pixels[10][10][i], 0.0) 
-             << "Pixel at (10,10)[" << i << "] was not reset to black";
-     }
+     // Check that the packed color of the pixel is black
+     EXPECT_EQ(pixels[10 * 100 + 10], 0u)
+         << "Pixel at (10,10) was not reset to black";
  
      // Check if (10,10) depth is reset
-     EXPECT_FLOAT_EQ(depth[10][10], 0.0) 
+     EXPECT_FLOAT_EQ(depth[10 * 100 + 10], 0.0) 
          << "Depth at (10,10) was not reset";
  }
  
+ /**
+  * @brief Tests clearing the canvas by advancing its epoch.
+  *
+  * This test verifies that pixels from earlier epochs read and encode as cleared, are replaced by any later
+  * draw, and that the canvas keeps working after the 8-bit epoch wraps around.
+  */
+ TEST_F(CanvasTest, EpochClearTest)
+ {
+     canvas.setClearMode(ClearMode::Epoch);
+     canvas.putPixel(10, 10, 0.5f, packColor(1.0f, 0.0f, 0.0f));
+     canvas.putPixel(10, 11, 0.5f, packColor(1.0f, 0.0f, 0.0f));
+
+     canvas.clear();
+     EXPECT_EQ(canvas.getPixels()[10 * 100 + 10], 0u);
+     EXPECT_FLOAT_EQ(canvas.getDepthBuffer()[10 * 100 + 10], 0.0f);
+
+     // A pixel from the previous frame does not hide a farther one in this frame
+     canvas.putPixel(10, 10, 0.75f, packColor(0.0f, 1.0f, 0.0f));
+     EXPECT_EQ(canvas.getPixels()[10 * 100 + 10], packColor(0.0f, 1.0f, 0.0f));
+     EXPECT_FLOAT_EQ(canvas.getDepthBuffer()[10 * 100 + 10], 0.75f);
+
+     // The stale pixel is written as background
+     std::string filename = "epoch_clear_test.ppm";
+     canvas.writeImage(filename, ImageFormat::P6);
+     std::ifstream file(filename, std::ios::binary);
+     std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+     size_t header = std::string("P6\n100 100\n255\n").size();
+     EXPECT_EQ(bytes.substr(header + 3 * (10 * 100 + 10), 6), std::string("\0\xff\0\0\0\0", 6));
+     file.close();
+     std::remove(filename.c_str());
+
+     // Drawing still works across the wrap-around of the epoch
+     for (int frame = 0; frame < 300; ++frame)
+     {
+         canvas.clear();
+         canvas.putPixel(10, 10, 1.0f + frame, packColor(0.0f, 0.0f, 1.0f));
+         ASSERT_FLOAT_EQ(canvas.getDepthBuffer()[10 * 100 + 10], 1.0f + frame);
+         ASSERT_EQ(canvas.getPixels()[10 * 100 + 11], 0u);
+     }
+ }
+
+ /**
+  * @brief Tests tracking the farthest depth of each 8x8 block of pixels.
+  *
+  * This test verifies that a block counts as empty until all of its pixels are drawn, that a refresh finds the
+  * farthest of them, and that clearing empties the blocks again, in either clear mode.
+  */
+ TEST_F(CanvasTest, BlockDepthTest)
+ {
+     const float empty = std::numeric_limits<float>::infinity();
+     EXPECT_EQ(canvas.getBlockDepth(10, 20), empty);
+
+     for (int i = 8; i < 16; ++i)
+     {
+         for (int j = 16; j < 24; ++j)
+         {
+             canvas.putPixel(i, j, 5.0f + (i + j) % 3, packColor(1.0f, 0.0f, 0.0f));
+         }
+     }
+     canvas.refreshBlockDepth(10, 20);
+     EXPECT_EQ(canvas.getBlockDepth(8, 16), 7.0f); // Any pixel of the block names it
+     canvas.lowerBlockDepth(15, 23, 6.0f);
+     EXPECT_EQ(canvas.getBlockDepth(10, 20), 6.0f);
+
+     // The partial blocks at the canvas edge only hold the pixels inside the canvas
+     for (int j = 96; j < 100; ++j)
+     {
+         canvas.putPixel(99, j, 3.0f, packColor(1.0f, 0.0f, 0.0f));
+     }
+     canvas.refreshBlockDepth(99, 99);
+     EXPECT_EQ(canvas.getBlockDepth(99, 99), empty); // Rows 96 to 98 are still empty
+     for (int i = 96; i < 99; ++i)
+         for (int j = 96; j < 100; ++j)
+             canvas.putPixel(i, j, 2.0f, packColor(1.0f, 0.0f, 0.0f));
+     canvas.refreshBlockDepth(99, 99);
+     EXPECT_EQ(canvas.getBlockDepth(99, 99), 3.0f);
+
+     canvas.clear();
+     EXPECT_EQ(canvas.getBlockDepth(10, 20), empty);
+     EXPECT_EQ(canvas.getBlockDepth(99, 99), empty);
+
+     // An epoch clear empties the blocks without rewriting them, also when the epoch wraps around
+     canvas.setClearMode(ClearMode::Epoch);
+     for (int frame = 0; frame < 300; ++frame)
+     {
+         canvas.lowerBlockDepth(10, 20, 4.0f);
+         ASSERT_EQ(canvas.getBlockDepth(10, 20), 4.0f);
+         canvas.clear();
+         ASSERT_EQ(canvas.getBlockDepth(10, 20), empty);
+     }
+ }
+
  /**
   * @brief Tests putting a pixel on the canvas.
   * 
@@ -92,10 +187,17 @@
  
      canvas.putPixel(10, 20, depth, color);
  
-     // Test that the pixel at (10, 20) has the correct color and depth
-     // This would require an appropriate getter for pixel data; for example:
-     // EXPECT_EQ(canvas.getPixel(10, 20), std::make_pair(depth, color));
-     // The method to retrieve pixel data needs to be implemented in the Canvas class.
+     // Test that the pixel at (10, 20) has the correct color and depth; pixels are stored row by row
+     EXPECT_EQ(canvas.getPixels()[10 * 100 + 20], packColor(1.0f, 0.0f, 0.0f));
+     EXPECT_FLOAT_EQ(canvas.getDepthBuffer()[10 * 100 + 20], depth);
+
+     // A farther pixel does not replace it, a closer one does
+     std::vector<float> green = {0.0f, 1.0f, 0.0f};
+     canvas.putPixel(10, 20, 0.75f, green);
+     EXPECT_EQ(canvas.getPixels()[10 * 100 + 20], packColor(1.0f, 0.0f, 0.0f));
+     canvas.putPixel(10, 20, 0.25f, green);
+     EXPECT_EQ(canvas.getPixels()[10 * 100 + 20], packColor(0.0f, 1.0f, 0.0f));
+     EXPECT_FLOAT_EQ(canvas.getDepthBuffer()[10 * 100 + 20], 0.25f);
  }
  
  /**
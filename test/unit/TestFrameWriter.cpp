@@ -0,0 +1,111 @@
+/**
+ * @file TestFrameWriter.cpp
+ * @brief This file contains unit tests for the FrameWriter class using the Google Test framework.
+ *
+ * The tests render more frames than the writer has canvases, so canvases must be recycled, and check the
+ * written files, the clearing of recycled canvases and the rejection of foreign canvases.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <filesystem>
+ #include <fstream>
+ #include <iterator>
+ #include <set>
+ #include <stdexcept>
+ #include <string>
+ #include <vector>
+ #include "color.h"
+ #include "frame_writer.h"
+
+ /**
+  * @brief Test fixture for the FrameWriter class.
+  *
+  * This fixture provides a small canvas to copy and a temporary directory for the written frames.
+  */
+ class FrameWriterTest : public ::testing::Test
+ {
+ protected:
+     FrameWriterTest()
+         : prototype(4, 5), directory(std::filesystem::temp_directory_path() / "frame_writer_test")
+     {
+         std::filesystem::create_directories(directory);
+     }
+
+     ~FrameWriterTest() override { std::filesystem::remove_all(directory); }
+
+     std::string framePath(int frame) const { return (directory / ("frame_" + std::to_string(frame) + ".ppm")).string(); }
+
+     Canvas prototype;                // The canvas the writer's pool is copied from
+     std::filesystem::path directory; // Where the frames are written
+ };
+
+ /**
+  * @brief Tests that every submitted frame is written with its own content, using recycled, cleared canvases.
+  */
+ TEST_F(FrameWriterTest, WritesEveryFrameTest)
+ {
+     const int frameCount = 12;
+     std::set<Canvas *> used;
+     {
+         FrameWriter writer(prototype, 2, 2);
+         for (int frame = 0; frame < frameCount; ++frame)
+         {
+             Canvas &canvas = writer.acquire();
+             EXPECT_EQ(canvas.getHeight(), 4);
+             EXPECT_EQ(canvas.getWidth(), 5);
+             for (uint32_t pixel : canvas.getPixels())
+             {
+                 ASSERT_EQ(pixel, 0u) << "frame " << frame << " got a canvas that was not cleared";
+             }
+
+             canvas.putPixel(frame % 4, 0, 1.0f, packColor(frame / 255.0f, 0.0f, 1.0f));
+             used.insert(&canvas);
+             writer.submit(canvas, framePath(frame), ImageFormat::P6);
+         }
+     } // The destructor writes the remaining frames
+
+     EXPECT_LE(used.size(), 2u);
+     for (int frame = 0; frame < frameCount; ++frame)
+     {
+         std::ifstream file(framePath(frame), std::ios::binary);
+         std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+         std::string header = "P6\n5 4\n255\n";
+         ASSERT_EQ(bytes.size(), header.size() + 4 * 5 * 3) << "frame " << frame;
+
+         const uint8_t *pixel = &bytes[header.size() + 3 * (frame % 4) * 5];
+         EXPECT_EQ(pixel[0], frame);
+         EXPECT_EQ(pixel[2], 255);
+         EXPECT_EQ(bytes[header.size() + 3 * ((frame + 1) % 4) * 5 + 2], 0); // Only this frame's pixel is set
+     }
+ }
+
+ /**
+  * @brief Tests that finish() returns only after the submitted frames are on disk.
+  */
+ TEST_F(FrameWriterTest, FinishWaitsForWritesTest)
+ {
+     FrameWriter writer(prototype, 3);
+     for (int frame = 0; frame < 3; ++frame)
+     {
+         writer.submit(writer.acquire(), framePath(frame), ImageFormat::QOI);
+     }
+     writer.finish();
+
+     for (int frame = 0; frame < 3; ++frame)
+     {
+         EXPECT_TRUE(std::filesystem::exists(framePath(frame)));
+     }
+ }
+
+ /**
+  * @brief Tests that a canvas that does not come from the writer's pool is rejected.
+  */
+ TEST_F(FrameWriterTest, RejectsForeignCanvasTest)
+ {
+     FrameWriter writer(prototype);
+     EXPECT_THROW(writer.submit(prototype, framePath(0), ImageFormat::P6), std::invalid_argument);
+     EXPECT_THROW(FrameWriter(prototype, 0), std::invalid_argument);
+ }
@@ -0,0 +1,250 @@
+/**
+ * @file TestImage.cpp
+ * @brief This file contains unit tests for the image encoders using the Google Test framework.
+ *
+ * The tests decode the QOI and PNG output with small reference decoders and compare the result with the
+ * encoded pixels. The test image is taller than one encoding band and has long runs, repeated colors and
+ * small and large color changes, so every QOI operation and the band boundaries are exercised.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <array>
+ #include <cstdint>
+ #include <vector>
+ #include <omp.h>
+ #include "color.h"
+ #include "image.h"
+
+ namespace
+ {
+     /**
+      * @brief Reads a 32-bit big-endian value.
+      */
+     uint32_t readBigEndian(const uint8_t *p)
+     {
+         return uint32_t(p[0]) << 24 | uint32_t(p[1]) << 16 | uint32_t(p[2]) << 8 | p[3];
+     }
+
+     /**
+      * @brief Decodes a three-channel QOI file into packed RGB pixels, following the QOI specification.
+      */
+     std::vector<uint32_t> decodeQOI(const std::vector<uint8_t> &file, int &width, int &height)
+     {
+         width = readBigEndian(&file[4]);
+         height = readBigEndian(&file[8]);
+
+         std::array<uint8_t, 4> px = {0, 0, 0, 255};
+         std::array<std::array<uint8_t, 4>, 64> index = {};
+         std::vector<uint32_t> pixels;
+         size_t p = 14;
+         int run = 0;
+
+         while (pixels.size() < static_cast<size_t>(width) * height)
+         {
+             if (run > 0)
+             {
+                 --run;
+             }
+             else
+             {
+                 uint8_t op = file[p++];
+                 if (op == 0xFE)
+                 {
+                     px[0] = file[p++], px[1] = file[p++], px[2] = file[p++];
+                 }
+                 else if ((op & 0xC0) == 0x00)
+                 {
+                     px = index[op];
+                 }
+                 else if ((op & 0xC0) == 0x40)
+                 {
+                     px[0] += ((op >> 4) & 3) - 2, px[1] += ((op >> 2) & 3) - 2, px[2] += (op & 3) - 2;
+                 }
+                 else if ((op & 0xC0) == 0x80)
+                 {
+                     int dg = (op & 0x3F) - 32;
+                     uint8_t next = file[p++];
+                     px[0] += dg + (next >> 4) - 8, px[1] += dg, px[2] += dg + (next & 0x0F) - 8;
+                 }
+                 else
+                 {
+                     run = op & 0x3F;
+                 }
+                 index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64] = px;
+             }
+             pixels.push_back(px[0] | px[1] << 8 | px[2] << 16);
+         }
+
+         EXPECT_EQ(std::vector<uint8_t>(file.begin() + p, file.end()), (std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 1}));
+         return pixels;
+     }
+
+     /**
+      * @brief Decodes a PNG written with stored deflate blocks, checking every CRC and the Adler-32 checksum.
+      */
+     std::vector<uint32_t> decodeStoredPNG(const std::vector<uint8_t> &file, int &width, int &height)
+     {
+         std::array<uint32_t, 256> crcTable;
+         for (uint32_t n = 0; n < 256; ++n)
+         {
+             uint32_t c = n;
+             for (int k = 0; k < 8; ++k)
+                 c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+             crcTable[n] = c;
+         }
+
+         std::vector<uint8_t> zlib;
+         for (size_t p = 8; p < file.size();)
+         {
+             uint32_t length = readBigEndian(&file[p]);
+             std::string type(file.begin() + p + 4, file.begin() + p + 8);
+             uint32_t crc = 0xFFFFFFFFu;
+             for (size_t k = p + 4; k < p + 8 + length; ++k)
+                 crc = crcTable[(crc ^ file[k]) & 0xFF] ^ (crc >> 8);
+             EXPECT_EQ(crc ^ 0xFFFFFFFFu, readBigEndian(&file[p + 8 + length])) << type << " chunk at " << p;
+
+             if (type == "IHDR")
+             {
+                 width = readBigEndian(&file[p + 8]);
+                 height = readBigEndian(&file[p + 12]);
+             }
+             else if (type == "IDAT")
+             {
+                 zlib.insert(zlib.end(), file.begin() + p + 8, file.begin() + p + 8 + length);
+             }
+             p += 12 + length;
+         }
+
+         std::vector<uint8_t> raw;
+         size_t p = 2;
+         for (bool final = false; !final;)
+         {
+             final = zlib[p] & 1;
+             EXPECT_EQ(zlib[p] & 6, 0); // Stored block
+             uint16_t length = zlib[p + 1] | zlib[p + 2] << 8;
+             EXPECT_EQ(static_cast<uint16_t>(~length), static_cast<uint16_t>(zlib[p + 3] | zlib[p + 4] << 8));
+             raw.insert(raw.end(), zlib.begin() + p + 5, zlib.begin() + p + 5 + length);
+             p += 5 + length;
+         }
+
+         uint32_t a = 1, b = 0;
+         for (uint8_t byte : raw)
+         {
+             a = (a + byte) % 65521;
+             b = (b + a) % 65521;
+         }
+         EXPECT_EQ(zlib.size(), p + 4);
+         EXPECT_EQ(readBigEndian(&zlib[p]), b << 16 | a);
+
+         std::vector<uint32_t> pixels;
+         for (int i = 0; i < height; ++i)
+         {
+             const uint8_t *row = &raw[i * (1 + 3 * width)];
+             EXPECT_EQ(row[0], 0); // Filter type none
+             for (int j = 0; j < width; ++j)
+                 pixels.push_back(row[1 + 3 * j] | row[2 + 3 * j] << 8 | row[3 + 3 * j] << 16);
+         }
+         return pixels;
+     }
+ }
+
+ /**
+  * @brief Test fixture for the image encoders.
+  *
+  * This fixture builds a 37x150 image, so it spans three bands of rows.
+  */
+ class ImageTest : public ::testing::Test
+ {
+ protected:
+     ImageTest() : pixels(width * height, 0)
+     {
+         for (int i = 0; i < height; ++i)
+         {
+             for (int j = 0; j < width; ++j)
+             {
+                 uint32_t &pixel = pixels[i * width + j];
+                 if (i < 70)
+                     pixel = 0; // A black run from the first pixel across the first band boundary
+                 else if (i < 100)
+                     pixel = packColor((j / 4) / 10.0f, 0.5f, (i % 3) / 3.0f); // Runs, repeats and small changes
+                 else
+                     pixel = (i * 2654435761u + j * 40503u) & 0xFFFFFF; // Large changes
+             }
+         }
+     }
+
+     const int width = 37, height = 150;
+     std::vector<uint32_t> pixels; // Packed RGB pixels, row by row
+ };
+
+ /**
+  * @brief Tests the header and pixel bytes of binary PPM output.
+  */
+ TEST_F(ImageTest, P6Test)
+ {
+     std::vector<uint8_t> file = encodeImage(pixels.data(), width, height, ImageFormat::P6);
+     std::string header = "P6\n37 150\n255\n";
+
+     ASSERT_EQ(file.size(), header.size() + 3 * pixels.size());
+     EXPECT_EQ(std::string(file.begin(), file.begin() + header.size()), header);
+     const uint8_t *last = &file[file.size() - 3];
+     EXPECT_EQ(last[0] | last[1] << 8 | last[2] << 16, pixels.back());
+ }
+
+ /**
+  * @brief Tests the text of ASCII PPM output.
+  */
+ TEST_F(ImageTest, P3Test)
+ {
+     uint32_t small[2] = {packColor(1.0f, 0.0f, 0.5f), 0};
+     std::vector<uint8_t> file = encodeImage(small, 1, 2, ImageFormat::PPM);
+     EXPECT_EQ(std::string(file.begin(), file.end()), "P3\n1 2\n255\n255 0 127 \n0 0 0 \n");
+ }
+
+ /**
+  * @brief Tests that QOI output decodes to the original pixels.
+  */
+ TEST_F(ImageTest, QOIRoundTripTest)
+ {
+     std::vector<uint8_t> file = encodeImage(pixels.data(), width, height, ImageFormat::QOI);
+     ASSERT_EQ(std::string(file.begin(), file.begin() + 4), "qoif");
+     EXPECT_LT(file.size(), 3 * pixels.size()); // The runs and repeats compress
+
+     int decodedWidth, decodedHeight;
+     EXPECT_EQ(decodeQOI(file, decodedWidth, decodedHeight), pixels);
+     EXPECT_EQ(decodedWidth, width);
+     EXPECT_EQ(decodedHeight, height);
+ }
+
+ /**
+  * @brief Tests that PNG output has valid checksums and decodes to the original pixels.
+  */
+ TEST_F(ImageTest, PNGRoundTripTest)
+ {
+     std::vector<uint8_t> file = encodeImage(pixels.data(), width, height, ImageFormat::PNG);
+     ASSERT_EQ(std::string(file.begin() + 1, file.begin() + 4), "PNG");
+
+     int decodedWidth, decodedHeight;
+     EXPECT_EQ(decodeStoredPNG(file, decodedWidth, decodedHeight), pixels);
+     EXPECT_EQ(decodedWidth, width);
+     EXPECT_EQ(decodedHeight, height);
+ }
+
+ /**
+  * @brief Tests that the encoded bytes do not depend on the number of threads.
+  */
+ TEST_F(ImageTest, ThreadIndependentTest)
+ {
+     int threads = omp_get_max_threads();
+     for (ImageFormat format : {ImageFormat::PPM, ImageFormat::P6, ImageFormat::QOI, ImageFormat::PNG})
+     {
+         omp_set_num_threads(1);
+         std::vector<uint8_t> single = encodeImage(pixels.data(), width, height, format);
+         omp_set_num_threads(4);
+         EXPECT_EQ(encodeImage(pixels.data(), width, height, format), single) << static_cast<int>(format);
+     }
+     omp_set_num_threads(threads);
+ }
@@ -0,0 +1,103 @@
+/**
+ * @file TestInstancedObject.cpp
+ * @brief This file contains unit tests for the InstancedObject class using the Google Test framework.
+ *
+ * The tests cover drawing copies at their own transforms, drawing copies in their own colors, skipping copies
+ * that miss the canvas, and sharing the geometry so memory does not grow with the number of copies.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <vector>
+ #include "color.h"
+ #include "instanced_object.h"
+
+ /**
+  * @brief Test fixture for the InstancedObject class.
+  *
+  * This fixture loads the two-triangle STL file, a square from (200, 200) to (300, 300) at z = 300, as both a
+  * TriangleObject and an InstancedObject sharing its geometry.
+  */
+ class InstancedObjectTest : public ::testing::Test
+ {
+ protected:
+     InstancedObjectTest() : single("../test/stl/two_triangles.stl"), instanced(single.getGeometry()), canvas(400, 400)
+     {
+         std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+         canvas.setCameraNormal(normal);
+     }
+
+     TriangleObject single;     // The mesh drawn on its own
+     InstancedObject instanced; // The same mesh, drawn as copies
+     Canvas canvas;             // The canvas the copies are drawn on
+ };
+
+ /**
+  * @brief Tests that the copies draw exactly what separate objects with the same transforms draw.
+  */
+ TEST_F(InstancedObjectTest, MatchesSeparateObjectsTest)
+ {
+     EXPECT_EQ(instanced.getGeometry().get(), single.getGeometry().get());
+
+     instanced.addInstance(Mat4::affine(Mat3(), {-150, -150, 0}));
+     instanced.addInstance(Mat4::affine(Mat3(), {50, 20, -10}));
+     RenderStats stats = instanced.project(canvas);
+     EXPECT_EQ(stats.facesDrawn, 4u);
+
+     Canvas expected(400, 400);
+     std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+     expected.setCameraNormal(normal);
+     TriangleObject first(single.getGeometry()), second(single.getGeometry());
+     first.translate(-150, -150, 0);
+     second.translate(50, 20, -10);
+     first.project(expected);
+     second.project(expected);
+
+     EXPECT_EQ(canvas.getPixels(), expected.getPixels());
+     EXPECT_EQ(canvas.getDepthBuffer(), expected.getDepthBuffer());
+ }
+
+ /**
+  * @brief Tests that a copy with a color of its own draws every face in it, and one without keeps the face colors.
+  */
+ TEST_F(InstancedObjectTest, InstanceColorTest)
+ {
+     const uint32_t red = packColor(1, 0, 0);
+     instanced.addInstance(Mat4::affine(Mat3(), {-150, -150, 0}), {1, 0, 0});
+     instanced.addInstance(Mat4());
+     instanced.project(canvas);
+
+     std::vector<uint32_t> pixels = canvas.getPixels();
+     const Mesh &mesh = single.getGeometry()->mesh;
+     EXPECT_EQ(pixels[75 * 400 + 75], red);                 // Middle of the moved square
+     EXPECT_EQ(pixels[250 * 400 + 260], mesh.colors[0]);    // Lower triangle of the square in place
+     EXPECT_EQ(pixels[260 * 400 + 250], mesh.colors[1]);    // Upper triangle of the square in place
+
+     instanced.getInstance(1).color = red;
+     instanced.getInstance(1).hasColor = true;
+     canvas.clear();
+     instanced.project(canvas);
+     EXPECT_EQ(canvas.getPixels()[250 * 400 + 260], red);
+ }
+
+ /**
+  * @brief Tests that copies off the canvas are skipped whole and the memory does not grow with the copies.
+  */
+ TEST_F(InstancedObjectTest, SharedGeometryTest)
+ {
+     instanced.addInstance(Mat4());
+     instanced.project(canvas);
+     const size_t oneCopy = instanced.getMemoryUsage();
+
+     for (int i = 1; i < 100; ++i)
+     {
+         instanced.addInstance(Mat4::affine(Mat3(), {1000.0f * i, 0, 0}));
+     }
+     RenderStats stats = instanced.project(canvas);
+     EXPECT_EQ(stats.facesDrawn, 2u);
+     EXPECT_EQ(stats.facesOffCanvas, 198u);
+     EXPECT_EQ(instanced.instanceCount(), 100u);
+     EXPECT_LE(instanced.getMemoryUsage() - oneCopy, (200 - 1) * sizeof(Instance)); // The copies' own records only
+ }
@@ -0,0 +1,60 @@
+/**
+ * @file TestLinalg.cpp
+ * @brief This file contains unit tests for the Vec3, Mat3 and Mat4 types using the Google Test framework.
+ *
+ * The tests check the vector and matrix operations, partly at compile time, and that the std::vector
+ * overloads give the same results as the Vec3 functions they forward to.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <cmath>
+ #include <vector>
+ #include "linalg.h"
+
+ // The operations are usable in constant expressions
+ static_assert(dot(Vec3{1, 2, 3}, Vec3{4, 5, 6}) == 32.0f);
+ static_assert(cross(Vec3{1, 0, 0}, Vec3{0, 1, 0}) == Vec3{0, 0, 1});
+ static_assert(Vec3{1, 2, 3} - 2.0f * Vec3{1, 1, 1} == Vec3{-1, 0, 1});
+ static_assert(determinant(Mat3()) == 1.0f);
+ static_assert(transpose(Mat3{{{1, 2, 3}, {4, 5, 6}, {7, 8, 9}}})[0] == Vec3{1, 4, 7});
+ static_assert(transformPoint(Mat4::affine(Mat3(), {1, 2, 3}) * Mat4::affine(Mat3(), {4, 5, 6}), {}) == Vec3{5, 7, 9});
+
+ /**
+  * @brief Tests multiplying matrices and vectors.
+  *
+  * This test verifies that a composed rotation and translation maps a point as the two applied in turn.
+  */
+ TEST(LinalgTest, MatrixProductTest)
+ {
+     const Mat3 quarterTurn = {{{0, -1, 0}, {1, 0, 0}, {0, 0, 1}}}; // 90 degrees about Z
+     EXPECT_EQ((quarterTurn * Vec3{1, 0, 0}), (Vec3{0, 1, 0}));
+     EXPECT_EQ((quarterTurn * quarterTurn * Vec3{1, 0, 0}), (Vec3{-1, 0, 0}));
+     EXPECT_EQ(quarterTurn * transpose(quarterTurn), Mat3());
+
+     const Mat4 rotate = Mat4::affine(quarterTurn, {});
+     const Mat4 shift = Mat4::affine(Mat3(), {10, 0, 0});
+     const Vec3 point = {1, 2, 3};
+     EXPECT_EQ(transformPoint(shift * rotate, point), transformPoint(shift, transformPoint(rotate, point)));
+     EXPECT_EQ(transformPoint(shift * rotate, point), (Vec3{8, 1, 3}));
+ }
+
+ /**
+  * @brief Tests the std::vector overloads against the Vec3 functions.
+  *
+  * This test verifies that the adapters convert their arguments and results without changing them.
+  */
+ TEST(LinalgTest, VectorAdapterTest)
+ {
+     std::vector<float> a = {1.0f, 2.0f, 2.0f};
+     std::vector<float> b = {-3.0f, 0.5f, 4.0f};
+     std::vector<float> c = {0.0f, 1.0f, -1.0f};
+
+     EXPECT_EQ(dotProduct(a, b), dot(toVec3(a), toVec3(b)));
+     EXPECT_EQ(norm(a), 3.0f);
+     EXPECT_EQ(determinant3x3(a, b, c), dot(toVec3(a), cross(toVec3(b), toVec3(c))));
+     EXPECT_EQ(toVector(toVec3(b)), b);
+ }
+
@@ -0,0 +1,236 @@
+/**
+ * @file TestMesh.cpp
+ * @brief This file contains unit tests for building indexed meshes using the Google Test framework.
+ *
+ * The tests cover exact vertex welding of an STL file, welding of nearly identical vertices within a
+ * tolerance, preservation of face order and colors, reordering faces along a Morton curve, and storing the
+ * vertices as 16-bit codes.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <algorithm>
+ #include <array>
+ #include <cmath>
+ #include <random>
+ #include <vector>
+ #include "color.h"
+ #include "mesh.h"
+
+ /**
+  * @brief Test fixture for indexed meshes.
+  *
+  * This fixture loads the two-triangle STL file, whose faces share two of their vertices.
+  */
+ class MeshTest : public ::testing::Test
+ {
+ protected:
+     MeshTest() { readSTL("../test/stl/two_triangles.stl", soup); }
+
+     TriangleSoup soup; // Faces read from the STL file
+ };
+
+ /**
+  * @brief Tests that identical vertices are stored once and the faces still resolve to their original corners.
+  */
+ TEST_F(MeshTest, WeldExactTest)
+ {
+     Mesh mesh = weldVertices(soup);
+
+     ASSERT_EQ(mesh.faceCount(), 2);
+     EXPECT_EQ(mesh.vertexCount(), 4); // Two corners of the square are shared by both triangles
+     for (size_t f = 0; f < mesh.faceCount(); ++f)
+     {
+         EXPECT_EQ(mesh.colors[f], packColor(soup.colors[3 * f], soup.colors[3 * f + 1], soup.colors[3 * f + 2]));
+     }
+
+     for (size_t corner = 0; corner < mesh.indices.size(); ++corner)
+     {
+         EXPECT_EQ(mesh.x[mesh.indices[corner]], soup.vertices[3 * corner + 0]);
+         EXPECT_EQ(mesh.y[mesh.indices[corner]], soup.vertices[3 * corner + 1]);
+         EXPECT_EQ(mesh.z[mesh.indices[corner]], soup.vertices[3 * corner + 2]);
+     }
+
+     // Both faces start at the same corner, and the first face's last corner is the second face's middle one
+     EXPECT_EQ(mesh.indices[0], mesh.indices[3]);
+     EXPECT_EQ(mesh.indices[2], mesh.indices[4]);
+ }
+
+ /**
+  * @brief Tests that vertices closer than the tolerance are merged and farther ones are kept apart.
+  */
+ TEST_F(MeshTest, WeldWithToleranceTest)
+ {
+     TriangleSoup jittered;
+     jittered.vertices = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+                          0.0004f, -0.0004f, 0.0f, 1.0f, 0.0003f, 0.0f, 1.0f, 1.0f, 0.0f};
+     jittered.colors = {1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f};
+
+     EXPECT_EQ(weldVertices(jittered).vertexCount(), 6);
+
+     Mesh welded = weldVertices(jittered, 0.001f);
+     EXPECT_EQ(welded.vertexCount(), 4);
+     EXPECT_EQ(welded.indices, (std::vector<uint32_t>{0, 1, 2, 0, 1, 3}));
+
+     // The first occurrence of a vertex is the one that is kept
+     EXPECT_EQ(welded.x[0], 0.0f);
+     EXPECT_EQ(welded.y[1], 0.0f);
+ }
+
+ /**
+  * @brief Tests that faces keep the normal stored in the file and get one from their winding otherwise.
+  */
+ TEST_F(MeshTest, FaceNormalTest)
+ {
+     Mesh mesh = weldVertices(soup);
+     EXPECT_EQ(mesh.normals, (std::vector<float>{0, 0, -1, 0, 0, -1})); // As written in the file
+
+     TriangleSoup unnormalized;
+     unnormalized.vertices = {0, 0, 0, 2, 0, 0, 0, 2, 0, 0, 0, 0, 0, 0, 2, 0, 2, 0, 0, 0, 0, 1, 0, 0, 2, 0, 0};
+     unnormalized.colors.assign(9, 1.0f);
+     unnormalized.normals = {0, 0, 0, 3, 0, 0, 0, 0, 0};
+
+     Mesh computed = weldVertices(unnormalized);
+     EXPECT_EQ(computed.normals, (std::vector<float>{0, 0, 1,     // Counter-clockwise seen from +Z
+                                                     1, 0, 0,     // Stored normal, scaled to unit length
+                                                     0, 0, 0})); // Degenerate face
+ }
+
+ /**
+  * @brief Tests that sorting the faces of a shuffled grid groups them by region and numbers vertices by first use.
+  *
+  * The grid has 16 x 16 squares of size 10, two faces each, written in a random order. Each face keeps its
+  * corners, color and normal.
+  */
+ TEST(MortonOrderTest, SortFacesTest)
+ {
+     TriangleSoup grid;
+     std::vector<std::array<int, 2>> squares;
+     for (int i = 0; i < 16; ++i)
+         for (int j = 0; j < 16; ++j)
+             squares.push_back({i, j});
+     std::shuffle(squares.begin(), squares.end(), std::mt19937(7));
+     for (const auto &[i, j] : squares)
+     {
+         const float x = i * 10.0f, y = j * 10.0f;
+         grid.vertices.insert(grid.vertices.end(), {x, y, 0, x + 10, y, 0, x + 10, y + 10, 0,
+                                                    x, y, 0, x + 10, y + 10, 0, x, y + 10, 0});
+         grid.colors.insert(grid.colors.end(), {i / 16.0f, j / 16.0f, 0, i / 16.0f, j / 16.0f, 1});
+     }
+
+     // Every face as its corners and color, to compare the faces as a set
+     auto faces = [](const Mesh &mesh)
+     {
+         std::vector<std::array<float, 10>> result;
+         for (size_t f = 0; f < mesh.faceCount(); ++f)
+         {
+             std::array<float, 10> face;
+             for (int corner = 0; corner < 3; ++corner)
+             {
+                 const uint32_t v = mesh.indices[3 * f + corner];
+                 face[3 * corner] = mesh.x[v], face[3 * corner + 1] = mesh.y[v], face[3 * corner + 2] = mesh.z[v];
+             }
+             face[9] = static_cast<float>(mesh.colors[f]);
+             result.push_back(face);
+         }
+         std::sort(result.begin(), result.end());
+         return result;
+     };
+
+     Mesh mesh = weldVertices(grid);
+     Mesh sorted = mesh;
+     sortFacesByMortonCode(sorted);
+     ASSERT_EQ(sorted.faceCount(), mesh.faceCount());
+     ASSERT_EQ(sorted.vertexCount(), mesh.vertexCount());
+     EXPECT_EQ(faces(sorted), faces(mesh));
+     EXPECT_EQ(sorted.normals, mesh.normals); // All faces point the same way
+
+     // The first quarter of the faces is the lower left quarter of the grid
+     for (size_t f = 0; f < sorted.faceCount() / 4; ++f)
+     {
+         const uint32_t *face = sorted.indices.data() + 3 * f;
+         EXPECT_LT((sorted.x[face[0]] + sorted.x[face[1]] + sorted.x[face[2]]) / 3, 80.0f);
+         EXPECT_LT((sorted.y[face[0]] + sorted.y[face[1]] + sorted.y[face[2]]) / 3, 80.0f);
+     }
+
+     // Each face uses no vertex past those of the faces before it, plus its own new ones
+     uint32_t used = 0;
+     for (uint32_t index : sorted.indices)
+     {
+         EXPECT_LE(index, used);
+         used = std::max(used, index + 1);
+     }
+ }
+
+ /**
+  * @brief Tests that quantized vertices stay within half a step and decode to the snapped float vertices.
+  */
+ TEST(QuantizeTest, QuantizeVerticesTest)
+ {
+     Mesh mesh;
+     mesh.x = {-1.0f, 3.0f, 0.123456f, 2.5f};
+     mesh.y = {10.0f, 10.0f, 10.0f, 10.0f}; // Flat along y
+     mesh.z = {1000.0f, -1000.0f, 333.333f, 0.0f};
+     mesh.indices = {0, 1, 2, 1, 3, 2};
+     Mesh original = mesh;
+
+     quantizeVertices(mesh);
+     EXPECT_FALSE(mesh.isQuantized()); // The floats are still there, moved onto the grid
+     ASSERT_EQ(mesh.quantized.x.size(), 4u);
+     EXPECT_EQ(mesh.quantized.x[0], 0);
+     EXPECT_EQ(mesh.quantized.x[1], 65535);
+     EXPECT_EQ(mesh.quantized.step[1], 0.0f);
+
+     const std::vector<float> *before[3] = {&original.x, &original.y, &original.z};
+     const std::vector<float> *after[3] = {&mesh.x, &mesh.y, &mesh.z};
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         for (size_t v = 0; v < 4; ++v)
+         {
+             EXPECT_LE(std::fabs((*after[axis])[v] - (*before[axis])[v]), mesh.quantized.step[axis] * 0.5f + 1e-4f);
+         }
+     }
+
+     // With the floats gone, vertices and bounds come from the codes and match the snapped floats
+     Mesh compact = mesh;
+     std::vector<float>().swap(compact.x), std::vector<float>().swap(compact.y), std::vector<float>().swap(compact.z);
+     ASSERT_TRUE(compact.isQuantized());
+     EXPECT_EQ(compact.vertexCount(), 4u);
+     EXPECT_LT(compact.getMemoryUsage(), mesh.getMemoryUsage());
+     for (size_t v = 0; v < 4; ++v)
+     {
+         float position[3];
+         compact.getVertex(v, position);
+         EXPECT_EQ(position[0], mesh.x[v]);
+         EXPECT_EQ(position[1], mesh.y[v]);
+         EXPECT_EQ(position[2], mesh.z[v]);
+     }
+
+     float compactMin[3], compactMax[3], boundsMin[3], boundsMax[3];
+     compact.getBounds(compactMin, compactMax);
+     mesh.getBounds(boundsMin, boundsMax);
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         EXPECT_EQ(compactMin[axis], boundsMin[axis]);
+         EXPECT_EQ(compactMax[axis], boundsMax[axis]);
+     }
+ }
+
+ /**
+  * @brief Tests that packed colors unpack to values that convert back to the same 0-255 bytes.
+  */
+ TEST(ColorTest, PackRoundTripTest)
+ {
+     EXPECT_EQ(packColor(1.0f, 0.0f, 0.5f), 0x7F00FFu);
+     EXPECT_EQ(packColor(-0.5f, 2.0f, 0.0f), 0x00FF00u); // Out-of-range components are clamped
+
+     float rgb[3];
+     for (uint32_t value = 0; value < 256; ++value)
+     {
+         unpackColor(value | (value << 8) | (value << 16), rgb);
+         EXPECT_EQ(static_cast<uint32_t>(rgb[0] * 255), value);
+         EXPECT_EQ(packColor(rgb[0], rgb[1], rgb[2]), value | (value << 8) | (value << 16));
+     }
+ }
@@ -0,0 +1,179 @@
+/**
+ * @file TestMeshCache.cpp
+ * @brief This file contains unit tests for the mesh cache files using the Google Test framework.
+ *
+ * The tests cover writing the cache on the first load, reading back the same mesh, and rejecting caches
+ * that are stale, built with another weld tolerance, truncated, or damaged, and writers racing on the same file.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <chrono>
+ #include <cstdint>
+ #include <filesystem>
+ #include <fstream>
+ #include <thread>
+ #include <vector>
+ #include "mesh_cache.h"
+ #include "TriangleObject.h"
+
+ /**
+  * @brief Test fixture for the mesh cache.
+  *
+  * This fixture copies the two-triangle STL file into a temporary directory, so the cache is written there.
+  */
+ class MeshCacheTest : public ::testing::Test
+ {
+ protected:
+     MeshCacheTest()
+         : dir(std::filesystem::temp_directory_path() / "mesh_cache_test"),
+           stlPath((dir / "two_triangles.stl").string())
+     {
+         std::filesystem::create_directories(dir);
+         std::filesystem::copy_file("../test/stl/two_triangles.stl", stlPath,
+                                    std::filesystem::copy_options::overwrite_existing);
+         std::filesystem::remove(meshCachePath(stlPath));
+     }
+
+     ~MeshCacheTest() override { std::filesystem::remove_all(dir); }
+
+     std::filesystem::path dir; // Temporary directory holding the STL file and its cache
+     std::string stlPath;       // Path of the copied STL file
+ };
+
+ /**
+  * @brief Tests that the first load writes a cache that reads back into the same mesh.
+  */
+ TEST_F(MeshCacheTest, WriteThenReadTest)
+ {
+     TriangleObject first(stlPath);
+     ASSERT_TRUE(std::filesystem::exists(meshCachePath(stlPath)));
+
+     Mesh cached;
+     ASSERT_TRUE(readMeshCache(stlPath, 0.0f, cached));
+     EXPECT_EQ(cached.x, first.getMesh().x);
+     EXPECT_EQ(cached.y, first.getMesh().y);
+     EXPECT_EQ(cached.z, first.getMesh().z);
+     EXPECT_EQ(cached.indices, first.getMesh().indices);
+     EXPECT_EQ(cached.colors, first.getMesh().colors);
+
+     TriangleObject second(stlPath); // Loaded from the cache
+     EXPECT_EQ(second.size(), 2);
+     EXPECT_EQ(second.getMesh().z, first.getMesh().z);
+ }
+
+ /**
+  * @brief Tests that a cache is ignored once the STL file changes or a different weld tolerance is requested.
+  */
+ TEST_F(MeshCacheTest, RejectStaleCacheTest)
+ {
+     TriangleObject object(stlPath);
+     Mesh cached;
+
+     EXPECT_FALSE(readMeshCache(stlPath, 0.5f, cached));
+
+     std::filesystem::last_write_time(stlPath, std::filesystem::last_write_time(stlPath) + std::chrono::seconds(5));
+     EXPECT_FALSE(readMeshCache(stlPath, 0.0f, cached));
+     EXPECT_TRUE(cached.x.empty());
+ }
+
+ /**
+  * @brief Tests that a truncated cache file is rejected and the STL file is loaded instead.
+  */
+ TEST_F(MeshCacheTest, RejectTruncatedCacheTest)
+ {
+     TriangleObject object(stlPath);
+     std::string cachePath = meshCachePath(stlPath);
+     std::filesystem::resize_file(cachePath, std::filesystem::file_size(cachePath) - 4);
+
+     Mesh cached;
+     EXPECT_FALSE(readMeshCache(stlPath, 0.0f, cached));
+
+     TriangleObject reloaded(stlPath);
+     EXPECT_EQ(reloaded.size(), 2);
+     EXPECT_TRUE(readMeshCache(stlPath, 0.0f, cached)); // The reload rewrote the cache
+ }
+
+ /**
+  * @brief Tests that a cache of the right size whose counts or indices are damaged is rejected.
+  *
+  * The two-triangle mesh has 4 vertices and 2 faces; its indices start 2 * 28 bytes before the end of the file.
+  */
+ TEST_F(MeshCacheTest, RejectDamagedCacheTest)
+ {
+     TriangleObject object(stlPath);
+     const std::string cachePath = meshCachePath(stlPath);
+     const uint64_t fileSize = std::filesystem::file_size(cachePath);
+     auto overwrite = [&cachePath](uint64_t offset, const auto &value)
+     {
+         std::fstream file(cachePath, std::ios::in | std::ios::out | std::ios::binary);
+         file.seekp(static_cast<std::streamoff>(offset));
+         file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+     };
+
+     // An index past the last vertex
+     overwrite(fileSize - 2 * 28, uint32_t(4));
+     Mesh cached;
+     EXPECT_FALSE(readMeshCache(stlPath, 0.0f, cached));
+     EXPECT_TRUE(cached.indices.empty());
+     EXPECT_TRUE(cached.x.empty());
+
+     TriangleObject reloaded(stlPath);
+     EXPECT_EQ(reloaded.getMesh().indices, object.getMesh().indices);
+     ASSERT_TRUE(readMeshCache(stlPath, 0.0f, cached)); // The reload rewrote the cache
+
+     // A vertex count whose array size wraps around to the right total (the count sits 40 bytes into the header)
+     overwrite(40, (uint64_t(1) << 62) + 4);
+     Mesh damaged;
+     EXPECT_FALSE(readMeshCache(stlPath, 0.0f, damaged));
+     EXPECT_TRUE(damaged.x.empty());
+ }
+
+ /**
+  * @brief Tests that writers racing on the same STL file each publish a whole cache and leave no temporary file.
+  *
+  * Half the writers cache the mesh under another weld tolerance, so a cache mixing their files would show.
+  */
+ TEST_F(MeshCacheTest, ConcurrentWritersTest)
+ {
+     TriangleObject object(stlPath);
+     const Mesh &mesh = object.getMesh();
+
+     std::vector<std::thread> writers;
+     for (int k = 0; k < 8; ++k)
+     {
+         writers.emplace_back([&, k] { EXPECT_TRUE(writeMeshCache(stlPath, k % 2 ? 0.5f : 0.0f, mesh)); });
+     }
+     for (std::thread &writer : writers)
+     {
+         writer.join();
+     }
+
+     Mesh cached;
+     ASSERT_TRUE(readMeshCache(stlPath, 0.0f, cached) || readMeshCache(stlPath, 0.5f, cached));
+     EXPECT_EQ(cached.indices, mesh.indices);
+     EXPECT_EQ(cached.z, mesh.z);
+
+     size_t files = 0;
+     for (const auto &entry : std::filesystem::directory_iterator(dir))
+     {
+         EXPECT_NE(entry.path().extension(), ".tmp") << entry.path();
+         ++files;
+     }
+     EXPECT_EQ(files, 2u); // The STL file and its cache
+ }
+
+ /**
+  * @brief Tests that no cache is written when caching is turned off.
+  */
+ TEST_F(MeshCacheTest, CacheDisabledTest)
+ {
+     LoadOptions options;
+     options.useCache = false;
+     TriangleObject object(stlPath, options);
+
+     EXPECT_EQ(object.size(), 2);
+     EXPECT_FALSE(std::filesystem::exists(meshCachePath(stlPath)));
+ }
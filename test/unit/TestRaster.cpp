@@ -0,0 +1,336 @@
+/**
+ * @file TestRaster.cpp
+ * @brief This file contains unit tests for the edge-function rasterizer using the Google Test framework.
+ *
+ * The tests cover the top-left fill rule on shared edges, independence from the winding order, clipping to
+ * the target rectangle, triangles reaching far past the guard band, the interpolated depth, and that tiled batch rasterization draws the same image as
+ * drawing the triangles one by one, with or without deferred shading.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <algorithm>
+ #include <cmath>
+ #include <cstdint>
+ #include <vector>
+ #include <omp.h>
+ #include "color.h"
+ #include "raster.h"
+
+ /**
+  * @brief Counts how often each pixel of a small grid is covered by a set of triangles.
+  */
+ class RasterTest : public ::testing::Test
+ {
+ protected:
+     RasterTest() : coverage(rows * cols, 0) {}
+
+     /**
+      * @brief Rasterizes a triangle onto the coverage grid.
+      */
+     void draw(std::vector<float> a, std::vector<float> b, std::vector<float> c)
+     {
+         TriangleSetup setup;
+         if (setupTriangle(a.data(), b.data(), c.data(), 0, rows, 0, cols, setup))
+         {
+             scanTriangle(setup, [this](int i, int j, float) { ++coverage[i * cols + j]; });
+         }
+     }
+
+     int count(int i, int j) const { return coverage[i * cols + j]; }
+
+     const int rows = 40, cols = 40;
+     std::vector<int> coverage; // Number of triangles that covered each pixel
+ };
+
+ /**
+  * @brief Tests that pixels on the diagonal shared by two triangles of a square are drawn exactly once.
+  */
+ TEST_F(RasterTest, SharedEdgeDrawnOnceTest)
+ {
+     draw({10, 10, 0}, {10, 30, 0}, {30, 30, 0});
+     draw({10, 10, 0}, {30, 30, 0}, {30, 10, 0});
+
+     for (int i = 0; i < rows; ++i)
+     {
+         for (int j = 0; j < cols; ++j)
+         {
+             bool inSquare = i >= 10 && i <= 30 && j >= 10 && j <= 30;
+             EXPECT_LE(count(i, j), 1) << "pixel " << i << ", " << j;
+             if (inSquare && i > 10 && i < 30 && j > 10 && j < 30)
+             {
+                 EXPECT_EQ(count(i, j), 1) << "pixel " << i << ", " << j; // The whole interior, diagonal included
+             }
+             if (!inSquare)
+             {
+                 EXPECT_EQ(count(i, j), 0) << "pixel " << i << ", " << j;
+             }
+         }
+     }
+ }
+
+ /**
+  * @brief Tests that a fan of triangles around a vertex covers the pixel at that vertex exactly once.
+  */
+ TEST_F(RasterTest, FanCoversCenterOnceTest)
+ {
+     const float center[2] = {20, 20};
+     const int spokes = 7;
+     for (int k = 0; k < spokes; ++k)
+     {
+         float angle0 = 2 * M_PI * k / spokes, angle1 = 2 * M_PI * (k + 1) / spokes;
+         draw({center[0], center[1], 0}, {center[0] + 15 * std::cos(angle0), center[1] + 15 * std::sin(angle0), 0},
+              {center[0] + 15 * std::cos(angle1), center[1] + 15 * std::sin(angle1), 0});
+     }
+
+     EXPECT_EQ(count(20, 20), 1);
+     for (int i = 0; i < rows; ++i)
+     {
+         for (int j = 0; j < cols; ++j)
+         {
+             EXPECT_LE(count(i, j), 1) << "pixel " << i << ", " << j;
+         }
+     }
+ }
+
+ /**
+  * @brief Tests that both winding orders of a triangle cover the same pixels.
+  */
+ TEST_F(RasterTest, WindingIndependentTest)
+ {
+     draw({3.5f, 2.25f, 0}, {35.1f, 12.0f, 0}, {18.0f, 37.7f, 0});
+     std::vector<int> clockwise = coverage;
+
+     std::fill(coverage.begin(), coverage.end(), 0);
+     draw({3.5f, 2.25f, 0}, {18.0f, 37.7f, 0}, {35.1f, 12.0f, 0});
+     EXPECT_EQ(coverage, clockwise);
+ }
+
+ /**
+  * @brief Tests that only pixels inside the target rectangle are visited, with the depth of the triangle's plane.
+  */
+ TEST_F(RasterTest, ClippedDepthPlaneTest)
+ {
+     const float a[3] = {-50, -50, 10}, b[3] = {-50, 150, 30}, c[3] = {150, -50, 50}; // depth = 25 + 0.2 row + 0.1 col
+
+     TriangleSetup setup;
+     ASSERT_TRUE(setupTriangle(a, b, c, 5, 15, 20, 30, setup));
+     int visited = 0;
+     scanTriangle(setup, [&](int i, int j, float depth)
+     {
+         EXPECT_GE(i, 5);
+         EXPECT_LT(i, 15);
+         EXPECT_GE(j, 20);
+         EXPECT_LT(j, 30);
+         EXPECT_NEAR(depth, 25 + 0.2f * i + 0.1f * j, 1e-3f);
+         ++visited;
+     });
+     EXPECT_EQ(visited, 10 * 10);
+
+     EXPECT_FALSE(setupTriangle(a, b, c, 200, 210, 0, 10, setup)); // Entirely outside the triangle's bounding box
+ }
+
+ /**
+  * @brief Tests that a triangle with vertices far outside the guard band still covers the pixels it covers.
+  *
+  * As when a large face is seen close up, every vertex but one is far away and the triangle covers the grid.
+  */
+ TEST_F(RasterTest, FarVerticesTest)
+ {
+     for (float far : {2e6f, 3e6f, 1e9f, 1e20f})
+     {
+         std::fill(coverage.begin(), coverage.end(), 0);
+         draw({-5, -5, 10}, {-5, far, 10}, {far, -5, 10});
+         for (int i = 0; i < rows; ++i)
+             for (int j = 0; j < cols; ++j)
+                 ASSERT_EQ(count(i, j), 1) << "pixel " << i << ", " << j << " with vertices at " << far;
+     }
+
+     // Two triangles sharing an edge that leaves the guard band cover every pixel exactly once between them
+     std::fill(coverage.begin(), coverage.end(), 0);
+     const std::vector<float> shared = {3e6f, 2.1e6f, 10};
+     draw({-1, -1, 10}, shared, {-1, 1e7f, 10});
+     draw({-1, -1, 10}, {1e7f, -1, 10}, shared);
+     for (int i = 0; i < rows; ++i)
+         for (int j = 0; j < cols; ++j)
+             ASSERT_EQ(count(i, j), 1) << "pixel " << i << ", " << j;
+
+     // A triangle whose edges pass far from the grid covers none of it
+     std::fill(coverage.begin(), coverage.end(), 0);
+     draw({3e6f, 3e6f, 10}, {3e6f, 4e6f, 10}, {4e6f, 3e6f, 10});
+     EXPECT_EQ(std::count(coverage.begin(), coverage.end(), 0), rows * cols);
+ }
+
+ /**
+  * @brief Tests that a tiled batch draws exactly what drawing its faces one after another draws.
+  *
+  * The faces overlap at different depths and cross many tile boundaries, including the partial tiles at the
+  * right and bottom edges of the canvas, so the result depends on the order in which each pixel is drawn.
+  */
+ TEST(RasterBatchTest, MatchesSerialTest)
+ {
+     std::vector<float> vertices;
+     std::vector<uint32_t> indices, colors;
+     srand(7);
+     for (int f = 0; f < 300; ++f)
+     {
+         for (int k = 0; k < 3; ++k)
+         {
+             indices.push_back(static_cast<uint32_t>(vertices.size() / 3));
+             vertices.push_back(static_cast<float>(rand() % 260) - 20.0f); // Row, partly off the canvas
+             vertices.push_back(static_cast<float>(rand() % 190) - 20.0f); // Column
+             vertices.push_back(static_cast<float>(1 + rand() % 50));       // Depth
+         }
+         colors.push_back(packColor((f % 7) / 7.0f, (f % 11) / 11.0f, (f % 13) / 13.0f));
+     }
+
+     Canvas batched(220, 150), serial(220, 150);
+     ScreenBatch batch = {vertices.data(), indices.data(), colors.data(), colors.size()};
+     int threads = omp_get_max_threads();
+     omp_set_num_threads(4);
+     rasterizeBatch(batched, batch);
+     omp_set_num_threads(threads);
+
+     std::vector<float> color(3);
+     for (size_t f = 0; f < colors.size(); ++f)
+     {
+         unpackColor(colors[f], color.data());
+         rasterizeTriangle(serial, &vertices[9 * f], &vertices[9 * f + 3], &vertices[9 * f + 6], color);
+     }
+
+     EXPECT_EQ(batched.getPixels(), serial.getPixels());
+     EXPECT_EQ(batched.getDepthBuffer(), serial.getDepthBuffer());
+ }
+
+ /**
+  * @brief Tests that a batch with a drawing order draws what drawing its faces one after another in that order draws.
+  */
+ TEST(RasterBatchTest, OrderTest)
+ {
+     std::vector<float> vertices;
+     std::vector<uint32_t> indices, colors, order;
+     srand(5);
+     for (int f = 0; f < 200; ++f)
+     {
+         for (int k = 0; k < 3; ++k)
+         {
+             indices.push_back(static_cast<uint32_t>(vertices.size() / 3));
+             vertices.push_back(static_cast<float>(rand() % 260) - 20.0f);
+             vertices.push_back(static_cast<float>(rand() % 190) - 20.0f);
+             vertices.push_back(static_cast<float>(1 + rand() % 5)); // Few depths, so the order decides many pixels
+         }
+         colors.push_back(packColor((f % 7) / 7.0f, (f % 11) / 11.0f, (f % 13) / 13.0f));
+         order.push_back(static_cast<uint32_t>((f * 37) % 200)); // Every face once, out of batch order
+     }
+
+     Canvas batched(220, 150), serial(220, 150), unordered(220, 150);
+     ScreenBatch batch = {vertices.data(), indices.data(), colors.data(), colors.size()};
+     rasterizeBatch(unordered, batch);
+     batch.order = order.data();
+     rasterizeBatch(batched, batch);
+
+     std::vector<float> color(3);
+     for (uint32_t f : order)
+     {
+         unpackColor(colors[f], color.data());
+         rasterizeTriangle(serial, &vertices[9 * f], &vertices[9 * f + 3], &vertices[9 * f + 6], color);
+     }
+
+     EXPECT_EQ(batched.getPixels(), serial.getPixels());
+     EXPECT_EQ(batched.getDepthBuffer(), serial.getDepthBuffer());
+     EXPECT_NE(batched.getPixels(), unordered.getPixels());
+ }
+
+ /**
+  * @brief Tests that faces hidden behind earlier ones are skipped without changing what is drawn.
+  *
+  * A face at depth 10 covers the whole canvas first. Every later face behind it is skipped in every tile, while
+  * the faces in front of it are still drawn, just as when drawing the faces one after another.
+  */
+ TEST(RasterBatchTest, OcclusionTest)
+ {
+     std::vector<float> vertices = {-1, -1, 10, -1, 500, 10, 500, -1, 10};
+     std::vector<uint32_t> indices = {0, 1, 2};
+     std::vector<uint32_t> colors = {packColor(1, 0, 0)};
+     srand(11);
+     for (int f = 0; f < 200; ++f)
+     {
+         // The first 150 faces are behind the first one, the last 50 in front of it
+         float depth = f < 150 ? static_cast<float>(10 + rand() % 50) : static_cast<float>(1 + rand() % 9);
+         for (int k = 0; k < 3; ++k)
+         {
+             indices.push_back(static_cast<uint32_t>(vertices.size() / 3));
+             vertices.push_back(static_cast<float>(rand() % 260) - 20.0f);
+             vertices.push_back(static_cast<float>(rand() % 190) - 20.0f);
+             vertices.push_back(depth);
+         }
+         colors.push_back(packColor((f % 7) / 7.0f, (f % 11) / 11.0f, (f % 13) / 13.0f));
+     }
+
+     Canvas culled(220, 150), plain(220, 150);
+     ScreenBatch batch = {vertices.data(), indices.data(), colors.data(), colors.size()};
+     RasterStats plainStats = rasterizeBatch(plain, batch);
+     batch.cullOccluded = true;
+     RasterStats culledStats = rasterizeBatch(culled, batch);
+
+     EXPECT_EQ(culled.getPixels(), plain.getPixels());
+     EXPECT_EQ(culled.getDepthBuffer(), plain.getDepthBuffer());
+     EXPECT_EQ(plainStats.faceTilesOccluded, 0u);
+     EXPECT_EQ(culledStats.faceTiles, plainStats.faceTiles);
+
+     // Every hidden face is skipped in every tile it reaches; a few front faces are also behind other front faces
+     batch.faceCount = 151;
+     Canvas hiddenOnly(220, 150);
+     RasterStats hiddenStats = rasterizeBatch(hiddenOnly, batch);
+     EXPECT_EQ(hiddenStats.faceTilesOccluded, hiddenStats.faceTiles - 12); // The first face reaches all 4 x 3 tiles
+     EXPECT_GE(culledStats.faceTilesOccluded, hiddenStats.faceTilesOccluded);
+ }
+
+ /**
+  * @brief Tests that deferred shading draws what immediate shading draws, coloring each pixel the batch won once.
+  *
+  * The faces overlap at few depths, so many pixels are drawn over several times and the order decides many of
+  * them. A second batch is drawn over the first, so pixels the first batch keeps must keep their colors.
+  */
+ TEST(RasterBatchTest, DeferredShadingTest)
+ {
+     std::vector<float> vertices;
+     std::vector<uint32_t> indices, colors;
+     srand(3);
+     for (int f = 0; f < 300; ++f)
+     {
+         for (int k = 0; k < 3; ++k)
+         {
+             indices.push_back(static_cast<uint32_t>(vertices.size() / 3));
+             vertices.push_back(static_cast<float>(rand() % 260) - 20.0f);
+             vertices.push_back(static_cast<float>(rand() % 190) - 20.0f);
+             vertices.push_back(static_cast<float>(1 + rand() % 8));
+         }
+         colors.push_back(packColor((f % 7) / 7.0f, (f % 11) / 11.0f, (f % 13) / 13.0f));
+     }
+
+     Canvas immediate(220, 150), deferred(220, 150);
+     ScreenBatch first = {vertices.data(), indices.data(), colors.data(), 150};
+     ScreenBatch second = {vertices.data(), indices.data() + 3 * 150, colors.data() + 150, 150};
+     RasterStats immediateStats = rasterizeBatch(immediate, first);
+     EXPECT_EQ(immediateStats.pixelsShaded, 0u); // Only counted with deferred shading
+
+     first.deferShading = true;
+     RasterStats stats = rasterizeBatch(deferred, first);
+     EXPECT_EQ(deferred.getPixels(), immediate.getPixels());
+     EXPECT_EQ(deferred.getDepthBuffer(), immediate.getDepthBuffer());
+
+     // Every covered pixel is shaded exactly once, however often it was written
+     std::vector<float> depth = deferred.getDepthBuffer();
+     EXPECT_EQ(stats.pixelsShaded, static_cast<size_t>(std::count_if(depth.begin(), depth.end(), [](float d) { return d != 0.0f; })));
+     EXPECT_GT(stats.pixelsWritten, stats.pixelsShaded);
+
+     rasterizeBatch(immediate, second);
+     second.deferShading = true;
+     second.cullOccluded = true;
+     rasterizeBatch(deferred, second);
+     EXPECT_EQ(deferred.getPixels(), immediate.getPixels());
+     EXPECT_EQ(deferred.getDepthBuffer(), immediate.getDepthBuffer());
+ }
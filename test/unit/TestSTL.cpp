@@ -0,0 +1,213 @@
+/**
+ * @file TestSTL.cpp
+ * @brief This file contains unit tests for the STL readers using the Google Test framework.
+ *
+ * The tests cover binary STL detection, including files with bytes after the last facet, check that a
+ * binary STL file loads into the same triangles and colors as the equivalent ASCII file, and check that the
+ * chunked ASCII parser gives the same result regardless of how the file is split, and that the color sequence each file gets
+ * reproduces the C library's seeded generator.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <cstdint>
+ #include <cstdlib>
+ #include <cstring>
+ #include <filesystem>
+ #include <fstream>
+ #include <memory>
+ #include <vector>
+ #include "stl.h"
+
+ /**
+  * @brief Test fixture for the STL readers.
+  *
+  * This fixture loads the two-triangle ASCII STL file and writes the same facets as a binary STL file.
+  */
+ class STLTest : public ::testing::Test
+ {
+ protected:
+     STLTest()
+         : asciiTriangles(std::make_shared<std::vector<TriangleSurface>>()),
+           binaryPath((std::filesystem::temp_directory_path() / "two_triangles_binary.stl").string())
+     {
+         readSTL("../test/stl/two_triangles.stl", asciiTriangles);
+     }
+
+     ~STLTest() override { std::filesystem::remove(binaryPath); }
+
+     /**
+      * @brief Writes the ASCII triangles as a binary STL file with the given 80-byte header text.
+      */
+     void writeBinary(const std::string &headerText)
+     {
+         std::ofstream file(binaryPath, std::ios::binary);
+         char header[80] = {};
+         std::memcpy(header, headerText.data(), std::min<size_t>(headerText.size(), sizeof(header)));
+         uint32_t count = static_cast<uint32_t>(asciiTriangles->size());
+         file.write(header, sizeof(header));
+         file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+
+         for (const auto &t : *asciiTriangles)
+         {
+             float normal[3] = {0.0f, 0.0f, -1.0f};
+             uint16_t attribute = 0;
+             file.write(reinterpret_cast<const char *>(normal), sizeof(normal));
+             file.write(reinterpret_cast<const char *>(t.getA().data()), 3 * sizeof(float));
+             file.write(reinterpret_cast<const char *>(t.getB().data()), 3 * sizeof(float));
+             file.write(reinterpret_cast<const char *>(t.getC().data()), 3 * sizeof(float));
+             file.write(reinterpret_cast<const char *>(&attribute), sizeof(attribute));
+         }
+     }
+
+     /**
+      * @brief Checks that the binary file loads into exactly the triangles read from the ASCII file.
+      */
+     void expectBinaryMatchesAscii()
+     {
+         auto binaryTriangles = std::make_shared<std::vector<TriangleSurface>>();
+         readSTL(binaryPath, binaryTriangles);
+
+         ASSERT_EQ(binaryTriangles->size(), asciiTriangles->size());
+         for (size_t i = 0; i < asciiTriangles->size(); ++i)
+         {
+             EXPECT_EQ(binaryTriangles->at(i).getA(), asciiTriangles->at(i).getA());
+             EXPECT_EQ(binaryTriangles->at(i).getB(), asciiTriangles->at(i).getB());
+             EXPECT_EQ(binaryTriangles->at(i).getC(), asciiTriangles->at(i).getC());
+             EXPECT_EQ(binaryTriangles->at(i).getColor(), asciiTriangles->at(i).getColor());
+         }
+     }
+
+     std::shared_ptr<std::vector<TriangleSurface>> asciiTriangles; // Triangles read from the ASCII file
+     std::string binaryPath;                                       // Path of the temporary binary file
+ };
+
+ /**
+  * @brief Tests that a binary STL file loads the same triangles as the ASCII file.
+  */
+ TEST_F(STLTest, BinaryMatchesAsciiTest)
+ {
+     ASSERT_EQ(asciiTriangles->size(), 2);
+     writeBinary("binary two triangles");
+     expectBinaryMatchesAscii();
+ }
+
+ /**
+  * @brief Tests that a binary STL whose header starts with "solid" is still detected as binary.
+  */
+ TEST_F(STLTest, BinaryWithSolidHeaderTest)
+ {
+     writeBinary("solid exported by a CAD tool");
+     expectBinaryMatchesAscii();
+ }
+
+ /**
+  * @brief Tests the binary detection on ASCII text and on truncated buffers.
+  */
+ TEST_F(STLTest, IsBinarySTLTest)
+ {
+     std::string ascii = "solid cube\n  facet normal 0 0 -1\n  endfacet\nendsolid cube\n";
+     EXPECT_FALSE(isBinarySTL(ascii.data(), ascii.size()));
+     EXPECT_FALSE(isBinarySTL(nullptr, 0));
+
+     std::vector<char> binary(84 + 50, 0);
+     binary[80] = 1; // One facet
+     EXPECT_TRUE(isBinarySTL(binary.data(), binary.size()));
+     EXPECT_FALSE(isBinarySTL(binary.data(), binary.size() - 1));
+
+     // Bytes after the last record are ignored, unless the header looks like ASCII text
+     binary.resize(binary.size() + 2, 0);
+     EXPECT_TRUE(isBinarySTL(binary.data(), binary.size()));
+     TriangleSoup soup;
+     readBinarySTL(binary.data(), binary.size(), soup);
+     EXPECT_EQ(soup.size(), 1u);
+     std::memcpy(binary.data(), "solid", 5);
+     EXPECT_FALSE(isBinarySTL(binary.data(), binary.size()));
+ }
+
+ /**
+  * @brief Tests that a binary STL file with padding after its last facet loads the same triangles.
+  */
+ TEST_F(STLTest, BinaryWithTrailingBytesTest)
+ {
+     writeBinary("binary two triangles");
+     {
+         std::ofstream file(binaryPath, std::ios::binary | std::ios::app);
+         const char padding[7] = {};
+         file.write(padding, sizeof(padding));
+     }
+     expectBinaryMatchesAscii();
+ }
+
+ /**
+  * @brief Tests that splitting an ASCII file into chunks yields the same faces and colors as a single chunk.
+  *
+  * The text holds 2500 faces, so the faces span three color blocks of 1000 and several chunk boundaries.
+  */
+ TEST_F(STLTest, ChunkedAsciiMatchesSingleChunkTest)
+ {
+     std::string text = "solid generated\n";
+     for (int f = 0; f < 2500; ++f)
+     {
+         text += "  facet normal 0 0 1\n    outer loop\n";
+         for (int v = 0; v < 3; ++v)
+         {
+             text += "      vertex " + std::to_string(f) + " " + std::to_string(v) + ".5 -" + std::to_string(f + v) + "e-1\n";
+         }
+         text += "    endloop\n  endfacet\n";
+     }
+     text += "endsolid generated\n";
+
+     TriangleSoup single, chunked;
+     readAsciiSTL(text.data(), text.size(), single, 1);
+     readAsciiSTL(text.data(), text.size(), chunked, 7);
+
+     ASSERT_EQ(single.size(), 2500);
+     ASSERT_EQ(chunked.size(), 2500);
+     EXPECT_EQ(chunked.vertices, single.vertices);
+     EXPECT_EQ(chunked.colors, single.colors);
+
+     EXPECT_FLOAT_EQ(single.vertices[9 * 1234 + 0], 1234.0f); // Face 1234, vertex A, x
+     EXPECT_FLOAT_EQ(single.vertices[9 * 1234 + 7], 2.5f);    // Face 1234, vertex C, y
+     EXPECT_FLOAT_EQ(single.vertices[9 * 1234 + 8], -123.6f); // Face 1234, vertex C, z
+
+     // Every 1000th face draws the next color from a freshly seeded sequence
+     RandomSequence random(0);
+     std::vector<float> first = getRandomColor(random);
+     std::vector<float> second = getRandomColor(random);
+     EXPECT_EQ(std::vector<float>(single.colors.begin() + 3 * 999, single.colors.begin() + 3 * 1000), first);
+     EXPECT_EQ(std::vector<float>(single.colors.begin() + 3 * 1000, single.colors.begin() + 3 * 1001), second);
+ }
+
+ /**
+  * @brief Tests that a sequence gives the numbers of rand() after srand() in the GNU C library, and that
+  * sequences with the same seed do not disturb each other.
+  */
+ TEST(RandomSequenceTest, MatchesSeededRandTest)
+ {
+     RandomSequence a(0), b(0), other(12345);
+     int32_t firstOther = other.next();
+     for (int k = 0; k < 1000; ++k)
+     {
+         int32_t value = a.next();
+         EXPECT_EQ(b.next(), value);
+         EXPECT_GE(value, 0);
+         EXPECT_LE(value, RandomSequence::kMax);
+     }
+     EXPECT_NE(RandomSequence(12345).next(), RandomSequence(0).next());
+     EXPECT_EQ(RandomSequence(12345).next(), firstOther);
+
+ #ifdef __GLIBC__
+     for (uint32_t seed : {0u, 1u, 12345u})
+     {
+         RandomSequence random(seed);
+         srand(seed);
+         for (int k = 0; k < 1000; ++k)
+         {
+             EXPECT_EQ(random.next(), rand());
+         }
+     }
+ #endif
+ }
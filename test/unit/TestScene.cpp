@@ -0,0 +1,199 @@
+/**
+ * @file TestScene.cpp
+ * @brief This file contains unit tests for the Scene class using the Google Test framework.
+ *
+ * The tests cover loading several files at once, the bounds of the objects and of the scene, and drawing
+ * every object in a single pass with the same result as projecting them one by one. Distinct files loaded
+ * at the same time must get the face colors they get when loaded alone.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <cstdint>
+ #include <filesystem>
+ #include <fstream>
+ #include <string>
+ #include <vector>
+ #include "scene.h"
+
+ /**
+  * @brief Test fixture for the Scene class.
+  *
+  * This fixture loads the two-triangle STL file, a square from (200, 200) to (300, 300) at z = 300, twice, and a
+  * file that does not exist, on two threads.
+  */
+ class SceneTest : public ::testing::Test
+ {
+ protected:
+     SceneTest() : canvas(400, 400)
+     {
+         LoadOptions options;
+         options.useCache = false;
+         scene.load({"../test/stl/two_triangles.stl", "../test/stl/two_triangles.stl", "../test/stl/missing.stl"}, options, 2);
+         std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+         canvas.setCameraNormal(normal);
+     }
+
+     /**
+      * @brief Projects the scene's objects one by one, as separate TriangleObjects, onto a fresh canvas.
+      */
+     Canvas projectSeparately(const RenderOptions &options)
+     {
+         Canvas expected(400, 400);
+         std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+         expected.setCameraNormal(normal);
+         for (size_t k = 0; k < scene.objectCount(); ++k)
+         {
+             TriangleObject object(scene.getGeometry(k));
+             const Mat4 &model = scene.getTransform(k);
+             object.translate(model[0][3], model[1][3], model[2][3]);
+             object.project(expected, options);
+         }
+         return expected;
+     }
+
+     Scene scene;   // The scene under test
+     Canvas canvas; // The canvas the scene is drawn on
+ };
+
+ /**
+  * @brief Tests that the files load in order, that a repeated file is shared and that a missing one is empty.
+  */
+ TEST_F(SceneTest, LoadTest)
+ {
+     ASSERT_EQ(scene.objectCount(), 3u);
+     EXPECT_EQ(scene.getGeometry(0)->mesh.faceCount(), 2u);
+     EXPECT_EQ(scene.getGeometry(0).get(), scene.getGeometry(1).get());
+     EXPECT_EQ(scene.getGeometry(2)->mesh.faceCount(), 0u);
+     EXPECT_EQ(scene.getTransform(0), Mat4());
+     EXPECT_THROW(scene.getTransform(3), std::out_of_range);
+
+     // Loading more appends after the objects already there
+     LoadOptions options;
+     options.useCache = false;
+     EXPECT_EQ(scene.load({"../test/stl/two_triangles.stl"}, options), 3u);
+     EXPECT_EQ(scene.objectCount(), 4u);
+ }
+
+ /**
+  * @brief Tests that the bounds of an object follow its transform and that the scene's bounds hold every object.
+  */
+ TEST_F(SceneTest, BoundsTest)
+ {
+     scene.setTransform(1, Mat4::affine({{{2, 0, 0}, {0, 2, 0}, {0, 0, 2}}}, {10, 0, 0}));
+
+     float boundsMin[3], boundsMax[3];
+     scene.getBounds(1, boundsMin, boundsMax);
+     const float expectedMin[3] = {410, 400, 600}, expectedMax[3] = {610, 600, 600};
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         EXPECT_FLOAT_EQ(boundsMin[axis], expectedMin[axis]);
+         EXPECT_FLOAT_EQ(boundsMax[axis], expectedMax[axis]);
+     }
+
+     // The empty object has an empty box and adds nothing to the scene's
+     scene.getBounds(2, boundsMin, boundsMax);
+     EXPECT_GT(boundsMin[0], boundsMax[0]);
+
+     scene.getBounds(boundsMin, boundsMax);
+     const float sceneMin[3] = {200, 200, 300}, sceneMax[3] = {610, 600, 600};
+     for (int axis = 0; axis < 3; ++axis)
+     {
+         EXPECT_FLOAT_EQ(boundsMin[axis], sceneMin[axis]);
+         EXPECT_FLOAT_EQ(boundsMax[axis], sceneMax[axis]);
+     }
+ }
+
+ /**
+  * @brief Tests that drawing the scene in one pass gives the image and counts of projecting each object in turn.
+  */
+ TEST_F(SceneTest, MatchesSeparateObjectsTest)
+ {
+     scene.setTransform(0, Mat4::affine(Mat3(), {-150, -150, 0}));
+     scene.setTransform(1, Mat4::affine(Mat3(), {-40, -60, -10}));
+     scene.setTransform(2, Mat4::affine(Mat3(), {50, 20, -5}));
+
+     RenderStats stats = scene.project(canvas);
+     EXPECT_EQ(stats.facesDrawn, 4u);
+     EXPECT_EQ(stats.facesOffCanvas, 0u);
+
+     Canvas expected = projectSeparately(RenderOptions());
+     EXPECT_EQ(canvas.getPixels(), expected.getPixels());
+     EXPECT_EQ(canvas.getDepthBuffer(), expected.getDepthBuffer());
+
+     // Moving an object off the canvas drops its faces, and drawing again reuses the gathered faces
+     scene.setTransform(0, Mat4::affine(Mat3(), {1000, 0, 0}));
+     canvas.clear();
+     stats = scene.project(canvas);
+     EXPECT_EQ(stats.facesDrawn, 2u);
+     EXPECT_EQ(stats.facesOffCanvas, 2u);
+     expected = projectSeparately(RenderOptions());
+     EXPECT_EQ(canvas.getPixels(), expected.getPixels());
+ }
+
+ /**
+  * @brief Tests that drawing nearest first across objects leaves the same depths, and skips hidden faces.
+  */
+ TEST_F(SceneTest, FrontToBackTest)
+ {
+     // The second square sits right in front of the first
+     scene.setTransform(1, Mat4::affine(Mat3(), {0, 0, -10}));
+
+     RenderOptions options;
+     options.sortFrontToBack = true;
+     options.cullOccluded = true;
+     RenderStats stats = scene.project(canvas, options);
+     EXPECT_EQ(stats.facesDrawn, 4u);
+     EXPECT_GT(stats.faceTilesOccluded, 0u);
+
+     Canvas expected = projectSeparately(RenderOptions());
+     EXPECT_EQ(canvas.getPixels(), expected.getPixels());
+     EXPECT_EQ(canvas.getDepthBuffer(), expected.getDepthBuffer());
+ }
+
+ /**
+  * @brief Tests that distinct files loaded on several threads get the same face colors as loaded one by one.
+  *
+  * Each file is a strip of 2500 faces, so its faces take three colors from the random sequence.
+  */
+ TEST(SceneLoadTest, ConcurrentColorsTest)
+ {
+     std::vector<std::string> paths;
+     for (int part = 0; part < 8; ++part)
+     {
+         paths.push_back((std::filesystem::temp_directory_path() / ("scene_colors_" + std::to_string(part) + ".stl")).string());
+         std::ofstream file(paths.back(), std::ios::binary);
+         const char header[80] = {};
+         const uint32_t faceCount = 2500;
+         file.write(header, sizeof(header));
+         file.write(reinterpret_cast<const char *>(&faceCount), sizeof(faceCount));
+         for (uint32_t face = 0; face < faceCount; ++face)
+         {
+             const float x = static_cast<float>(face), y = 10.0f * part;
+             const float record[12] = {0, 0, 1, x, y, 0, x + 1, y, 0, x, y + 1, 0}; // Normal, then three vertices
+             const uint16_t attributes = 0;
+             file.write(reinterpret_cast<const char *>(record), sizeof(record));
+             file.write(reinterpret_cast<const char *>(&attributes), sizeof(attributes));
+         }
+     }
+
+     LoadOptions options;
+     options.useCache = false;
+     Scene scene;
+     scene.load(paths, options, 4);
+     ASSERT_EQ(scene.objectCount(), paths.size());
+     for (size_t k = 0; k < paths.size(); ++k)
+     {
+         const std::vector<uint32_t> &colors = scene.getGeometry(k)->mesh.colors;
+         ASSERT_EQ(colors.size(), 2500u);
+         EXPECT_NE(colors[0], colors[1000]);
+         EXPECT_EQ(colors, loadGeometry(paths[k], options)->mesh.colors) << paths[k];
+     }
+
+     for (const std::string &path : paths)
+     {
+         std::filesystem::remove(path);
+     }
+ }
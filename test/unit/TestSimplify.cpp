@@ -0,0 +1,115 @@
+/**
+ * @file TestSimplify.cpp
+ * @brief This file contains unit tests for building levels of detail using the Google Test framework.
+ *
+ * The tests cover the face counts of the levels, the border and plane of a flat open mesh being kept
+ * exactly, the errors of a curved mesh growing from level to level, and meshes too small to simplify.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <algorithm>
+ #include <vector>
+ #include "color.h"
+ #include "simplify.h"
+
+ namespace
+ {
+     /**
+      * @brief Builds a grid of n x n squares of size 10, two faces each, lifted to height(x, y).
+      *
+      * Faces are wound counter-clockwise when seen from +z and get one of four colors in turn.
+      */
+     template <typename Height>
+     Mesh makeGrid(int n, Height height)
+     {
+         TriangleSoup soup;
+         auto corner = [&](int i, int j)
+         {
+             float x = i * 10.0f, y = j * 10.0f;
+             soup.vertices.insert(soup.vertices.end(), {x, y, height(x, y)});
+         };
+         for (int i = 0; i < n; ++i)
+         {
+             for (int j = 0; j < n; ++j)
+             {
+                 corner(i, j); corner(i + 1, j); corner(i + 1, j + 1);
+                 corner(i, j); corner(i + 1, j + 1); corner(i, j + 1);
+             }
+         }
+         for (size_t f = 0; f < soup.vertices.size() / 9; ++f)
+         {
+             soup.colors.insert(soup.colors.end(), {(f % 4) / 4.0f, 0.5f, 1.0f});
+         }
+         return weldVertices(soup);
+     }
+ }
+
+ /**
+  * @brief Tests that each level of a flat grid shrinks by the ratio and stays exactly on the plane and border.
+  */
+ TEST(SimplifyTest, FlatGridTest)
+ {
+     Mesh mesh = makeGrid(32, [](float, float) { return 0.0f; }); // 2048 faces
+     float boundsMin[3], boundsMax[3];
+     mesh.getBounds(boundsMin, boundsMax);
+
+     std::vector<MeshLod> lods = buildLodChain(mesh, 0.25f, 64);
+     ASSERT_EQ(lods.size(), 2u); // 512 and 128 faces; 32 would be under the minimum
+
+     size_t previous = mesh.faceCount();
+     for (const MeshLod &lod : lods)
+     {
+         EXPECT_LE(lod.mesh.faceCount(), previous / 4);
+         EXPECT_GE(lod.mesh.faceCount(), 64u);
+         EXPECT_NEAR(lod.error, 0.0f, 1e-3f);
+         previous = lod.mesh.faceCount();
+
+         // No vertex leaves the plane, and the corners of the border are still there
+         float lodMin[3], lodMax[3];
+         lod.mesh.getBounds(lodMin, lodMax);
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             EXPECT_EQ(lodMin[axis], boundsMin[axis]);
+             EXPECT_EQ(lodMax[axis], boundsMax[axis]);
+         }
+
+         // Faces keep their original colors and still face +z
+         ASSERT_EQ(lod.mesh.colors.size(), lod.mesh.faceCount());
+         ASSERT_EQ(lod.mesh.normals.size(), 3 * lod.mesh.faceCount());
+         for (size_t f = 0; f < lod.mesh.faceCount(); ++f)
+         {
+             EXPECT_NE(std::find(mesh.colors.begin(), mesh.colors.begin() + 4, lod.mesh.colors[f]), mesh.colors.begin() + 4);
+             EXPECT_NEAR(lod.mesh.normals[3 * f + 2], 1.0f, 1e-5f);
+         }
+     }
+ }
+
+ /**
+  * @brief Tests that the levels of a curved grid get coarser and their errors grow with them.
+  */
+ TEST(SimplifyTest, CurvedGridTest)
+ {
+     Mesh mesh = makeGrid(32, [](float x, float y) { return ((x - 160) * (x - 160) + (y - 160) * (y - 160)) / 200.0f; });
+
+     std::vector<MeshLod> lods = buildLodChain(mesh, 0.25f, 64);
+     ASSERT_FALSE(lods.empty());
+     EXPECT_GT(lods.back().error, 0.0f);
+     for (size_t level = 1; level < lods.size(); ++level)
+     {
+         EXPECT_LT(lods[level].mesh.faceCount(), lods[level - 1].mesh.faceCount());
+         EXPECT_LT(lods[level].mesh.vertexCount(), lods[level - 1].mesh.vertexCount());
+         EXPECT_GE(lods[level].error, lods[level - 1].error);
+     }
+ }
+
+ /**
+  * @brief Tests that a mesh with fewer faces than a level would need gets no levels at all.
+  */
+ TEST(SimplifyTest, SmallMeshTest)
+ {
+     EXPECT_TRUE(buildLodChain(makeGrid(4, [](float, float) { return 0.0f; })).empty()); // 32 faces
+     EXPECT_TRUE(buildLodChain(Mesh()).empty());
+ }
@@ -139,16 +139,16 @@
      const double tolerance = 0.01;
  
      // A remains unchanged because it's the rotation point
-     EXPECT_NEAR(triangle.getA()[0], 0, tolerance);
-     EXPECT_NEAR(triangle.getA()[1], 0, tolerance);
-     EXPECT_NEAR(triangle.getA()[2], 0, tolerance);
+     EXPECT_NEAR(triangle.getA()[0], 300, tolerance);
+     EXPECT_NEAR(triangle.getA()[1], 300, tolerance);
+     EXPECT_NEAR(triangle.getA()[2], 300, tolerance);
      
      EXPECT_NEAR(triangle.getB()[0], 400, tolerance);
-     EXPECT_NEAR(triangle.getB()[1], -300, tolerance);
+     EXPECT_NEAR(triangle.getB()[1], 300, tolerance);
      EXPECT_NEAR(triangle.getB()[2], 300, tolerance);
      
      EXPECT_NEAR(triangle.getC()[0], 400, tolerance);
-     EXPECT_NEAR(triangle.getC()[1], -300, tolerance);
+     EXPECT_NEAR(triangle.getC()[1], 300, tolerance);
      EXPECT_NEAR(triangle.getC()[2], 400, tolerance);
  }
  
@@ -164,17 +164,17 @@
      const double tolerance = 0.01;
  
      // A remains unchanged because it's the rotation point
-     EXPECT_NEAR(triangle.getA()[0], 0, tolerance);
-     EXPECT_NEAR(triangle.getA()[1], 0, tolerance);
-     EXPECT_NEAR(triangle.getA()[2], 0, tolerance);
+     EXPECT_NEAR(triangle.getA()[0], 300, tolerance);
+     EXPECT_NEAR(triangle.getA()[1], 300, tolerance);
+     EXPECT_NEAR(triangle.getA()[2], 300, tolerance);
      
      EXPECT_NEAR(triangle.getB()[0], 300, tolerance);
      EXPECT_NEAR(triangle.getB()[1], 300, tolerance);
-     EXPECT_NEAR(triangle.getB()[2], -400, tolerance);
+     EXPECT_NEAR(triangle.getB()[2], 200, tolerance);
      
      EXPECT_NEAR(triangle.getC()[0], 300, tolerance);
      EXPECT_NEAR(triangle.getC()[1], 400, tolerance);
-     EXPECT_NEAR(triangle.getC()[2], -400, tolerance);
+     EXPECT_NEAR(triangle.getC()[2], 200, tolerance);
  }
  
  /**
@@ -189,15 +189,15 @@
      const double tolerance = 0.01;
  
      // A remains unchanged because it's the rotation point
-     EXPECT_NEAR(triangle.getA()[0], 0, tolerance);
-     EXPECT_NEAR(triangle.getA()[1], 0, tolerance);
-     EXPECT_NEAR(triangle.getA()[2], 0, tolerance);
+     EXPECT_NEAR(triangle.getA()[0], 300, tolerance);
+     EXPECT_NEAR(triangle.getA()[1], 300, tolerance);
+     EXPECT_NEAR(triangle.getA()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangle.getB()[0], -300, tolerance);
+     EXPECT_NEAR(triangle.getB()[0], 300, tolerance);
      EXPECT_NEAR(triangle.getB()[1], 400, tolerance);
      EXPECT_NEAR(triangle.getB()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangle.getC()[0], -400, tolerance);
+     EXPECT_NEAR(triangle.getC()[0], 200, tolerance);
      EXPECT_NEAR(triangle.getC()[1], 400, tolerance);
      EXPECT_NEAR(triangle.getC()[2], 300, tolerance);
  }
\ No newline at end of file
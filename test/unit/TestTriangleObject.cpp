@@ -11,6 +11,9 @@
  */
 
  #include <gtest/gtest.h> // Google Test framework
+ #include <cstdint>
+ #include <filesystem>
+ #include <fstream>
  #include <vector>
  #include "TriangleObject.h"
  
@@ -120,31 +123,31 @@
      triangleObj.rotateAroundX(90, triangleObj.getTriangles()->at(0).getA());
      const double tolerance = 0.01;
  
-     // Check the vertices of the first triangle after rotation
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[0], 0, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[1], 0, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[2], 0, tolerance);
+     // Check the vertices of the first triangle after rotation; A stays in place as the rotation point
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[0], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[2], 300, tolerance);
      
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[0], 300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[1], -300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[2], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[2], 300, tolerance);
      
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[0], 300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[1], -300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[2], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[2], 400, tolerance);
  
      // Check the vertices of the second triangle after rotation
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[0], 200, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[1], -300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[2], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[2], 300, tolerance);
      
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[0], 300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[1], -300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[2], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[2], 400, tolerance);
      
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[0], 200, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[1], -300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[2], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[2], 400, tolerance);
  }
  
  /**
@@ -158,31 +161,31 @@
      triangleObj.rotateAroundY(90, triangleObj.getTriangles()->at(0).getA());
      const double tolerance = 0.01;
  
-     // Check the vertices of the first triangle after rotation
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[0], 0, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[1], 0, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[2], 0, tolerance);
+     // Check the vertices of the first triangle after rotation; A stays in place as the rotation point
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[0], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[0], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[1], 200, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[2], -300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[2], 200, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[0], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[1], 300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[2], -300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[2], 200, tolerance);
  
      // Check the vertices of the second triangle after rotation
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[0], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[1], 200, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[2], -200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[0], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[1], 300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[2], -300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[2], 200, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[0], 300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[1], 300, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[2], -200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[2], 300, tolerance);
  }
  
  /**
@@ -196,29 +199,242 @@
      triangleObj.rotateAroundZ(90, triangleObj.getTriangles()->at(0).getA());
      const double tolerance = 0.01;
  
-     // Check the vertices of the first triangle after rotation
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[0], 0, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[1], 0, tolerance);
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[2], 0, tolerance);
+     // Check the vertices of the first triangle after rotation; A stays in place as the rotation point
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[0], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[1], 200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getA()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[0], -200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[1], 300, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getB()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[0], -300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[0], 100, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[1], 300, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(0).getC()[2], 300, tolerance);
  
      // Check the vertices of the second triangle after rotation
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[0], -200, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[0], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[1], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getA()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[0], -300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[0], 100, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[1], 300, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getB()[2], 300, tolerance);
      
-     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[0], -300, tolerance);
+     EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[0], 100, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[1], 200, tolerance);
      EXPECT_NEAR(triangleObj.getTriangles()->at(1).getC()[2], 300, tolerance);
- }
\ No newline at end of file
+ }
+ /**
+  * @brief Tests that projecting the object draws the same image as projecting each of its triangles.
+  *
+  * The object projects its shared vertices once and rasterizes from that cache; the result must match
+  * the per-triangle path exactly, pixel for pixel and depth for depth.
+  */
+ TEST_F(TriangleObjectTest, projectMatchesTrianglesTest)
+ {
+     std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+     Canvas objectCanvas(400, 400), triangleCanvas(400, 400);
+     objectCanvas.setCameraNormal(normal);
+     triangleCanvas.setCameraNormal(normal);
+
+     triangleObj.rotateAroundZ(20, {250, 250, 300});
+     triangleObj.project(objectCanvas);
+     projectTriangles(triangleCanvas, *triangleObj.getTriangles());
+
+     EXPECT_EQ(objectCanvas.getPixels(), triangleCanvas.getPixels());
+     EXPECT_EQ(objectCanvas.getDepthBuffer(), triangleCanvas.getDepthBuffer());
+     EXPECT_NE(objectCanvas.getDepthBuffer()[250 * 400 + 250], 0.0f); // The square covers the middle of the canvas
+ }
+
+ /**
+  * @brief Tests culling the faces that point away from the camera.
+  *
+  * The square's stored normals point toward the camera, so it is drawn; turned around it is culled, and
+  * nothing reaches the canvas.
+  */
+ TEST_F(TriangleObjectTest, cullBackFacesTest)
+ {
+     std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+     Canvas canvas(400, 400);
+     canvas.setCameraNormal(normal);
+     RenderOptions options;
+     options.cullBackFaces = true;
+
+     RenderStats stats = triangleObj.project(canvas, options);
+     EXPECT_EQ(stats.facesDrawn, 2);
+     EXPECT_EQ(stats.facesCulled, 0);
+     EXPECT_NE(canvas.getDepthBuffer()[250 * 400 + 250], 0.0f);
+
+     canvas.clear();
+     triangleObj.rotateAroundY(180, {250, 250, 300});
+     stats = triangleObj.project(canvas, options);
+     EXPECT_EQ(stats.facesDrawn, 0);
+     EXPECT_EQ(stats.facesCulled, 2);
+     EXPECT_EQ(canvas.getDepthBuffer()[250 * 400 + 250], 0.0f);
+
+     stats = triangleObj.project(canvas); // Culling is off by default
+     EXPECT_EQ(stats.facesDrawn, 2);
+     EXPECT_NE(canvas.getDepthBuffer()[250 * 400 + 250], 0.0f);
+ }
+
+ /**
+  * @brief Tests that an object moved off the canvas is skipped as a whole, and that skipping does not change the image.
+  */
+ TEST_F(TriangleObjectTest, cullOffCanvasTest)
+ {
+     std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+     Canvas canvas(400, 400);
+     canvas.setCameraNormal(normal);
+     RenderOptions all;
+     all.cullOffCanvas = false;
+
+     RenderStats stats = triangleObj.project(canvas);
+     EXPECT_EQ(stats.facesOffCanvas, 0);
+     EXPECT_EQ(stats.facesDrawn, 2);
+     std::vector<uint32_t> culledPixels = canvas.getPixels();
+     canvas.clear();
+     triangleObj.project(canvas, all);
+     EXPECT_EQ(canvas.getPixels(), culledPixels);
+
+     canvas.clear();
+     triangleObj.translate(0, 1000, 0);
+     stats = triangleObj.project(canvas);
+     EXPECT_EQ(stats.facesOffCanvas, 2);
+     EXPECT_EQ(stats.facesDrawn, 0);
+     EXPECT_EQ(canvas.getPixels(), std::vector<uint32_t>(400 * 400, 0u));
+ }
+
+ /**
+  * @brief Tests that transforms are composed in call order and leave the loaded mesh untouched.
+  */
+ TEST_F(TriangleObjectTest, composedTransformTest)
+ {
+     const Mesh original = triangleObj.getMesh();
+
+     triangleObj.translate(-200, -200, -300); // Move vertex A to the origin
+     triangleObj.scale(2);
+     triangleObj.rotateAroundZ(90, {0, 0, 0});
+
+     // B = (300, 200, 300) becomes (100, 0, 0), then (200, 0, 0), then (0, 200, 0)
+     auto triangles = triangleObj.getTriangles();
+     const double tolerance = 0.01;
+     EXPECT_NEAR(triangles->at(0).getA()[0], 0, tolerance);
+     EXPECT_NEAR(triangles->at(0).getA()[1], 0, tolerance);
+     EXPECT_NEAR(triangles->at(0).getB()[0], 0, tolerance);
+     EXPECT_NEAR(triangles->at(0).getB()[1], 200, tolerance);
+     EXPECT_NEAR(triangles->at(0).getB()[2], 0, tolerance);
+
+     EXPECT_EQ(triangleObj.getMesh().x, original.x);
+     EXPECT_EQ(triangleObj.getMesh().y, original.y);
+     EXPECT_EQ(triangleObj.getMesh().z, original.z);
+ }
+
+ /**
+  * @brief Tests that an object loaded with compact vertices keeps only their codes and draws the same square.
+  *
+  * The square's corners are the corners of its bounding box, which 16-bit codes hold to within rounding, so
+  * the image matches the float mesh's and the depths agree closely.
+  */
+ TEST_F(TriangleObjectTest, compactVerticesTest)
+ {
+     LoadOptions options;
+     options.compactVertices = true;
+     TriangleObject compact("../test/stl/two_triangles.stl", options);
+     ASSERT_TRUE(compact.getMesh().isQuantized());
+     EXPECT_LT(compact.getMemoryUsage(), triangleObj.getMemoryUsage());
+
+     std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+     Canvas compactCanvas(400, 400), floatCanvas(400, 400);
+     compactCanvas.setCameraNormal(normal);
+     floatCanvas.setCameraNormal(normal);
+     compact.rotateAroundZ(20, {250, 250, 300});
+     triangleObj.rotateAroundZ(20, {250, 250, 300});
+     compact.project(compactCanvas);
+     triangleObj.project(floatCanvas);
+
+     EXPECT_EQ(compactCanvas.getPixels(), floatCanvas.getPixels());
+     std::vector<float> compactDepth = compactCanvas.getDepthBuffer(), floatDepth = floatCanvas.getDepthBuffer();
+     for (size_t k = 0; k < floatDepth.size(); ++k)
+     {
+         EXPECT_NEAR(compactDepth[k], floatDepth[k], 1e-3f);
+     }
+
+     // Triangles built from the codes match the float ones as well
+     auto compactTriangles = compact.getTriangles(), floatTriangles = triangleObj.getTriangles();
+     for (size_t t = 0; t < floatTriangles->size(); ++t)
+     {
+         for (int axis = 0; axis < 3; ++axis)
+         {
+             EXPECT_NEAR(compactTriangles->at(t).getC()[axis], floatTriangles->at(t).getC()[axis], 1e-3);
+         }
+     }
+ }
+
+ /**
+  * @brief Tests that the level of detail drawn gets coarser as the object shrinks on the canvas.
+  *
+  * The object is a 32 x 32 grid of squares curved into a bowl, written as a binary STL file.
+  */
+ TEST(TriangleObjectLodTest, selectLevelTest)
+ {
+     const std::string path = (std::filesystem::temp_directory_path() / "triangle_object_lod.stl").string();
+     {
+         std::ofstream file(path, std::ios::binary);
+         const char header[80] = {};
+         const uint32_t faceCount = 2 * 32 * 32;
+         file.write(header, sizeof(header));
+         file.write(reinterpret_cast<const char *>(&faceCount), sizeof(faceCount));
+         auto corner = [](int i, int j, float *p)
+         {
+             p[0] = i * 10.0f;
+             p[1] = j * 10.0f;
+             p[2] = ((p[0] - 160) * (p[0] - 160) + (p[1] - 160) * (p[1] - 160)) / 200.0f;
+         };
+         for (int i = 0; i < 32; ++i)
+         {
+             for (int j = 0; j < 32; ++j)
+             {
+                 const int corners[2][3][2] = {{{i, j}, {i + 1, j}, {i + 1, j + 1}}, {{i, j}, {i + 1, j + 1}, {i, j + 1}}};
+                 for (const auto &face : corners)
+                 {
+                     float record[12] = {}; // Normal, then three vertices
+                     for (int k = 0; k < 3; ++k)
+                     {
+                         corner(face[k][0], face[k][1], record + 3 + 3 * k);
+                     }
+                     const uint16_t attributes = 0;
+                     file.write(reinterpret_cast<const char *>(record), sizeof(record));
+                     file.write(reinterpret_cast<const char *>(&attributes), sizeof(attributes));
+                 }
+             }
+         }
+     }
+
+     LoadOptions options;
+     options.useCache = false;
+     options.buildLods = true;
+     TriangleObject object(path, options);
+     std::filesystem::remove(path);
+     const std::vector<MeshLod> &lods = object.getLods();
+     ASSERT_FALSE(lods.empty());
+     ASSERT_GT(lods.back().error, 0.0f);
+
+     std::vector<float> normal = {0.0f, 0.0f, 1.0f};
+     Canvas canvas(400, 400);
+     canvas.setCameraNormal(normal);
+     RenderOptions full;
+     RenderOptions lod;
+     lod.lodPixelError = 0.5f;
+
+     // Without a pixel error the full mesh is drawn; with the finest level's error spanning 2 pixels, so is it
+     EXPECT_EQ(object.project(canvas, full).lodLevel, 0u);
+     object.scale(2.0f / lods.front().error);
+     EXPECT_EQ(object.project(canvas, lod).lodLevel, 0u);
+
+     // Small enough, every level fits, and the coarsest one is drawn
+     object.scale(1e-4f);
+     RenderStats stats = object.project(canvas, lod);
+     EXPECT_EQ(stats.lodLevel, lods.size());
+     EXPECT_EQ(stats.facesDrawn, lods.back().mesh.faceCount());
+ }
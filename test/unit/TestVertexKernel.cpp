@@ -0,0 +1,100 @@
+/**
+ * @file TestVertexKernel.cpp
+ * @brief This file contains unit tests for the batched vertex transform kernel using the Google Test framework.
+ *
+ * The tests check the kernel against a direct matrix product and check that every instruction set gives
+ * exactly the same result, including for the vertices left over after the last full vector, for float and for
+ * 16-bit quantized coordinates.
+ *
+ * @author Ben Benyamin
+ * @date March 2025
+ */
+
+ #include <gtest/gtest.h> // Google Test framework
+ #include <cmath>
+ #include <cstdint>
+ #include <vector>
+ #include "vertex_kernel.h"
+
+ /**
+  * @brief Test fixture for the vertex kernel.
+  *
+  * This fixture builds 37 vertices (four full AVX2 steps plus a tail of five) and a rotation with a translation.
+  */
+ class VertexKernelTest : public ::testing::Test
+ {
+ protected:
+     VertexKernelTest()
+     {
+         for (int v = 0; v < 37; ++v)
+         {
+             x.push_back(std::sin(v * 0.7f) * 300.0f);
+             y.push_back(std::cos(v * 1.3f) * 200.0f + v);
+             z.push_back(v * 2.5f - 40.0f);
+         }
+     }
+
+     std::vector<float> x, y, z; // Vertex coordinates
+     const float matrix[3][4] = {{0.6f, -0.8f, 0, 12}, {0.8f, 0.6f, 0, -3.5f}, {0, 0, 1, 100}}; // Rotation about Z
+ };
+
+ /**
+  * @brief Tests that the kernel computes the matrix product for every vertex, in interleaved order.
+  */
+ TEST_F(VertexKernelTest, MatchesMatrixProductTest)
+ {
+     std::vector<float> out(3 * x.size());
+     transformVertices(matrix, x.data(), y.data(), z.data(), x.size(), out.data());
+
+     for (size_t v = 0; v < x.size(); ++v)
+     {
+         for (int i = 0; i < 3; ++i)
+         {
+             float expected = matrix[i][0] * x[v] + matrix[i][1] * y[v] + matrix[i][2] * z[v] + matrix[i][3];
+             EXPECT_FLOAT_EQ(out[3 * v + i], expected);
+         }
+     }
+ }
+
+ /**
+  * @brief Tests that every instruction set gives bit-identical results, for any batch length.
+  */
+ TEST_F(VertexKernelTest, LevelsAgreeTest)
+ {
+     for (size_t count : {size_t(0), size_t(1), size_t(4), size_t(7), size_t(8), x.size()})
+     {
+         std::vector<float> scalar(3 * count + 1, -1.0f);
+         transformVertices(matrix, x.data(), y.data(), z.data(), count, scalar.data(), SimdLevel::Scalar);
+         EXPECT_EQ(scalar.back(), -1.0f); // Nothing is written past the last vertex
+
+         for (SimdLevel level : {SimdLevel::SSE, SimdLevel::AVX2})
+         {
+             std::vector<float> vectorized(3 * count + 1, -1.0f);
+             transformVertices(matrix, x.data(), y.data(), z.data(), count, vectorized.data(), level);
+             EXPECT_EQ(vectorized, scalar) << "count " << count << ", level " << static_cast<int>(level);
+         }
+     }
+ }
+
+ /**
+  * @brief Tests that 16-bit codes, the largest included, give what the same values as floats give, at every level.
+  */
+ TEST_F(VertexKernelTest, QuantizedTest)
+ {
+     std::vector<uint16_t> qx, qy, qz;
+     std::vector<float> fx, fy, fz;
+     for (size_t v = 0; v < x.size(); ++v)
+     {
+         qx.push_back(static_cast<uint16_t>(v * 1771)), qy.push_back(static_cast<uint16_t>(65535 - v)), qz.push_back(v % 2 ? 65535 : 0);
+         fx.push_back(qx.back()), fy.push_back(qy.back()), fz.push_back(qz.back());
+     }
+
+     std::vector<float> expected(3 * x.size());
+     transformVertices(matrix, fx.data(), fy.data(), fz.data(), x.size(), expected.data(), SimdLevel::Scalar);
+     for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2})
+     {
+         std::vector<float> out(3 * x.size());
+         transformVertices(matrix, qx.data(), qy.data(), qz.data(), x.size(), out.data(), level);
+         EXPECT_EQ(out, expected) << "level " << static_cast<int>(level);
+     }
+ }